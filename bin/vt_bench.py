@@ -0,0 +1,309 @@
+#!/usr/bin/env python3
+"""
+vt_bench.py -- serial-path benchmark for a ViaText node.
+
+Drives the firmware's BENCH verb (0x41) over SLIP and reports round-trip
+latency percentiles, frames/s, payload bytes/s, and link error counts for
+each (baud, size) combination. Use it to compare firmware builds:
+
+    bin/vt_bench.py /dev/ttyUSB0 --sizes 0,32,128,250 --count 500
+    bin/vt_bench.py /dev/ttyUSB0 --rate 50 --json > build_a.json
+
+Sizes are reply payload bytes (TAG_BENCH_FILL). By default the request also
+carries the same number of bytes as TAG_BENCH_DATA so both directions are
+exercised; --fill-only sends a tiny request instead. Sizes above what fits a
+classic frame automatically switch to FLAG_LEN16.
+
+--baud sets the host side only; the node must already run at that rate.
+With --set-baud the tool opens the port at 115200 and moves the node to
+each rate with SET_BAUD (ack at the old rate, then a confirming PING).
+
+Requires pyserial (pip install pyserial).
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+try:
+    import serial
+except ImportError:
+    sys.exit("vt_bench.py needs pyserial: pip install pyserial")
+
+# Protocol constants (node_protocol.hpp)
+PING = 0x03
+BENCH = 0x41
+SET_BAUD = 0x42
+RESP_OK = 0x90
+RESP_ERR = 0x91
+FLAG_LEN16 = 0x02
+TAG_BAUD = 0x06
+TAG_BENCH_DATA = 0x39
+TAG_BENCH_FILL = 0x3A
+TAG_BENCH_T_US = 0x3B
+TAG_BENCH_DT_US = 0x3C
+
+# SLIP (RFC 1055), same bytes as the firmware encoder
+END, ESC, ESC_END, ESC_ESC = 0xC0, 0xDB, 0xDC, 0xDD
+
+
+def slip_encode(frame):
+    out = bytearray([END])
+    for c in frame:
+        if c == END:
+            out += bytes([ESC, ESC_END])
+        elif c == ESC:
+            out += bytes([ESC, ESC_ESC])
+        else:
+            out.append(c)
+    out.append(END)
+    return bytes(out)
+
+
+class SlipReader:
+    """Incremental SLIP decoder that counts framing errors."""
+
+    def __init__(self, port):
+        self.port = port
+        self.buf = bytearray()
+        self.esc = False
+        self.errors = 0
+
+    def read_frame(self, deadline):
+        while time.monotonic() < deadline:
+            chunk = self.port.read(self.port.in_waiting or 1)
+            for c in chunk:
+                if self.esc:
+                    self.esc = False
+                    if c == ESC_END:
+                        self.buf.append(END)
+                    elif c == ESC_ESC:
+                        self.buf.append(ESC)
+                    else:
+                        self.errors += 1          # bad escape: drop this frame
+                        self.buf = bytearray()
+                elif c == ESC:
+                    self.esc = True
+                elif c == END:
+                    if self.buf:
+                        frame, self.buf = bytes(self.buf), bytearray()
+                        return frame
+                else:
+                    self.buf.append(c)
+        return None
+
+
+def build_frame(verb, seq, body, len16):
+    if len16:
+        return bytes([verb, FLAG_LEN16, seq]) + struct.pack("<H", len(body)) + body
+    return bytes([verb, 0, seq, len(body)]) + body
+
+
+def parse_frame(frame):
+    """Return (verb, flags, seq, body) or None if the header is malformed."""
+    if len(frame) < 4:
+        return None
+    verb, flags, seq = frame[0], frame[1], frame[2]
+    if flags & FLAG_LEN16:
+        if len(frame) < 5:
+            return None
+        hdr, n = 5, frame[3] | (frame[4] << 8)
+    else:
+        hdr, n = 4, frame[3]
+    if hdr + n > len(frame):
+        return None
+    return verb, flags, seq, frame[hdr:hdr + n]
+
+
+def tlvs(body):
+    off = 0
+    while off + 2 <= len(body):
+        tag, n = body[off], body[off + 1]
+        off += 2
+        if off + n > len(body):
+            return
+        yield tag, body[off:off + n]
+        off += n
+
+
+def bench_body(size, fill_only):
+    body = bytearray()
+    body += bytes([TAG_BENCH_FILL, 2]) + struct.pack("<H", size)
+    if not fill_only:
+        data = bytes((k * 7) & 0xFF for k in range(size))
+        for k in range(0, len(data), 255):
+            part = data[k:k + 255]
+            body += bytes([TAG_BENCH_DATA, len(part)]) + part
+    return bytes(body)
+
+
+def request(port, reader, verb, seq, body, timeout):
+    """Send one classic frame and return the parsed reply with that seq, or None."""
+    port.write(slip_encode(build_frame(verb, seq, body, False)))
+    deadline = time.monotonic() + timeout
+    while True:
+        raw = reader.read_frame(deadline)
+        if raw is None:
+            return None
+        parsed = parse_frame(raw)
+        if parsed and parsed[2] == seq:
+            return parsed
+
+
+def negotiate_baud(port, reader, baud, timeout):
+    """Move node and host to `baud` via SET_BAUD; True once a PING confirms it."""
+    if port.baudrate == baud:
+        return True
+    r = request(port, reader, SET_BAUD, 1, bytes([TAG_BAUD, 4]) + struct.pack("<I", baud), timeout)
+    if r is None or r[0] != RESP_OK:
+        return False
+    time.sleep(0.05)                           # node drains its reply, then switches
+    port.baudrate = baud
+    port.reset_input_buffer()
+    r = request(port, reader, PING, 2, b"", timeout)
+    return r is not None and r[0] == RESP_OK
+
+
+def percentile(sorted_vals, p):
+    if not sorted_vals:
+        return float("nan")
+    k = (len(sorted_vals) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(sorted_vals) - 1)
+    return sorted_vals[lo] + (sorted_vals[hi] - sorted_vals[lo]) * (k - lo)
+
+
+def run_case(port, reader, size, args):
+    body = bench_body(size, args.fill_only)
+    reply_body = 6 + 6 + size + 2 * ((size + 254) // 255)      # T_US + DT_US + DATA TLVs
+    len16 = args.len16 or len(body) > 255 or reply_body > 255
+    rtts, node_us = [], []
+    timeouts = resp_err = mismatched = malformed = 0
+    tx_bytes = rx_bytes = 0
+    errors_before = reader.errors
+    period = 1.0 / args.rate if args.rate > 0 else 0.0
+
+    t_start = time.monotonic()
+    next_send = t_start
+    for n in range(args.count):
+        seq = (n % 255) + 1                    # seq 0 is reserved for unsolicited frames
+        frame = build_frame(BENCH, seq, body, len16)
+        if period:
+            delay = next_send - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            next_send += period
+        t0 = time.perf_counter()
+        port.write(slip_encode(frame))
+        tx_bytes += len(frame)
+        deadline = time.monotonic() + args.timeout
+        while True:
+            raw = reader.read_frame(deadline)
+            if raw is None:
+                timeouts += 1
+                break
+            parsed = parse_frame(raw)
+            if parsed is None:
+                malformed += 1
+                continue
+            verb, _, rseq, rbody = parsed
+            if rseq == 0:
+                continue                       # unsolicited (hello, radio RX): ignore
+            if rseq != seq:
+                mismatched += 1
+                continue
+            rtts.append((time.perf_counter() - t0) * 1e6)
+            rx_bytes += len(raw)
+            if verb == RESP_ERR:
+                resp_err += 1
+            for tag, val in tlvs(rbody):
+                if tag == TAG_BENCH_DT_US and len(val) == 4:
+                    node_us.append(struct.unpack("<I", val)[0])
+            break
+    elapsed = time.monotonic() - t_start
+
+    rtts.sort()
+    node_us.sort()
+    ok = len(rtts)
+    return {
+        "baud": port.baudrate,
+        "size": size,
+        "len16": len16,
+        "sent": args.count,
+        "ok": ok,
+        "timeouts": timeouts,
+        "resp_err": resp_err,
+        "seq_mismatch": mismatched,
+        "malformed": malformed,
+        "slip_errors": reader.errors - errors_before,
+        "rtt_us": {
+            "p50": percentile(rtts, 50),
+            "p90": percentile(rtts, 90),
+            "p99": percentile(rtts, 99),
+            "max": rtts[-1] if rtts else float("nan"),
+        },
+        "node_us_p50": percentile(node_us, 50),
+        "frames_per_s": ok / elapsed if elapsed > 0 else 0.0,
+        "tx_bytes_per_s": tx_bytes / elapsed if elapsed > 0 else 0.0,
+        "rx_bytes_per_s": rx_bytes / elapsed if elapsed > 0 else 0.0,
+    }
+
+
+def print_row(r):
+    l = r["rtt_us"]
+    print(f"{r['baud']:>8} {r['size']:>5} {'L16' if r['len16'] else '   '} "
+          f"{r['ok']:>5}/{r['sent']:<5} "
+          f"{l['p50']:>9.0f} {l['p90']:>9.0f} {l['p99']:>9.0f} {l['max']:>9.0f} "
+          f"{r['node_us_p50']:>7.0f} "
+          f"{r['frames_per_s']:>8.1f} {r['tx_bytes_per_s'] + r['rx_bytes_per_s']:>10.0f} "
+          f"{r['timeouts']:>4} {r['slip_errors'] + r['malformed']:>4} {r['resp_err']:>4}")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="ViaText node serial benchmark (BENCH verb)")
+    ap.add_argument("port", help="serial device, e.g. /dev/ttyUSB0")
+    ap.add_argument("--baud", default="115200", help="comma-separated host baud rates")
+    ap.add_argument("--sizes", default="0,16,64,128,240", help="comma-separated payload sizes")
+    ap.add_argument("--count", type=int, default=200, help="frames per case")
+    ap.add_argument("--rate", type=float, default=0.0, help="frames/s (0 = back-to-back)")
+    ap.add_argument("--timeout", type=float, default=1.0, help="per-frame reply timeout (s)")
+    ap.add_argument("--fill-only", action="store_true", help="small requests, sized replies")
+    ap.add_argument("--len16", action="store_true", help="always use FLAG_LEN16 headers")
+    ap.add_argument("--set-baud", action="store_true",
+                    help="start at 115200 and switch the node with SET_BAUD")
+    ap.add_argument("--json", action="store_true", help="emit JSON results instead of a table")
+    args = ap.parse_args()
+
+    results = []
+    if not args.json:
+        print(f"{'baud':>8} {'size':>5}     {'ok/sent':^11} "
+              f"{'p50 us':>9} {'p90 us':>9} {'p99 us':>9} {'max us':>9} "
+              f"{'node us':>7} {'frames/s':>8} {'bytes/s':>10} "
+              f"{'tmo':>4} {'slip':>4} {'err':>4}")
+    for baud in (int(b) for b in args.baud.split(",")):
+        with serial.Serial(args.port, 115200 if args.set_baud else baud, timeout=0.05) as port:
+            time.sleep(0.1)
+            port.reset_input_buffer()          # drop boot hello / stale bytes
+            reader = SlipReader(port)
+            if args.set_baud and not negotiate_baud(port, reader, baud, args.timeout):
+                print(f"SET_BAUD {baud} failed; node reverts to 115200 on its own", file=sys.stderr)
+                time.sleep(2.5)                # outlast the node's confirmation window
+                continue
+            for size in (int(s) for s in args.sizes.split(",")):
+                r = run_case(port, reader, size, args)
+                results.append(r)
+                if not args.json:
+                    print_row(r)
+            if args.set_baud:                  # leave the node where the next case expects it
+                request(port, reader, SET_BAUD, 1, bytes([TAG_BAUD, 4]) + struct.pack("<I", 115200),
+                        args.timeout)
+                time.sleep(0.05)
+    if args.json:
+        json.dump(results, sys.stdout, indent=2)
+        print()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+vt_smaz.py -- host twin of the firmware's short-text packer (node_smaz).
+
+Same dictionary, same code stream, so a host can pack text the way a node
+does with TAG_COMPRESS=1, unpack captured air payloads flagged
+AIR_F_PACKED, or estimate the airtime saving on its own traffic:
+
+    bin/vt_smaz.py "battery ok, moving to the ridge"
+    bin/vt_smaz.py --file chat.log          # one message per line
+    bin/vt_smaz.py --unpack 8a6f6b          # hex code stream -> text
+
+Also importable: pack(bytes) -> bytes, unpack(bytes) -> bytes.
+"""
+
+import argparse
+import sys
+
+# Frozen: must match kBook in src/node_smaz.cpp entry for entry.
+BOOK = [
+    " the ", " and ", " you ", "tion ", " for ", " that", " with", " have",
+    " this", " will", " from", " are ", " not ", " was ", " can ", " all ",
+    " out ", " is ", " to ", " of ", " in ", " on ", " at ", " be ", " we ",
+    " it ", " my ", " me ", " no ", " so ", " a ", "ing ", "ent ", "ion ",
+    "ed ", "er ", "es ", "ly ", "ng ", "e ", "s ", "t ", "d ", "n ", "y ",
+    "r ", "o ", "the", "ing", "and", "ion", "ent", "ver", "ter", "for", "her",
+    "ere", "all", "tha", "ate", "ous", "ight", "ould", "ment", "ness", "here",
+    "th", "he", "in", "er", "an", "re", "on", "at", "en", "nd", "ti", "es",
+    "or", "te", "of", "ed", "is", "it", "al", "ar", "st", "to", "nt", "ng",
+    "se", "ha", "as", "ou", "io", "le", "ve", "co", "me", "de", "hi", "ri",
+    "ro", "ic", "ne", "ea", "ra", "ce", "li", "ch", "ll", "be", "ma", "si",
+    "om", "ur", "ow", "wh", "so", "wa", "ok", ". ", ", ", "? ", "! ", ": ",
+    "OK", "  ",
+]
+assert len(BOOK) == 128
+
+CODE_DICT, CODE_BYTE, CODE_RUN = 0x80, 0x01, 0x02
+_ENTRIES = [e.encode("ascii") for e in BOOK]
+
+
+def _literal(c):
+    return 0x20 <= c <= 0x7E or c in (0x09, 0x0A, 0x0D)
+
+
+def pack(data):
+    """Greedy longest-match pack (identical output to node_smaz_pack)."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        best, best_len = -1, 1
+        for k, e in enumerate(_ENTRIES):
+            if len(e) > best_len and data.startswith(e, i):
+                best, best_len = k, len(e)
+        c = data[i]
+        if best >= 0:
+            out.append(CODE_DICT + best)
+            i += best_len
+        elif _literal(c):
+            out.append(c)
+            i += 1
+        else:
+            run = 1
+            while i + run < len(data) and run < 255 and not _literal(data[i + run]):
+                run += 1
+            if run == 1:
+                out += bytes([CODE_BYTE, c])
+            else:
+                out += bytes([CODE_RUN, run]) + data[i:i + run]
+            i += run
+    return bytes(out)
+
+
+def unpack(code):
+    """Inverse of pack(); raises ValueError on an invalid stream."""
+    out = bytearray()
+    i = 0
+    while i < len(code):
+        c = code[i]
+        i += 1
+        if c >= CODE_DICT:
+            out += _ENTRIES[c - CODE_DICT]
+        elif _literal(c):
+            out.append(c)
+        elif c == CODE_BYTE and i < len(code):
+            out.append(code[i])
+            i += 1
+        elif c == CODE_RUN and i < len(code) and code[i] and i + 1 + code[i] <= len(code):
+            n = code[i]
+            out += code[i + 1:i + 1 + n]
+            i += 1 + n
+        else:
+            raise ValueError("invalid code 0x%02x at offset %d" % (c, i - 1))
+    return bytes(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("text", nargs="*", help="messages to pack")
+    ap.add_argument("--file", help="pack every line of this file")
+    ap.add_argument("--unpack", metavar="HEX", help="unpack a hex code stream")
+    args = ap.parse_args()
+
+    if args.unpack:
+        sys.stdout.write(unpack(bytes.fromhex(args.unpack)).decode("utf-8", "replace") + "\n")
+        return
+    msgs = [t.encode("utf-8") for t in args.text]
+    if args.file:
+        with open(args.file, "rb") as f:
+            msgs += [line.rstrip(b"\r\n") for line in f if line.strip()]
+    plain = air = 0
+    for m in msgs:
+        p = pack(m)
+        assert unpack(p) == m
+        sent = len(p) if len(p) < len(m) else len(m)   # the node falls back to raw
+        plain += len(m)
+        air += sent
+        if args.text:
+            print("%3d -> %3d  %s" % (len(m), sent, p.hex()))
+    if plain:
+        print("total %d -> %d bytes (%.1f%% of plain)" % (plain, air, 100.0 * air / plain))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+#pragma once
+/**
+ * @page vt-node-adr ViaText Node ADR (neighbour table, per-link SF)
+ * @file node_adr.hpp
+ * @brief Measured link quality per neighbour and the spreading factor it allows.
+ *
+ * Overview
+ * --------
+ * TAG_SF is one setting for the whole node, so a neighbour 20 dB above
+ * sensitivity costs as much airtime as the weakest one. This module keeps a
+ * small table of direct neighbours with averaged RSSI/SNR, derives for each
+ * the lowest SF that still leaves a safety margin, and from those the SF
+ * that would serve every neighbour (TAG_ADR_SF):
+ *
+ *   AIR_BEACON -> node_link_receive() -> node_adr_observe(src, rssi, snr)
+ *   GET_STATS  -> one TAG_STAT_NBR row per neighbour
+ *   GET_ALL    -> TAG_ADR_SF (broadcast SF; TAG_SF while nothing is known)
+ *
+ * Only beacons are measured: relayed DATA and ACKs keep their originator's
+ * src, so their RSSI belongs to whichever relay sent the copy, while beacons
+ * are never relayed. Nodes that want ADR enable TAG_BEACON_SEC.
+ *
+ * SF Choice
+ * ---------
+ * SX127x demodulates down to an SNR floor of -7.5 dB at SF7, 2.5 dB lower
+ * per SF step, to -20 dB at SF12. A link is good for an SF when its averaged
+ * SNR (EWMA, 1/4 weight per beacon) sits kAdrMarginDb above that floor.
+ * - Worse links move up at once, to whatever SF the margin needs.
+ * - Better links move down one SF per beacon, only with kAdrHystDb of margin
+ *   on top and after kAdrMinSamples beacons, so a lucky packet or a link
+ *   sitting near a threshold does not flap.
+ * - New neighbours start at TAG_SF.
+ *
+ * An SX127x only receives the SF it listens on, and neighbours listen on
+ * their own TAG_SF, so the node does not switch SF by itself: per-link SFs
+ * and TAG_ADR_SF are advice for whoever plans the mesh settings.
+ *
+ * Table
+ * -----
+ * kAdrSlots entries; neighbours silent for kAdrTtlMs drop out, and a newcomer
+ * facing a full table replaces the one heard longest ago.
+ *
+ * Context
+ * -------
+ * Transport task only (node_link_receive(), radio_apply(), and handlers).
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Neighbours tracked at once. */
+static constexpr size_t kAdrSlots = 8;
+
+/** A neighbour unheard this long is forgotten. */
+static constexpr uint32_t kAdrTtlMs = 15u * 60u * 1000u;
+
+/** SNR required above the SF's demodulation floor. */
+static constexpr int kAdrMarginDb = 10;
+
+/** Extra SNR required before stepping a link down to a faster SF. */
+static constexpr int kAdrHystDb = 3;
+
+/** Beacons heard before a link may go below TAG_SF. */
+static constexpr uint16_t kAdrMinSamples = 3;
+
+/** TAG_STAT_NBR record bytes. */
+static constexpr size_t kAdrWire = 11;
+
+/**
+ * @brief Set the configured SF (TAG_SF): start point for new neighbours and
+ *        the answer while none are known.
+ */
+void node_adr_configure(uint8_t sf);
+
+/** @brief Fold one beacon from @p addr into its neighbour entry. */
+void node_adr_observe(uint16_t addr, int16_t rssi_dbm, int8_t snr_db);
+
+/**
+ * @brief SF every fresh neighbour can be reached with (the slowest of their
+ *        per-link SFs), or the configured SF when the table is empty.
+ */
+uint8_t node_adr_sf();
+
+/** @brief Number of table rows (fresh or not) node_adr_encode() may return. */
+size_t node_adr_rows();
+
+/**
+ * @brief Encode neighbour row @p row as a TAG_STAT_NBR record:
+ *        addr u16, rssi dBm s16, snr 0.1 dB s16 (both averaged),
+ *        beacons heard u16, age s u16 (both saturating), sf u8.
+ * @return false for a free or expired row.
+ */
+bool node_adr_encode(size_t row, uint8_t (&out)[kAdrWire]);
@@ -10,8 +10,33 @@
  * of boards with a 0.96" SSD1306 OLED. It exists for one reason: keep the UI
  * simple and stable so the rest of the node never talks directly to third-party
  * libraries. This layer gives you a few high-value calls (boot text, ID screen, 
- * two-line status) and nothing more. No retained widgets, no layouts, 
- * no theme engine—just draw and push.
+ * two-line status, message scrollback) and nothing more. No retained widgets,
+ * no layouts, no theme engine—just draw and push.
+ *
+ * Pipeline
+ * --------
+ * Drawing is split in two halves so the command path never waits on I2C:
+ * - node_display_clear/draw_*() record the requested screen (strings are
+ *   copied) and return immediately. A newer request replaces an older one
+ *   that has not been rendered yet, so message bursts coalesce.
+ * - node_display_service() runs on the worker task. It renders the latest
+ *   request into the framebuffer, diffs each 8-row SSD1306 page against a
+ *   shadow of the glass, and pushes only the changed column span of the
+ *   changed pages. The bus runs at 400 kHz fast-mode.
+ *
+ * Text is page-native: every text row is one SSD1306 page and every glyph
+ * is 6 prerendered column bytes from node_font, copied in place. A full
+ * screen renders in a few microseconds instead of thousands of GFX pixel
+ * writes, and rows wrap at 21 characters.
+ *
+ * Message History
+ * ---------------
+ * node_display_draw_message() appends to a ring of the last 8 messages and
+ * shows them newest at the bottom, wrapped, oldest scrolling off the top.
+ * While the history stays on screen, new messages scroll it incrementally:
+ * the panel's display start line moves down by the new rows (one command)
+ * and only those rows are drawn and pushed. A burst that outruns the worker
+ * is drawn once, as the last screenful.
  *
  * Where This Fits
  * ---------------
@@ -36,18 +61,21 @@
  * - Initialize the OLED over I2C and report availability.
  * - Provide idempotent helpers for a boot message, the node ID screen, and a
  *   two-line status. Keep font sizes fixed and readable.
- * - Offer a clear() and a flush() so callers can compose simple sequences.
+ * - Offer a clear() and a flush() (force a full repaint).
+ * - Push only what changed, from the worker, never from a handler.
  *
  * Non-Goals
  * ---------
  * - Retained UI, layout systems, or off-screen object models.
- * - Fancy fonts, icons, or proportional text. We stick to readable defaults.
+ * - Fancy fonts, icons, or proportional text. One fixed 6x8 font (node_font),
+ *   at 1x or 2x.
  * - Hardware abstraction beyond what is necessary to draw text reliably.
  *
  * Dependencies
  * ------------
  * - Arduino core for ESP32 (Wire/TwoWire).
- * - Adafruit_GFX and Adafruit_SSD1306 libraries.
+ * - Adafruit_SSD1306 (panel init and the framebuffer; it pulls in Adafruit_GFX,
+ *   whose drawing calls are not used).
  * - A 128x64 SSD1306 connected via I2C. Address defaults to 0x3C with a
  *   fallback probe at 0x3D (common on TTGO boards).
  *
@@ -79,7 +107,8 @@
  *
  * Extension Points
  * ----------------
- * - If you add more helpers, keep them small, synchronous, and text-first.
+ * - If you add more helpers, keep them small and text-first: record a Scene
+ *   in the request, paint it in render(). Never touch the bus from callers.
  * - Do not leak Adafruit types through this header. Keep the boundary clean so
  *   swapping the driver or display later does not ripple through the codebase.
  *
@@ -137,9 +166,8 @@ bool node_display_available();
  * @brief Clear the screen.
  *
  * @details
- * Clears the entire framebuffer and pushes the change to the panel
- * immediately. Safe to call repeatedly. No effect if display is not
- * available.
+ * Requests a blank screen; the worker pushes it on its next pass. Safe to
+ * call repeatedly. No effect if display is not available.
  */
 void node_display_clear();
 
@@ -179,19 +207,47 @@ void node_display_draw_id(const char* id);
  * @param line2 Second line (small font). May be null.
  *
  * @details
- * Clears the display, writes up to two lines in small font, and flushes
- * to the panel. Useful for ad-hoc status or debugging output. Null
- * pointers are ignored safely.
+ * Requests a screen with up to two lines in small font. Strings are copied,
+ * so callers may reuse their buffers at once. Useful for ad-hoc status or
+ * debugging output. Null pointers are ignored safely.
  */
 void node_display_draw_two_lines(const char* line1, const char* line2);
 
 /**
- * @brief Flush pending draw operations to the display.
+ * @brief Append a message to the scrollback and show the history.
+ *
+ * @param label Short prefix drawn in front of the text (e.g. "< "). May be null.
+ * @param text  Message text. May be null.
+ *
+ * @details
+ * The line is copied (label + text, up to 63 bytes) into a ring of the last
+ * 8 messages; unprintable bytes draw as '?'. Between two service passes any
+ * number of messages cost one render, and while the history is already on
+ * glass only the newly added rows are drawn and pushed.
+ */
+void node_display_draw_message(const char* label, const char* text);
+
+/**
+ * @brief Force a full repaint on the next service pass.
  *
  * @details
- * Pushes the current framebuffer to the panel without clearing or
- * redrawing. Usually not required because the helper functions already
- * flush automatically, but exposed for manual composition when multiple
- * draws are performed in sequence.
+ * Discards the shadow of what is believed to be on glass, so every page is
+ * pushed again. Usually not required because only changed pages need to
+ * move, but useful after a brown-out or a suspected panel glitch.
  */
 void node_display_flush();
+
+/**
+ * @brief Render the latest request and push dirty pages to the panel.
+ *
+ * @details
+ * Background half of the display pipeline. Call periodically from the
+ * worker task (node_tasks). Returns immediately when nothing is pending.
+ * This is the only function that touches I2C after node_display_begin().
+ *
+ * @note Not safe to call from more than one task.
+ */
+void node_display_service();
+
+/** @brief True when no request is waiting for node_display_service(). */
+bool node_display_idle();
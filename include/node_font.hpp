@@ -0,0 +1,51 @@
+#pragma once
+/**
+ * @page vt-node-font ViaText Node Page Font (6x8, SSD1306 layout)
+ * @file node_font.hpp
+ * @brief Prerendered 6x8 ASCII glyphs blitted straight into SSD1306 page memory.
+ *
+ * Overview
+ * --------
+ * The SSD1306 stores the panel as 8 pages of 128 column bytes; bit 0 of a
+ * byte is the top pixel row of that page. Eight-pixel text on a page
+ * boundary is therefore one byte per glyph column: a glyph is 6 bytes
+ * (5 columns of ink, 1 of spacing) copied into the page, with no per-pixel
+ * work and no read-modify-write. A 128-column page holds kFontCols glyphs.
+ *
+ *   node_font_draw()      1x: 6 columns per glyph, one page
+ *   node_font_draw_2x()   2x: 12 columns per glyph across two pages
+ *                         (each column byte doubled through a nibble table)
+ *
+ * Glyphs cover printable ASCII 0x20..0x7E; every other byte draws as '?'.
+ * The shapes are the classic 5x7 GLCD set, so 1x text looks the same as
+ * Adafruit GFX's built-in font did.
+ *
+ * Callers clear the page first; the draw calls only write the columns a
+ * glyph covers and stop at the page width.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+static constexpr size_t kFontW    = 6;               ///< columns per 1x glyph (incl. spacing)
+static constexpr size_t kFontCols = 128 / kFontW;    ///< 1x glyphs per 128-column page (21)
+
+/** @brief The 6 column bytes for @p c ('?' for anything unprintable). */
+const uint8_t* node_font_glyph(char c);
+
+/**
+ * @brief Draw up to @p n chars of @p s (stopping early at NUL) into one page.
+ * @param page  Column bytes of the target page, @p width of them.
+ * @return Columns written.
+ */
+size_t node_font_draw(uint8_t* page, size_t width, const char* s, size_t n);
+
+/**
+ * @brief Draw @p s at twice the size into two vertically adjacent pages.
+ * @param top,bottom Upper and lower page, @p width columns each.
+ * @return Columns written (12 per glyph).
+ */
+size_t node_font_draw_2x(uint8_t* top, uint8_t* bottom, size_t width, const char* s, size_t n);
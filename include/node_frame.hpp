@@ -0,0 +1,106 @@
+#pragma once
+/**
+ * @page vt-node-frame ViaText Node Frame Writer (pooled TX buffers)
+ * @file node_frame.hpp
+ * @brief Bounds-checked builder for outbound inner frames over a static pool.
+ *
+ * Overview
+ * --------
+ * Every outbound frame is built in one of kTxPoolSlots static buffers of
+ * kFrameMax bytes. A FrameWriter borrows a slot for its lifetime, writes the
+ * header, appends TLVs with capacity checks, patches the length, and hands
+ * the buffer to protocol_send(), which SLIP-encodes it straight onto the
+ * UART. No handler carries a frame-sized array on its stack, and the bytes
+ * are copied once (into the slot) before they hit the wire.
+ *
+ * Capacity and Truncation
+ * -----------------------
+ * A writer's limit follows the header form: 4 + 255 bytes for the classic
+ * header, kFrameMax with FLAG_LEN16. An append that does not fit is refused
+ * whole (never half-written) and the writer is marked truncated. Callers
+ * check truncated() before sending and answer RESP_ERR instead of shipping
+ * a silently short reply.
+ *
+ * Pool Rules
+ * ----------
+ * - Constructing a writer blocks until a slot is free. Hold it only while
+ *   building and sending; never across a wait for the host.
+ * - A task may hold at most two writers at once (e.g. a reply plus an
+ *   unsolicited hello), so the pool cannot deadlock with today's tasks.
+ * - Before node_frame_begin() no slot exists: valid() is false and every
+ *   method is a no-op.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "node_protocol.hpp"    // kFrameMax, kFrameHdr*, FLAG_LEN16, protocol_send
+
+/** Number of pooled TX buffers (kFrameMax bytes each). */
+static constexpr size_t kTxPoolSlots = 4;
+
+/**
+ * @brief Create the pool. Call once at boot before any frame is sent.
+ */
+void node_frame_begin();
+
+/**
+ * @class FrameWriter
+ * @brief Builds one inner frame in a pooled buffer; releases it on destruction.
+ */
+class FrameWriter {
+public:
+  /**
+   * @param verb  Header verb.
+   * @param seq   Header sequence number.
+   * @param len16 true for the FLAG_LEN16 header (and kFrameMax capacity).
+   */
+  FrameWriter(uint8_t verb, uint8_t seq, bool len16 = false);
+  ~FrameWriter();
+
+  /** @brief Append one TLV. Refused whole (and truncated) if it does not fit. */
+  bool tlv(uint8_t tag, const void* p, size_t len);
+
+  /** @brief Append one little-endian integer TLV of sizeof(T) bytes. */
+  template <typename T>
+  bool tlv_le(uint8_t tag, T value) {
+    uint8_t tmp[sizeof(T)];
+    for (size_t j = 0; j < sizeof(T); ++j) tmp[j] = static_cast<uint8_t>(value >> (8 * j));
+    return tlv(tag, tmp, sizeof(T));
+  }
+
+  /** @brief Append raw body bytes (MSG payloads, BATCH sub-frames). */
+  bool raw(const void* p, size_t n);
+
+  /** @brief Discard the body and switch verb; seq, form and slot are kept. */
+  void restart(uint8_t verb);
+
+  /** @brief OR bits into the header flags byte (FLAG_LEN16 is managed here). */
+  void set_flags(uint8_t bits);
+
+  /** @brief Patch the body length into the header; returns the frame bytes. */
+  const uint8_t* finish();
+
+  /** @brief finish() and protocol_send(). No-op without a slot. */
+  void send();
+
+  bool   valid() const     { return buf_ != nullptr; }
+  bool   truncated() const { return trunc_; }
+  size_t size() const      { return i_; }                ///< Header + body bytes so far
+  size_t room() const      { return cap_ - i_; }         ///< Bytes still appendable
+  uint8_t seq() const      { return buf_ ? buf_[2] : 0; }
+
+private:
+  FrameWriter(const FrameWriter&) = delete;
+  FrameWriter& operator=(const FrameWriter&) = delete;
+
+  uint8_t* buf_;
+  uint8_t  slot_;
+  uint8_t  hdr_;
+  bool     trunc_;
+  size_t   i_;
+  size_t   cap_;
+};
@@ -32,7 +32,8 @@
  * ---------
  * - Byte transport, framing, SLIP, or serial buffer management (that is
  *   node_protocol).
- * - Long-running or blocking work. All handlers complete quickly.
+ * - Long-running or blocking work. All handlers complete quickly; slow side
+ *   effects (display, flash) run on the worker task.
  * - UI composition beyond minimal notifications to node_display.
  *
  * Frame and TLV Conventions
@@ -57,7 +58,7 @@
  *
  * - SET_ID
  *   Accepts TAG_ID as a string TLV. Validates length and allowed characters
- *   [A-Za-z0-9-_]. On success: writes to NVS, nudges display, RESP_OK with ID,
+ *   [A-Za-z0-9-_]. On success: marks ID for commit, nudges display, RESP_OK with ID,
  *   then emits an unsolicited hello so nearby hosts learn the change.
  *
  * - GET_PARAM
@@ -65,19 +66,123 @@
  *   includes those tags populated with current values.
  *
  * - SET_PARAM
- *   Update configuration by sending TLVs with values. Validates ranges
- *   (e.g., SF 7..12, CR 5..8, ACK_MODE 0/1). On success: persist to NVS and
- *   RESP_OK echoing all settable tags (so callers see final, clamped values).
+ *   Update configuration by sending TLVs with values. Every TLV is checked
+ *   first (exact width, ranges such as SF 7..12, CR 5..8, ACK_MODE 0/1); one
+ *   bad TLV rejects the whole request with nothing applied. On success:
+ *   schedule an NVS commit and RESP_OK echoing all settable tags (so callers
+ *   see final, clamped values) and TAG_CFG_GEN.
  *
  * - GET_ALL
  *   Bulk read of identity, radio, behavior, and diagnostic tags. Intended for
  *   diagnostic panels and initial sync. May grow over time as diagnostics are
- *   implemented.
+ *   implemented. A reconnecting host sends TAG_CFG_SINCE (u32) with the
+ *   TAG_CFG_GEN it last saw and gets TAG_CFG_GEN plus only the persisted
+ *   rows changed in later generations: just TAG_CFG_GEN if nothing moved.
+ *   A TAG_CFG_SINCE ahead of the node's generation (another node, wiped
+ *   NVS) gets the full set, diagnostics included.
  *
  * - MSG
  *   Accepts a short text payload (len bytes directly in the frame after the
- *   header for this verb). Stores a copy for UI/debug, optionally draws to the
- *   display, then RESP_OK with ID. Designed for quick status fan-out.
+ *   header for this verb). Queues the payload on the outbound message queue
+ *   (node_msgq; FLAG_CTRL selects the control lane), stores a copy for
+ *   UI/debug, optionally draws to the display, then RESP_OK with ID and
+ *   TAG_MSG_ID. RESP_ERR means the queue is full; back off and retry.
+ *   Payloads are capped at kAirMaxPayload (the air header takes the rest).
+ *   The message goes to TAG_DST (default 0xFFFF, every node). With
+ *   TAG_ACK_MODE=1 and a TAG_DST naming one node, the node ACKs/retries on
+ *   its own (node_link) and later sends an unsolicited MSG_STATUS (seq=0)
+ *   with TAG_MSG_ID, TAG_MSG_STATUS (1 delivered, 2 failed) and
+ *   TAG_MSG_TRIES. Broadcasts are sent once and get no MSG_STATUS.
+ *
+ * - GET_LOG
+ *   Returns TAG_LOG_COUNT, TAG_LOG_SINCE (the id to request next), and up to
+ *   13 TAG_LOG_ENTRY values (55 with FLAG_LEN16) oldest-first, starting at
+ *   the optional request TAG_LOG_SINCE. Entry layout and event codes live in
+ *   node_log.hpp. The node never prints text on the serial port; diagnostics
+ *   go to this log.
+ *
+ * - GET_STATS
+ *   Returns the node_stats counters: link totals and heap, RESP_ERR counts
+ *   by reason, and per-verb in/out counts with min/avg/max handler time
+ *   (measured around dispatch with the cycle counter). TAG_STAT_RESET=1
+ *   zeroes them after the reply. TAG_FREE_MEM is the live heap;
+ *   TAG_FREE_FLASH is free NVS space as of the last load/commit.
+ *
+ * - SUBSCRIBE
+ *   Replaces the polling loop of a monitoring host. The body names the tags
+ *   to report (up to 16): len=0 just reports a tag; a numeric tag carrying a
+ *   value of its own width is also watched, with that value as threshold
+ *   (e.g. TAG_RSSI_DBM=3 for +-3 dB, TAG_VBAT_MV=50; 0 = any change).
+ *   TAG_SUB_PERIOD_S (u16 s) adds a regular report; 0 or absent means only
+ *   watched changes send one. The node checks once a second and sends an
+ *   unsolicited RESP_OK (seq=0) with TAG_SUB_SEQ and every subscribed tag
+ *   when a watched tag has moved by its threshold since the last report or
+ *   the period has run out. The reply carries TAG_SUB_PERIOD_S and the
+ *   current values, the baseline for the first change. A new SUBSCRIBE
+ *   replaces the old one (TAG_SUB_SEQ restarts at 1); an empty body cancels.
+ *   Unknown tags, thresholds on strings, or a set that could never report
+ *   get RESP_ERR. Subscriptions live in RAM: after a reboot (hello), hosts
+ *   subscribe again.
+ *
+ * Extended Frames
+ * ---------------
+ * Every reply uses the header form of its request (FLAG_LEN16 or classic),
+ * so bulk replies (GET_LOG, BATCH aggregates) grow to kFrameMax only when the
+ * host asked in the extended form. MSG bodies stay capped at one LoRa packet.
+ *
+ * - BATCH
+ *   Payload is several complete sub-frames. They run in order through this
+ *   same dispatcher and their responses come back concatenated in one BATCH
+ *   frame with the batch's seq (FLAG_MORE on all but the last aggregate if
+ *   they overflow one frame). NVS commits and modem reconfiguration wait
+ *   until the whole batch has run. Unsolicited frames (e.g. the hello after
+ *   SET_ID) are still sent on their own, ahead of the aggregate.
+ *
+ * - SET_BAUD
+ *   Takes TAG_BAUD (u32). Unsupported rates get RESP_ERR. Otherwise RESP_OK
+ *   with TAG_BAUD at the current rate, then node_protocol switches the UART
+ *   and reverts to 115200 unless a frame arrives at the new rate within
+ *   kBaudConfirmMs. TAG_BAUD is also readable with GET_PARAM.
+ *
+ * Radio Traffic
+ * -------------
+ * - Packets received over LoRa wait in the inbound queue and are forwarded to
+ *   the host as unsolicited MSG frames (seq=0, raw payload) by
+ *   node_interface_update(), one per call. The same call moves outbound
+ *   messages into the radio's TX ring as it drains.
+ * - Every frame the node sends carries the outbound queue state in its
+ *   flags byte: FLAG_QLVL (depth in quarters) and FLAG_XOFF (pause MSG).
+ *   TAG_Q_OUT / TAG_Q_IN / TAG_Q_DROPS give exact numbers; TAG_BUF_SIZE
+ *   (4..32) sets the per-direction capacity live.
+ * - SET_PARAM changes to FREQ/SF/BW/CR/TX_PWR/CHAN are applied to the modem
+ *   live. TAG_CHAN picks a channel of node_radio's plan (0..7, counted from
+ *   TAG_FREQ_HZ) or 0xFF to hop across all of them. Every transmit listens
+ *   first (CAD) and backs off while the channel is busy; GET_STATS adds
+ *   TAG_STAT_RADIO.
+ * - TAG_MODE=0 (relay) makes the node rebroadcast other nodes' traffic with
+ *   a random delay and duplicate suppression; TAG_HOPS is the hop budget of
+ *   messages (and ACKs) it originates. Both take effect immediately. See
+ *   node_link.hpp.
+ * - TAG_SLEEP=1 lets the node light-sleep whenever it is idle (node_power.hpp).
+ *   Hosts then prefix the first frame after a quiet spell with a few END
+ *   bytes. GET_STATS adds TAG_STAT_POWER (sleeps, wake causes, latency).
+ * - TAG_COMPRESS=1 sends MSG payloads packed with node_smaz when that is
+ *   shorter (flagged in the air header). Packed packets from other nodes
+ *   are unpacked regardless. GET_STATS adds TAG_STAT_PACK (bytes in and
+ *   out, tx ratio).
+ * - Beacons heard from neighbours feed node_adr: GET_STATS adds one
+ *   TAG_STAT_NBR row each (averaged RSSI/SNR, per-link SF), and TAG_ADR_SF
+ *   in GET_ALL is the SF that would still reach all of them. Advice only;
+ *   TAG_SF is never changed behind the host's back.
+ * - TAG_STORE=1 keeps MSGs that end LINK_FAILED, and air traffic that
+ *   arrives after kHostAwayMs of host silence, in the flash message store
+ *   (node_store.hpp). The former replay once another node is heard, the
+ *   latter ahead of new traffic on the host's next frame. TAG_STORE_PEND
+ *   counts what waits; TAG_FREE_FLASH includes the store's free room.
+ * - TAG_BEACON_SEC > 0 broadcasts a one-hop AIR_BEACON with the node ID at
+ *   that period (clamped to a day), driven by a node_sched timer on the
+ *   transport task. 0 stops it. Changing it restarts the period.
+ * - TAG_RSSI_DBM / TAG_SNR_DB report the last received packet.
  *
  * Boot-Time Behavior
  * ------------------
@@ -87,18 +192,32 @@
  *
  * Persistence Rules
  * -----------------
- * - All settable fields live in ESP32 NVS under a dedicated namespace.
+ * - All settable fields live in ESP32 NVS under a dedicated namespace, packed
+ *   into one versioned, CRC-checked blob ("cfg"). Boot is one read.
+ * - Each field has a dirty bit that is set only when its value changes.
+ *   Identical SET_PARAMs cost no flash writes.
+ * - Commits are deferred: one write once the link has been quiet for a short
+ *   window (bounded by a max age), from node_interface_service(). Call
+ *   node_interface_flush() before a deliberate power cut; esp_restart()
+ *   flushes automatically via a shutdown handler.
  * - Writes occur only after successful validation. Failed validation never
  *   touches NVS and returns RESP_ERR.
  * - String fields are bounded. We copy and clamp before writing.
+ * - TAG_CFG_GEN counts SET_PARAM/SET_ID requests that changed a value and is
+ *   persisted with them. Which rows changed in which generation is kept in
+ *   RAM only; after a reboot every row counts as changed in the persisted
+ *   generation, so deltas from before it return everything.
  *
  * Safety and Failure Modes
  * ------------------------
  * - All handlers are defensive about lengths and bounds. Unknown tags are
  *   ignored; malformed TLVs cause RESP_ERR for that operation without
  *   crashing the node.
- * - Display calls are guarded by node_display_available(). If the panel is
- *   missing, all UI calls silently no-op.
+ * - Display calls are guarded by node_display_available(). They only record
+ *   a request; the worker task pushes it to the panel, so I2C never blocks a
+ *   handler. If the panel is missing, all UI calls silently no-op.
+ * - Message text goes to the display scrollback: "> " for MSGs the host
+ *   sent, "< " for ones heard on air.
  * - Numeric conversions are explicit little-endian to keep cross-platform
  *   behavior predictable.
  *
@@ -119,11 +238,14 @@
  * Extending the Interface
  * -----------------------
  * 1) Define new Tag and/or Verb in @ref node_protocol.hpp.
- * 2) Add handling branches in node_interface_on_packet():
+ * 2) New tag: add one row to kTags in node_interface.cpp (width, storage or
+ *    getter, validator, flags, legacy key). GET_PARAM, GET_ALL, SET_PARAM and
+ *    the NVS blob pick it up from there. A new persisted row also needs a
+ *    DirtyBit and a kCfgVersion bump (the blob size is checked at compile time).
+ * 3) New verb: add a branch in the dispatcher:
  *    - Validate TLVs
  *    - Update state (if applicable)
  *    - Build RESP_OK with results, or RESP_ERR on failure
- * 3) Persist changes in save_to_nvs() if configuration is modified.
  * 4) If user-visible, call a minimal node_display_* helper.
  * Keep handlers short. If work grows complex, push it into a leaf module that
  * exposes a small API, and keep node_interface as the conductor.
@@ -192,6 +314,40 @@ const char* node_interface_id();
  */
 void node_interface_on_packet(const uint8_t* frame, size_t len);
 
+/**
+ * @brief Service radio traffic from the transport task.
+ *
+ * @details
+ * Pops at most one packet from the radio RX ring, records it as the last
+ * text, requests a display update, and forwards it to the host as
+ * an unsolicited MSG frame (seq=0). Call alongside node_protocol_update().
+ *
+ * @note Never blocks waiting for the radio; returns immediately when idle.
+ */
+void node_interface_update();
+
+/**
+ * @brief Slow upkeep, called periodically from the worker task.
+ *
+ * @details
+ * Commits coalesced NVS changes once their quiet window has closed. Runs off
+ * the transport task so flash latency never delays serial handling.
+ */
+void node_interface_service();
+
+/** @brief True when no config commit is pending (node_power may sleep). */
+bool node_interface_idle();
+
+/**
+ * @brief Commit any pending configuration changes to NVS immediately.
+ *
+ * @details
+ * SET_ID/SET_PARAM only mark fields dirty; the commit normally happens from
+ * node_interface_service() once the link goes quiet. Call this before a
+ * deliberate reset or power-down. No flash write happens if nothing changed.
+ */
+void node_interface_flush();
+
 /**
  * @brief Send an unsolicited "hello" frame announcing the node's ID.
  *
@@ -0,0 +1,248 @@
+#pragma once
+/**
+ * @page vt-node-link ViaText Node Link (air header, ACK/retry, duplicates, relay)
+ * @file node_link.hpp
+ * @brief The over-the-air frame format and the on-node reliability layer.
+ *
+ * Overview
+ * --------
+ * node_radio moves opaque packets. This module gives them a small header so
+ * nodes can tell messages apart, acknowledge them, and drop repeats. With
+ * TAG_ACK_MODE=1 one host MSG means "deliver reliably": the node keeps a
+ * copy, retransmits with randomized exponential backoff until an ACK comes
+ * back or it runs out of tries, and reports the outcome to the host
+ * asynchronously. The host never sees individual retries.
+ *
+ * Messages are framed where they lie: the air header goes into the
+ * node_msgq slot's headroom and the radio reads header + payload from the
+ * slot itself. A reliable message keeps its slot (not a copy) until the ACK
+ * or the last try; see node_msgq.hpp, Ownership.
+ *
+ *   MSG (host) -> node_msgq -> node_link_send()  -> node_radio -> air
+ *   air -> node_radio -> node_link_receive() -> ACK/dup/relay handling -> node_msgq
+ *   node_link_service() : retransmit and rebroadcast timers
+ *   node_link_poll()    : delivered/failed events for the host
+ *
+ * Air Header (kAirHdr bytes, little-endian, ahead of the payload)
+ * ---------------------------------------------------------------
+ *   [0]    magic : uint8   kAirMagic (v1)
+ *   [1]    kind  : uint8   bits 0..2 AirKind, bit 3 and bit 4 AirFlag,
+ *                          bits 5..7 try number (AIR_TRY_MASK)
+ *   [2..3] src   : uint16  sender address (hash of its node ID)
+ *   [4..5] dst   : uint16  receiver address, kAirBroadcast = everyone
+ *   [6..7] id    : uint16  message id, per sender (AIR_ACK: id being acked)
+ *   [8]    hops  : uint8   hop budget left (TAG_HOPS at origin)
+ *
+ * DATA payloads may be packed with node_smaz (AIR_F_PACKED, sender's
+ * TAG_COMPRESS=1, only when that is shorter). Receivers unpack before
+ * delivery whatever their own setting; relays forward the packed bytes.
+ *
+ * Beacons (AIR_BEACON, id 0, hops 1) announce a node to its neighbours
+ * every TAG_BEACON_SEC. Receivers log them (EV_BEACON_RX) and feed their
+ * RSSI/SNR to node_adr; they are never relayed, ACKed, or delivered to the
+ * host.
+ *
+ * Packets that do not start with kAirMagic, or are shorter than the header,
+ * come from older firmware and are delivered raw, as before.
+ *
+ * Reliability
+ * -----------
+ * - The ACK wait is derived from the LoRa time-on-air of the data packet
+ *   plus its ACK at the current modem settings (node_link_configure()).
+ * - Retry k waits ack_wait + random(0, ack_wait << k), so nodes that
+ *   collided once do not collide again on the next attempt.
+ * - Only a message addressed to one node (Msg::dst, from TAG_DST) is sent
+ *   reliably. A broadcast goes out once without AIR_F_ACKREQ, whatever
+ *   TAG_ACK_MODE says, and no outcome is reported: answers from every
+ *   neighbour would collide in exactly the window the backoff protects.
+ * - A receiver ACKs every AIR_F_ACKREQ packet addressed to it, including
+ *   repeats: a repeat usually means our ACK was lost. Repeats are never
+ *   delivered twice (see Seen-Cache).
+ * - An ACK closes a retransmit slot only if it comes from the slot's
+ *   destination and names its id, so LINK_DELIVERED means that node got
+ *   it, not that some node with a colliding id answered.
+ * - kRetxSlots messages can await ACKs at once. While the table is full
+ *   node_link_send() refuses reliable messages (SEND_BUSY) and they stay in node_msgq,
+ *   which then backpressures the host through FLAG_XOFF.
+ *
+ * Relay (TAG_MODE = 0)
+ * --------------------
+ * A relay rebroadcasts every packet not addressed only to itself (broadcast
+ * DATA, and DATA/ACKs for other nodes) while hops remain:
+ * - The copy goes out with hops - 1, after a random delay of up to two
+ *   packet airtimes, so neighbours that heard the same packet do not all
+ *   key up at once.
+ * - If, during that delay, we hear the same packet from a node at our hop
+ *   level or further out, our copy is cancelled: that area is covered.
+ * - Each (src, id, try) is relayed once. The try number in the header lets
+ *   a sender's retry (and the ACK answering it) cross the relays again,
+ *   which is what makes TAG_ACK_MODE=1 work over more than one hop.
+ * - ACKs leave with hops = TAG_HOPS, so they can travel back as far as
+ *   the data came.
+ * Our own packets echoed back by relays are ignored. kRelaySlots copies can
+ * wait at once; beyond that new relays are dropped (EV_RELAY_DROP).
+ *
+ * Seen-Cache
+ * ----------
+ * Duplicate detection is a fixed 64-entry open-addressed hash table of
+ * (src, id, tag) with a 4-slot probe window: constant time per packet and
+ * no heap, whatever the traffic. Entries expire after kSeenTtlMs; a full
+ * window overwrites its oldest entry, so under heavy traffic the cache
+ * forgets early rather than growing.
+ *
+ * Context
+ * -------
+ * Transport task only (node_interface_update() and the MSG handler).
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "node_radio.hpp"       // RadioPacket, RadioConfig, kRadioMaxPayload
+#include "node_msgq.hpp"        // Msg
+
+/** First byte of every v1 air packet. */
+static constexpr uint8_t kAirMagic = 0xA5;
+
+/** Air header bytes ahead of the payload. */
+static constexpr size_t kAirHdr = 9;
+
+/** Largest host payload that fits one air packet. */
+static constexpr size_t kAirMaxPayload = kRadioMaxPayload - kAirHdr;
+
+/** Destination address meaning "every node". */
+static constexpr uint16_t kAirBroadcast = 0xFFFF;
+
+/** Messages that can await an ACK at once. */
+static constexpr size_t kRetxSlots = 4;
+
+/** Transmissions per reliable message (first send + retries). */
+static constexpr uint8_t kRetxTries = 5;
+
+/** Rebroadcasts that can wait for their random delay at once. */
+static constexpr size_t kRelaySlots = 4;
+
+/** How long a heard (src, id) stays in the seen-cache. */
+static constexpr uint32_t kSeenTtlMs = 60000;
+
+/** Header byte [1] bits carrying the try number (0 = first send). */
+static constexpr uint8_t kAirTryShift = 5;
+static constexpr uint8_t AIR_TRY_MASK = 0xE0;
+
+static_assert(kRetxTries <= (AIR_TRY_MASK >> kAirTryShift) + 1, "try number must fit its header bits");
+
+/** Header byte [1] bits carrying the AirKind. */
+static constexpr uint8_t AIR_KIND_MASK = 0x07;
+
+/** @enum AirKind @brief Packet type (header byte [1] & AIR_KIND_MASK). */
+enum AirKind : uint8_t {
+  AIR_DATA   = 0x01,
+  AIR_ACK    = 0x02,
+  AIR_BEACON = 0x03     ///< one-hop presence; payload = sender's node ID
+};
+
+/** @enum AirFlag @brief Header flags (header byte [1]). */
+enum AirFlag : uint8_t {
+  AIR_F_PACKED = 0x08,    ///< DATA payload is a node_smaz code stream
+  AIR_F_ACKREQ = 0x10     ///< sender wants an AIR_ACK for this id
+};
+
+/** @enum LinkStatus @brief Outcome of a reliable send, reported to the host. */
+enum LinkStatus : uint8_t {
+  LINK_DELIVERED = 1,     ///< ACK received
+  LINK_FAILED    = 2      ///< kRetxTries sends, no ACK
+};
+
+/** @enum LinkSend @brief Result of node_link_send(): who owns the slot now. */
+enum LinkSend : uint8_t {
+  SEND_OK   = 0,          ///< in the radio TX ring; the link owns the slot
+  SEND_BUSY = 1,          ///< TX ring or retransmit table full; nothing changed, caller keeps it
+  SEND_DROP = 2           ///< can never be framed (over kAirMaxPayload); caller keeps it and should free it
+};
+
+/** @struct LinkEvent @brief One delivery outcome waiting for the host. */
+struct LinkEvent {
+  uint16_t id;            ///< message id (as returned in the MSG reply)
+  uint8_t  status;        ///< LinkStatus
+  uint8_t  tries;         ///< transmissions used
+};
+
+/** @brief Derive this node's 16-bit air address from its ID string. */
+void node_link_set_addr(const char* id);
+
+/** @brief This node's air address. */
+uint16_t node_link_addr();
+
+/**
+ * @brief Routing role: @p relay per TAG_MODE (0 = relay), @p max_hops per
+ *        TAG_HOPS (hop budget of our ACKs). Leaving relay mode discards
+ *        pending rebroadcasts.
+ */
+void node_link_set_route(bool relay, uint8_t max_hops);
+
+/** @brief Pack outbound DATA payloads with node_smaz when it saves bytes (TAG_COMPRESS). */
+void node_link_set_pack(bool on);
+
+/**
+ * @brief Hand every message that ends LINK_FAILED to @p fn (plain payload,
+ *        original id and hops), after its event is queued. nullptr = none.
+ */
+void node_link_on_fail(void (*fn)(const Msg& m));
+
+/** @brief Valid air packets heard from other nodes since boot (wraps). */
+uint32_t node_link_heard();
+
+/** @brief Recompute ACK timing for new modem settings. */
+void node_link_configure(const RadioConfig& cfg);
+
+/** @brief Allocate the next outbound message id (never 0). */
+uint16_t node_link_next_id();
+
+/**
+ * @brief Frame @p m in place for m.dst and hand it to the radio by
+ *        reference; keep it for retries if @p reliable and m.dst is not
+ *        kAirBroadcast.
+ *
+ * @return SEND_OK once the packet is in the radio TX ring: the link now
+ *         owns the slot (detach it from its queue) and frees it when the
+ *         radio and the retransmit table are done with it. SEND_BUSY if the
+ *         TX ring or the retransmit table is full: keep the message and try
+ *         again later. SEND_DROP if it is too long to ever go out. The link
+ *         never frees a slot it was not given.
+ */
+LinkSend node_link_send(Msg& m, bool reliable);
+
+/**
+ * @brief Broadcast one AIR_BEACON carrying @p id (truncated to kAirMaxPayload).
+ * @return false if the radio TX ring is full (the next period tries again).
+ */
+bool node_link_beacon(const char* id);
+
+/**
+ * @brief Process one received packet.
+ *
+ * Handles ACKs, duplicate suppression, and relaying internally.
+ *
+ * @param pkt Packet from node_radio_receive().
+ * @param m   The slot pkt.data points into (lent with node_radio_lend_rx()).
+ *            On true its payload is set up in place at m.data(); the air
+ *            header is consumed, so the headroom is free again.
+ * @return true if @p m should be delivered to the host; either way the
+ *         caller still owns it.
+ */
+bool node_link_receive(const RadioPacket& pkt, Msg& m);
+
+/** @brief Run retransmit and rebroadcast timers. Call every transport pass. */
+void node_link_service();
+
+/** @brief Pop the oldest delivery outcome, if any. */
+bool node_link_poll(LinkEvent& out);
+
+/** @brief Reliable messages currently awaiting an ACK. */
+size_t node_link_pending();
+
+/** @brief True when no retransmit or rebroadcast timer is running. */
+bool node_link_idle();
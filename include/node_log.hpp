@@ -0,0 +1,115 @@
+#pragma once
+/**
+ * @page vt-node-log ViaText Node Log (binary event ring)
+ * @file node_log.hpp
+ * @brief Fixed-size binary log entries in a RAM ring, pulled by the host.
+ *
+ * Overview
+ * --------
+ * The serial port carries SLIP frames and nothing else. Human-readable
+ * printf traces on the same port corrupt the host's decoder, block on the
+ * UART, and cost cycles formatting text nobody may read. This module keeps
+ * a small ring of fixed-size binary events instead. Recording one is a few
+ * stores under a spinlock; no formatting, no I/O.
+ *
+ * The host pulls entries in bulk with the GET_LOG verb when convenient and
+ * can watch TAG_LOG_COUNT to decide when. Decoding to text is a host job.
+ *
+ * Entry Format (wire, little-endian, 16 bytes per TAG_LOG_ENTRY value)
+ * --------------------------------------------------------------------
+ *   [0..3]   t_ms   : uint32  millis() when recorded
+ *   [4..5]   id     : uint16  monotonically increasing, wraps; gaps = overwritten
+ *   [6]      level  : uint8   LogLevel
+ *   [7]      event  : uint8   LogEvent
+ *   [8..11]  a      : uint32  event argument (see LogEvent)
+ *   [12..15] b      : uint32  event argument (see LogEvent)
+ *
+ * Retention
+ * ---------
+ * The ring keeps the newest kLogEntries events. When full, the oldest entry
+ * is overwritten; the host sees that as a jump in id.
+ *
+ * Event codes are part of the host contract, like Verb and Tag. Append new
+ * codes; never renumber.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Entries retained in RAM (16 bytes each). */
+static constexpr size_t kLogEntries = 64;
+
+/** Bytes per encoded TAG_LOG_ENTRY value. */
+static constexpr size_t kLogEntryWire = 16;
+
+/** @enum LogLevel @brief Severity carried in each entry. */
+enum LogLevel : uint8_t {
+  LVL_DEBUG = 0,
+  LVL_INFO  = 1,
+  LVL_WARN  = 2,
+  LVL_ERROR = 3
+};
+
+/** @enum LogEvent @brief What happened. Arguments a/b per code. */
+enum LogEvent : uint8_t {
+  EV_BOOT          = 0x01,  ///< a=esp_reset_reason()
+  EV_HOST_MSG      = 0x02,  ///< a=payload length, b=seq
+  EV_RADIO_RX      = 0x03,  ///< a=payload length, b=(uint16)rssi | (uint8)snr << 16
+  EV_RADIO_TX_FULL = 0x04,  ///< a=payload length (MSG refused, outbound queue full)
+  EV_RADIO_RX_DROP = 0x05,  ///< a=total RX ring overflows so far
+  EV_NVS_COMMIT    = 0x06,  ///< a=dirty mask written
+  EV_NVS_FAIL      = 0x07,  ///< a=dirty mask that failed to write
+  EV_SET_ID        = 0x08,  ///< a=new ID length
+  EV_SET_REJECT    = 0x09,  ///< a=verb, b=first offending tag (0 if n/a, e.g. malformed TLV body)
+  EV_BAD_VERB      = 0x0A,  ///< a=verb
+  EV_TX_TRUNC      = 0x0B,  ///< a=reply verb, b=seq (reply outgrew its frame; sent RESP_ERR)
+  EV_BAUD_SWITCH   = 0x0C,  ///< a=new baud, b=previous baud (SET_BAUD applied)
+  EV_BAUD_REVERT   = 0x0D,  ///< a=abandoned baud (no frame within kBaudConfirmMs)
+  EV_LINK_FAIL     = 0x0E,  ///< a=message id, b=transmissions (no ACK; host told LINK_FAILED)
+  EV_LINK_DUP      = 0x0F,  ///< a=src address, b=message id (repeat suppressed)
+  EV_RELAY_DROP    = 0x10,  ///< a=src address, b=message id (relay table full)
+  EV_BEACON_RX     = 0x11,  ///< a=src address, b=(uint16)rssi | (uint8)snr << 16
+  EV_UNPACK_FAIL   = 0x12,  ///< a=src address, b=message id (AIR_F_PACKED payload invalid)
+  EV_ADR_SF        = 0x13,  ///< a=neighbour address, b=old SF | new SF << 8
+  EV_REPLAY        = 0x14,  ///< a=verb, b=seq (retransmitted request answered from node_replay)
+  EV_RADIO_TX_DROP = 0x15   ///< a=packet length, b=TX starts tried (the modem never took it)
+};
+
+/**
+ * @struct LogEntry
+ * @brief One recorded event (host view mirrors the wire format above).
+ */
+struct LogEntry {
+  uint32_t t_ms;
+  uint16_t id;
+  uint8_t  level;
+  uint8_t  event;
+  uint32_t a;
+  uint32_t b;
+};
+
+/**
+ * @brief Record one event. Safe from any task; never blocks or allocates.
+ */
+void node_log(LogLevel level, LogEvent event, uint32_t a = 0, uint32_t b = 0);
+
+/** @brief Entries currently retained (0..kLogEntries). Backs TAG_LOG_COUNT. */
+uint16_t node_log_count();
+
+/**
+ * @brief Copy retained entries with id >= @p since, oldest first.
+ *
+ * @param since First id wanted (wrap-safe comparison). 0 after boot = all.
+ * @param out   Destination array.
+ * @param max   Capacity of @p out.
+ * @return Number of entries copied.
+ */
+size_t node_log_read(uint16_t since, LogEntry* out, size_t max);
+
+/**
+ * @brief Encode one entry into its 16-byte little-endian wire form.
+ */
+void node_log_encode(const LogEntry& e, uint8_t (&out)[kLogEntryWire]);
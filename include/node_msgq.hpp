@@ -0,0 +1,174 @@
+#pragma once
+/**
+ * @page vt-node-msgq ViaText Node Message Queues (static pool, two lanes)
+ * @file node_msgq.hpp
+ * @brief Outbound (host -> air) and inbound (air -> host) message queues.
+ *
+ * Overview
+ * --------
+ * The radio rings in node_radio are deliberately shallow: they exist to
+ * decouple SPI timing from the transport task, not to hold a backlog. This
+ * module is the backlog. Messages wait here, in a pool preallocated at
+ * build time, until the next stage can take them:
+ *
+ *   MSG (host) -> outbound queue -> node_radio TX ring -> air
+ *   air -> node_radio RX ring -> inbound queue -> unsolicited MSG (host)
+ *
+ * Each direction holds up to TAG_BUF_SIZE messages (clamped to
+ * kMsgQueueMax). Changing TAG_BUF_SIZE takes effect immediately; the pool
+ * itself never grows, shrinks, or touches the heap.
+ *
+ * Ownership
+ * ---------
+ * A pool slot is the only buffer a MSG payload ever has between the host
+ * link and the SX127x FIFO. Slots change hands instead of being copied:
+ *
+ *   node_msgq_alloc()   pool  -> caller   (fills it in place)
+ *   node_msgq_commit()  caller -> queue   (or back to the pool if refused)
+ *   node_msgq_detach()  queue -> caller   (e.g. node_link, after a send)
+ *   node_msgq_free()    caller -> pool
+ *
+ * Every slot has kMsgHeadroom spare bytes in front of its payload (buf[]),
+ * so node_link can put the air header there and node_interface the host
+ * frame header, and both send the slot as it stands. A slot is owned by
+ * exactly one party at a time; Msg::refs lets node_link keep a reliable
+ * message while the radio also reads it.
+ *
+ * Host -> air: SLIP decode buffer -> slot (the one copy) -> air header in
+ * the headroom -> radio loads the FIFO from the slot over SPI.
+ * Air -> host: the radio drains the FIFO into a slot lent to it
+ * (node_radio_lend_rx(), the one copy) -> node_link parses in place -> host
+ * frame header in the headroom -> SLIP-encoded from the slot.
+ *
+ * Lanes
+ * -----
+ * Every message is either control (LANE_CTRL: acks, beacons, host-flagged
+ * FLAG_CTRL frames) or chat (LANE_CHAT: everything else). Control always
+ * dequeues first, and the last kMsgCtrlReserve slots of each direction are
+ * held back for it, so a chat burst can never lock out control traffic.
+ *
+ * Drop Policy
+ * -----------
+ * - Outbound, full: the new message is refused: node_msgq_commit() puts
+ *   its slot back in the pool and returns false. The host hears RESP_ERR
+ *   and should retry; nothing already accepted is ever discarded.
+ * - Inbound, full: the air cannot be told to wait, so the oldest inbound
+ *   chat message is evicted to make room (freshest wins). If only control
+ *   messages are queued, the new chat message is the one dropped.
+ * Every refusal or eviction counts in node_msgq_drops().
+ *
+ * Backpressure to the Host
+ * ------------------------
+ * node_msgq_flags() folds the outbound state into header flag bits that
+ * node_interface sets on every frame it sends: FLAG_XOFF once the chat lane
+ * reaches its high-water mark (pause MSG until a frame arrives without it),
+ * and a two-bit depth level (FLAG_QLVL, quarters of capacity).
+ *
+ * Context
+ * -------
+ * All calls come from the transport task (handlers + node_interface_update),
+ * so the queues need no locks. Depth/drop getters are word reads and are
+ * safe from anywhere. Slots lent to the radio task are touched only by it
+ * until node_radio hands them back.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "node_radio.hpp"       // kRadioMaxPayload
+
+/** Most messages one direction can hold (TAG_BUF_SIZE upper bound). */
+static constexpr size_t kMsgQueueMax = 32;
+
+/** Fewest messages one direction can be configured to hold (TAG_BUF_SIZE lower bound). */
+static constexpr size_t kMsgQueueMin = 4;
+
+/** Slots per direction that only control messages may use. */
+static constexpr size_t kMsgCtrlReserve = 2;
+
+/**
+ * Slots that may be out of both queues at once: lent to the radio for RX,
+ * referenced by the radio TX ring or the retransmit table, or being filled.
+ * node_interface checks its sum at compile time.
+ */
+static constexpr size_t kMsgLoanMax = 18;
+
+/** Spare bytes ahead of every payload (an air header, or a host frame header). */
+static constexpr size_t kMsgHeadroom = 9;
+
+/** @enum MsgDir @brief Which queue. */
+enum MsgDir : uint8_t {
+  MQ_OUT = 0,   ///< host -> air
+  MQ_IN  = 1    ///< air -> host
+};
+
+/** @enum MsgLane @brief Priority lane; control dequeues before chat. */
+enum MsgLane : uint8_t {
+  LANE_CTRL = 0,
+  LANE_CHAT = 1
+};
+
+/**
+ * @struct Msg
+ * @brief One message (pool slot): headroom, then the payload.
+ */
+struct Msg {
+  uint8_t len;                         ///< Payload bytes at data()
+  uint8_t lane;                        ///< MsgLane
+  uint8_t hops;                        ///< Hop budget (outbound: TAG_HOPS at enqueue)
+  uint16_t id;                         ///< Outbound: node_link message id (reported to the host)
+  uint16_t dst;                        ///< Air destination address (outbound: TAG_DST at enqueue)
+  int16_t rssi_dbm;                    ///< Inbound only: packet RSSI
+  int8_t  snr_db;                      ///< Inbound only: packet SNR
+  uint8_t refs;                        ///< node_link: holders of a detached slot (radio, retransmit table)
+  uint8_t buf[kMsgHeadroom + kRadioMaxPayload];   ///< Headroom, then payload
+
+  uint8_t*       data()       { return buf + kMsgHeadroom; }
+  const uint8_t* data() const { return buf + kMsgHeadroom; }
+};
+
+/**
+ * @brief Set each direction's capacity (TAG_BUF_SIZE), clamped to
+ *        kMsgQueueMin..kMsgQueueMax. Messages already queued beyond a
+ *        smaller capacity stay queued; new ones wait for room.
+ */
+void node_msgq_set_capacity(size_t per_dir);
+
+/** @brief Take a free slot; the caller owns it. nullptr if the pool is empty. */
+Msg* node_msgq_alloc();
+
+/**
+ * @brief Queue an owned slot (len <= kRadioMaxPayload) on @p dir, on its
+ *        lane. Ownership passes either way.
+ * @return true if queued. false if refused (the slot went back to the pool);
+ *         for MQ_IN an older chat message may have been evicted instead
+ *         (see Drop Policy) and true returned.
+ */
+bool node_msgq_commit(MsgDir dir, Msg* m);
+
+/** @brief Oldest message of the highest-priority non-empty lane, or nullptr. */
+Msg* node_msgq_peek(MsgDir dir);
+
+/** @brief Free the message returned by node_msgq_peek(). */
+void node_msgq_pop(MsgDir dir);
+
+/** @brief Unqueue the message returned by node_msgq_peek() without freeing it; the caller owns it. */
+Msg* node_msgq_detach(MsgDir dir);
+
+/** @brief Return an owned slot to the pool. */
+void node_msgq_free(Msg* m);
+
+/** @brief Messages queued on @p dir (both lanes). */
+size_t node_msgq_depth(MsgDir dir);
+
+/** @brief Current per-direction capacity. */
+size_t node_msgq_capacity();
+
+/** @brief Messages refused or evicted since boot (both directions). */
+uint32_t node_msgq_drops();
+
+/** @brief Outbound backpressure as header flag bits (FLAG_XOFF | FLAG_QLVL). */
+uint8_t node_msgq_flags();
@@ -0,0 +1,93 @@
+#pragma once
+/**
+ * @page vt-node-power ViaText Node Power (light sleep between events)
+ * @file node_power.hpp
+ * @brief Opt-in ESP32 light sleep while the node has nothing to do.
+ *
+ * Overview
+ * --------
+ * The tasks already block instead of spinning, but the CPUs still run at
+ * full clock between packets. With TAG_SLEEP=1 the transport task, when it
+ * finds the whole node idle, enters ESP32 light sleep instead of a plain
+ * task wait. It wakes on any of:
+ *
+ *   UART0 RX edges   host traffic (see Waking a Sleeping Node)
+ *   DIO0 high        SX127x RxDone/TxDone (the modem keeps receiving)
+ *   timer            next SCHED_XPORT timer (beacons), at most kSleepMaxMs
+ *
+ * Idle means all of: no inbound frame for kSleepQuietMs and no SET_BAUD
+ * window open; radio idle (node_radio_idle()); no retransmit or relay
+ * pending; both message queues empty; no dirty config or display request;
+ * worker task idle. Any non-timer wake holds the node awake for another
+ * kSleepQuietMs, so a conversation runs without further sleeps.
+ *
+ * Builds with a Wi-Fi or BLE host link (kTransportWireless) never sleep:
+ * light sleep would drop the association, and a datagram or GATT write
+ * raises no wake source.
+ *
+ * Waking a Sleeping Node
+ * ----------------------
+ * UART wakeup counts RX edges, and the bytes that raised them are lost,
+ * along with anything that arrives while the clocks restart. A host that
+ * may talk to a sleeping node sends a few SLIP END bytes (0xC0; each gives
+ * one edge, empty frames are ignored), waits kWakeGuardMs, then sends the
+ * frame. Frames sent while awake need no preamble.
+ *
+ * Wake Latency
+ * ------------
+ * Timer wakeups have a known due time, so the gap between it and the task
+ * running again is the measured exit latency (last and worst case in
+ * TAG_STAT_POWER). UART and radio wakes go through the same exit path.
+ *
+ * Context
+ * -------
+ * node_power_try_sleep() only from vt_xport. Light sleep stalls the other
+ * core, which is why the worker must be idle first.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Host link must be silent this long before the node may sleep. */
+static constexpr uint32_t kSleepQuietMs = 3000;
+
+/** Shortest sleep worth entering (exit costs about a millisecond). */
+static constexpr uint32_t kSleepMinMs = 5;
+
+/** Longest single sleep; the task re-checks the world at least this often. */
+static constexpr uint32_t kSleepMaxMs = 1000;
+
+/** Host pause between the END preamble and the frame. */
+static constexpr uint32_t kWakeGuardMs = 3;
+
+/** TAG_STAT_POWER record bytes. */
+static constexpr size_t kPowerStatWire = 28;
+
+/** @enum PowerMode @brief TAG_SLEEP values. */
+enum PowerMode : uint8_t {
+  PWR_AWAKE = 0,   ///< never sleep (default)
+  PWR_LIGHT = 1    ///< light sleep when idle
+};
+
+/** @brief Select the power mode (TAG_SLEEP). */
+void node_power_set_mode(uint8_t mode);
+
+/**
+ * @brief Sleep for up to @p max_ms if the mode allows and the node is idle.
+ * @return true if it slept, or consumed a wakeup notification that raced
+ *         the idle checks; either way the caller should loop again at once.
+ *         false: nothing happened, wait as usual.
+ */
+bool node_power_try_sleep(uint32_t max_ms);
+
+/**
+ * @brief Encode the counters (little-endian u32 each): sleeps, slept ms,
+ *        UART wakes, radio wakes, timer wakes, last and max wake latency us.
+ */
+void node_power_encode(uint8_t (&out)[kPowerStatWire]);
+
+/** @brief Zero the counters (GET_STATS with TAG_STAT_RESET=1). */
+void node_power_reset_stats();
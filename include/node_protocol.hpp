@@ -7,22 +7,23 @@
  * Overview
  * --------
  * This module is the narrow waist between raw bytes and actionable frames.
- * It owns the serial link (USB CDC) with SLIP framing, converts byte streams
+ * It owns the host links (USB CDC with SLIP framing always; Wi-Fi UDP and BLE
+ * when the build selects them, see node_transport.hpp), converts their bytes
  * into complete inner frames, and forwards them to a single packet handler.
- * In the other direction, it SLIP-encodes caller-supplied frames and writes
- * them to the wire. It does not interpret tags or mutate node state.
+ * In the other direction, it encodes caller-supplied frames and writes them
+ * to the right link. It does not interpret tags or mutate node state.
  *
  * Design Objectives
  * -----------------
  * - Simplicity: a thin, reliable pipe. No TLV parsing here.
- * - Portability: Arduino + PacketSerial today, swappable tomorrow. Keep the
- *   boundary clean so alternative transports can slot in with the same API.
+ * - Portability: links are interchangeable behind the same API; adding one
+ *   (node_transport.hpp) does not touch node_interface.
  * - Autonomy: the serial path must stay hot. The update pump is fast, non-
- *   blocking, and safe to call in every loop() tick.
+ *   blocking, and safe to call on every pass of the transport task.
  *
  * Where It Sits
  * -------------
- * - Below: hardware UART/USB CDC and SLIP (PacketSerial).
+ * - Below: node_transport.* (SLIP over UART/USB CDC, UDP datagrams, BLE UART).
  * - Above: node_interface.* (verb/TLV interpretation, persistence, responses).
  *
  * Inner Frame Format (post-SLIP)
@@ -30,11 +31,25 @@
  * Bytes delivered to handlers are "inner frames" with a fixed 4-byte header:
  *
  *   [0] verb      : uint8   operation code (GET_ID, SET_PARAM, etc.)
- *   [1] flags     : uint8   reserved for future use (0 for now)
- *   [2] seq       : uint8   sequence number (host chosen; 0 allowed for unsolicited)
+ *   [1] flags     : uint8   bit field (see Flag); 0 = none
+ *   [2] seq       : uint8   sequence number (host chosen; 0 = unsolicited/unnumbered)
  *   [3] tlv_len   : uint8   number of bytes that follow as TLV payload
  *   [4..] TLVs    : sequence of Tag/Len/Value triplets (for verbs that use TLV)
  *
+ * Extended Length (FLAG_LEN16)
+ * ----------------------------
+ * With FLAG_LEN16 set in [1], the header grows by one byte and the body
+ * length becomes 16-bit little-endian:
+ *
+ *   [0] verb  [1] flags|FLAG_LEN16  [2] seq  [3] len_lo  [4] len_hi  [5..] body
+ *
+ * Whole inner frames are capped at kFrameMax bytes either way. The 4-byte
+ * form is unchanged and remains the default: the node answers each request
+ * in the form it arrived in, and switches its unsolicited frames (radio RX,
+ * hello) to the extended form only after the host has sent one itself. A
+ * host that never sets the bit never sees a 5-byte header. Use
+ * frame_hdr_len() / frame_body_len() rather than reading [3] directly.
+ *
  * TLV Encoding Rules (used upstream, documented here for clarity)
  * --------------------------------------------------------------
  *   +--------+--------+-------------+
@@ -47,14 +62,20 @@
  * - node_protocol_set_handler(cb) installs a function that receives complete
  *   inner frames. If no handler is set, frames are delivered to
  *   node_interface_on_packet() by default.
- * - node_protocol_update() pumps PacketSerial. Call it from loop() to process
- *   incoming bytes and fire the handler when a full frame is assembled.
+ * - node_protocol_update() pumps every link. Call it from the transport
+ *   task (node_tasks) to process incoming bytes and fire the handler when a
+ *   full frame is assembled. node_protocol_on_rx() lets that task sleep
+ *   until bytes arrive instead of spinning.
  *
  * Outbound Path
  * -------------
- * - protocol_send(frame, len) writes a prebuilt inner frame. This function
- *   handles SLIP encoding and serial write. The caller is responsible for
- *   building the 4-byte header and any TLVs correctly.
+ * - protocol_send(frame, len) writes a prebuilt inner frame, encoded in one
+ *   pass straight from the caller's buffer. Inside a handler, on the task
+ *   that dispatched it, that is the link the request arrived on (a reply);
+ *   every other send goes to all links with a host.
+ * - Build frames with FrameWriter (node_frame.hpp): it borrows a pooled
+ *   buffer, writes the header in the right form, bounds-checks every TLV,
+ *   and patches the length.
  * - node_protocol_send_text("...") is a convenience to emit a quick MSG
  *   frame with raw payload for demos/status. For production, prefer building
  *   explicit TLVs with seq/flags semantics.
@@ -65,13 +86,63 @@
  *   with the host-side command layer. Keep them synchronized with the host
  *   repo. Adding new verbs/tags is allowed so long as values do not collide.
  *
+ * Link Speed (SET_BAUD)
+ * ---------------------
+ * The node always boots at kBaudDefault. A host that wants more asks with
+ * SET_BAUD; the node answers at the current rate, drains its UART, and only
+ * then switches. The new rate is on probation: unless one well-formed frame
+ * arrives within kBaudConfirmMs, the node drops back to kBaudDefault on its
+ * own. Any frame confirms (PING is the natural choice). A host that loses
+ * the link therefore just waits out the window and reconnects at 115200:
+ *
+ *   host                                  node
+ *   SET_BAUD{TAG_BAUD=921600}  @115200 ->
+ *                             <- @115200  RESP_OK{TAG_BAUD=921600}
+ *   (switch port to 921600)               (drain TX, switch, start window)
+ *   PING                       @921600 ->  confirmed
+ *
+ * The rate is never persisted; a reset is always recoverable. SET_BAUD is
+ * refused (ERR_INVALID) when it arrives over UDP or BLE, which have no rate
+ * and could not confirm one.
+ *
+ * Retries and Pipelining
+ * ----------------------
+ * Requests are handled strictly in arrival order, one at a time, and each
+ * is answered before the next one runs, with its own seq (a BATCH may answer
+ * in FLAG_MORE parts). A host therefore need not wait for each reply before sending the next
+ * request; it may keep up to kReplaySlots (node_replay.hpp) requests
+ * outstanding, matching replies by seq:
+ *
+ *   host                                  node
+ *   SET_PARAM seq=1  ->
+ *   SET_PARAM seq=2  ->
+ *   MSG       seq=3  ->
+ *                                       <- RESP_OK seq=1
+ *                                       <- RESP_OK seq=2
+ *                                       <- RESP_OK seq=3
+ *
+ * Rules for the host:
+ * - Number requests 1..255 and do not reuse a seq while its request is
+ *   outstanding. seq 0 means "unnumbered": no retry protection.
+ * - A request whose reply does not arrive may be resent byte for byte with
+ *   the same seq. If it already ran (SET_ID, SET_PARAM, MSG, BATCH,
+ *   SET_BAUD, SUBSCRIBE), the node resends the original reply instead of running it
+ *   again, so NVS is not rewritten and a MSG does not go on air twice.
+ *   A request that was refused (RESP_ERR, e.g. ERR_BUSY) runs again.
+ *   This holds for the kReplaySlots most recent such requests and for
+ *   kReplayTtlMs. Reads simply run again.
+ * - Keep the unanswered bytes within the UART receive buffer
+ *   (2 x kFrameMax); beyond that the link itself drops input.
+ *
  * Default Limits and Behavior
  * ---------------------------
- * - Baud rate: 115200 by default (configurable at begin()).
+ * - Baud rate: 115200 at boot (configurable at begin(); raise it at run
+ *   time with SET_BAUD).
  * - Handler: single function pointer. Use your own multiplexer if you need
  *   to fan out by verb.
- * - MTU: bounded by PacketSerial buffers and your stack. Keep frames compact.
- * - Backpressure: PacketSerial buffers writes; callers should avoid long
+ * - MTU: kFrameMax bytes per inner frame (each link's receive buffer is
+ *   sized to match). Bodies over 255 bytes need FLAG_LEN16.
+ * - Backpressure: Serial buffers writes; callers should avoid long
  *   bursts without pacing. Consider small sleeps/yield on host side.
  *
  * Error Handling Philosophy
@@ -88,7 +159,7 @@
  * node_protocol_begin(115200);
  * node_protocol_set_handler(node_interface_on_packet);
  *
- * // loop()
+ * // transport task body (see node_tasks.cpp)
  * node_protocol_update(); // fires handler on complete frames
  *
  * // send a complete frame you built elsewhere:
@@ -105,14 +176,15 @@
  *
  * Extending the Transport
  * -----------------------
- * - If you replace PacketSerial or move off USB CDC, preserve the same API:
- *   begin(), update(), set_handler(), protocol_send(). Keep the inner frame
- *   contract intact so node_interface remains unchanged.
+ * - A new link is a class with update()/send()/pending()/operator bool
+ *   (node_transport.hpp), a LinkId, and a few lines in node_protocol.cpp's
+ *   begin/update/send. Keep the inner frame contract intact so
+ *   node_interface remains unchanged.
  *
  * Field Notes
  * -----------
- * - Keep loop() light. If you block, you lose frames. If you must work, slice
- *   it into short non-blocking steps and share time with node_protocol_update().
+ * - Keep handlers light. If you block, you lose frames. If you must work,
+ *   post it to the worker task (node_tasks_post()) and return.
  * - When debugging on Linux, use `pio device monitor --baud 115200` and
  *   confirm that unsolicited hello frames appear on boot.
  *
@@ -129,7 +201,6 @@
 #include "node_protocol.hpp"   // Core protocol state machine: handles ticks, updates, dispatch
 #include "node_interface.hpp"  // Hardware-specific I/O hooks: radio, serial, display integration
 #include <Arduino.h>           // Arduino framework core (pins, millis, Serial, etc.)
-#include <PacketSerial.h>      // Lightweight SLIP-style packet framing over serial
 #include <cstring>             // Standard C string helpers (memcpy, strlen, etc.)
 
 
@@ -165,6 +236,13 @@ enum Verb : uint8_t {
   /** @brief Carry a short text message payload to the node. */
   MSG       = 0x20,
 
+  /**
+   * @brief Unsolicited (seq 0): outcome of a reliable MSG (TAG_ACK_MODE=1).
+   *
+   * TLVs: TAG_MSG_ID (from the MSG reply), TAG_MSG_STATUS, TAG_MSG_TRIES.
+   */
+  MSG_STATUS = 0x21,
+
   // Generic parameterized ops (read/write TLVs)
   /** @brief Read specific tags (send tags with len=0 to request values). */
   GET_PARAM = 0x10,
@@ -172,9 +250,71 @@ enum Verb : uint8_t {
   /** @brief Write specific tags (send TLVs with values). */
   SET_PARAM = 0x11,
 
-  /** @brief Read a broad set of tags; used for initial sync/diagnostics. */
+  /**
+   * @brief Read a broad set of tags; used for initial sync/diagnostics.
+   *
+   * Optional TAG_CFG_SINCE: return only TAG_CFG_GEN and the persisted rows
+   * changed after that generation (everything when it is ahead of the node's).
+   */
   GET_ALL   = 0x12,
 
+  /** @brief Read retained log entries (optional TAG_LOG_SINCE = first id wanted). */
+  GET_LOG   = 0x13,
+
+  /**
+   * @brief Read hot-path counters (layouts in node_stats.hpp).
+   *
+   * Reply: TAG_STAT_LINK, TAG_STAT_ERR, TAG_STAT_POWER, TAG_STAT_PACK,
+   * TAG_STAT_RADIO, then one TAG_STAT_VERB per verb with traffic and one
+   * TAG_STAT_NBR per known neighbour, as many as fit the frame (use
+   * FLAG_LEN16 for the full set).
+   * Request TAG_STAT_RESET (u8 1) zeroes the counters after the reply is built.
+   */
+  GET_STATS = 0x14,
+
+  /**
+   * @brief Have the node push tag values instead of being polled.
+   *
+   * Request TLVs: optional TAG_SUB_PERIOD_S (u16, 0 = changes only), then the
+   * tags to report. A tag with len=0 is reported; a numeric tag with a value
+   * of its own width is also watched, and a move of at least that much
+   * (0 = any change) since the last report triggers one. Empty body cancels.
+   * Reply: RESP_OK with TAG_SUB_PERIOD_S and the current values (the
+   * baseline). Reports are unsolicited RESP_OK (seq 0) led by TAG_SUB_SEQ.
+   * See SUBSCRIBE in node_interface.hpp.
+   */
+  SUBSCRIBE = 0x15,
+
+  // Framing (meta) verbs
+  /**
+   * @brief Carry several complete inner frames in one packet.
+   *
+   * Payload is back-to-back sub-frames, each [verb][flags][seq][len][...].
+   * The node runs them in order and answers with one BATCH frame (same seq)
+   * whose payload is the sub-responses back-to-back. If those exceed one
+   * frame, every aggregate but the last carries FLAG_MORE. A malformed batch
+   * executes nothing and gets RESP_ERR. BATCH does not nest.
+   */
+  BATCH     = 0x40,
+
+  /**
+   * @brief Serial-path benchmark/echo.
+   *
+   * Request TLVs (all optional): TAG_BENCH_DATA (echoed back, repeatable),
+   * TAG_BENCH_FILL (u16: append that many pattern bytes, clamped to the
+   * frame). Reply: RESP_OK with TAG_BENCH_T_US, the echoed/filled
+   * TAG_BENCH_DATA TLVs, then TAG_BENCH_DT_US. See bin/vt_bench.py.
+   */
+  BENCH     = 0x41,
+
+  /**
+   * @brief Change the serial link rate (TAG_BAUD, u32, one of the supported rates).
+   *
+   * Reply RESP_OK (+TAG_BAUD) goes out at the old rate; the switch follows.
+   * See "Link Speed" above for the confirmation window and fallback.
+   */
+  SET_BAUD  = 0x42,
+
   // Standard response codes
   /** @brief Success response (payload may include returned TLVs). */
   RESP_OK   = 0x90,
@@ -184,6 +324,58 @@ enum Verb : uint8_t {
 };
 
 
+// -----------------------------------------------------------------------------
+// Header flags (byte [1])
+// -----------------------------------------------------------------------------
+
+/**
+ * @enum Flag
+ * @brief Bits in the inner-frame flags byte. Unknown bits must be ignored.
+ */
+enum Flag : uint8_t {
+  /** More aggregate frames for this seq follow (BATCH replies). */
+  FLAG_MORE  = 0x01,
+
+  /** Header is 5 bytes with a 16-bit little-endian body length at [3..4]. */
+  FLAG_LEN16 = 0x02,
+
+  /** Node -> host: outbound chat queue at high-water; hold MSG until a frame arrives without it. */
+  FLAG_XOFF  = 0x04,
+
+  /** Host -> node (MSG): queue on the control lane, ahead of chat traffic. */
+  FLAG_CTRL  = 0x08,
+
+  /** Node -> host: outbound queue depth in quarters of capacity (0..3), bits 4..5. */
+  FLAG_QLVL  = 0x30
+};
+
+/** Bit position of the FLAG_QLVL field. */
+static constexpr uint8_t kFlagQlvlShift = 4;
+
+/** Largest inner frame (header + body) either direction. */
+static constexpr size_t kFrameMax = 1024;
+
+/** Header bytes in the classic and FLAG_LEN16 forms. */
+static constexpr size_t kFrameHdr   = 4;
+static constexpr size_t kFrameHdr16 = 5;
+
+/** Boot rate, and the rate an unconfirmed SET_BAUD falls back to. */
+static constexpr uint32_t kBaudDefault   = 115200;
+
+/** Window after a SET_BAUD switch for the host to prove the new rate works. */
+static constexpr uint32_t kBaudConfirmMs = 2000;
+
+/** @brief Header length of @p f (caller guarantees at least 2 bytes). */
+inline size_t frame_hdr_len(const uint8_t* f) {
+  return (f[1] & FLAG_LEN16) ? kFrameHdr16 : kFrameHdr;
+}
+
+/** @brief Declared body length of @p f (caller guarantees frame_hdr_len() bytes). */
+inline size_t frame_body_len(const uint8_t* f) {
+  return (f[1] & FLAG_LEN16) ? (size_t(f[3]) | (size_t(f[4]) << 8)) : f[3];
+}
+
+
 // -----------------------------------------------------------------------------
 // TLV Tags (aligned with host commands.hpp)
 // -----------------------------------------------------------------------------
@@ -213,6 +405,18 @@ enum Tag : uint8_t {
   /** Boot time as Unix epoch seconds (unsigned 32-bit). */
   TAG_BOOT_TIME   = 0x05,
 
+  /** Serial link rate in baud (unsigned 32-bit; SET_BAUD argument, GET_PARAM readable). */
+  TAG_BAUD        = 0x06,
+
+  /** Request only (GET_ALL): config generation the host already holds (unsigned 32-bit). */
+  TAG_CFG_SINCE   = 0x07,
+
+  /** This node's air address, a hash of TAG_ID (unsigned 16-bit, read-only; node_link.hpp). */
+  TAG_ADDR        = 0x08,
+
+  /** Air address MSGs go to: 0xFFFF = every node (unsigned 16-bit, default 0xFFFF, not persisted). */
+  TAG_DST         = 0x09,
+
   // ---------------- Radio (SX127x-ish) ----------------
 
   /** RF frequency in Hz (unsigned 32-bit). */
@@ -230,7 +434,7 @@ enum Tag : uint8_t {
   /** Transmit power in dBm (signed 8-bit). */
   TAG_TX_PWR_DBM  = 0x14,
 
-  /** Abstract channel index (unsigned 8-bit). */
+  /** Channel plan index 0..7 above TAG_FREQ_HZ, or 0xFF = hop (unsigned 8-bit; node_radio.hpp). */
   TAG_CHAN        = 0x15,
 
   // ---------------- Behavior / Routing ----------------
@@ -244,12 +448,45 @@ enum Tag : uint8_t {
   /** Beacon interval in seconds (unsigned 32-bit). */
   TAG_BEACON_SEC  = 0x22,
 
-  /** Outbound queue size (unsigned 16-bit). */
+  /** Outbound/inbound queue capacity in messages (unsigned 16-bit, 4..32; see node_msgq.hpp). */
   TAG_BUF_SIZE    = 0x23,
 
-  /** ACK behavior flag: 0=disabled, 1=enabled. */
+  /** ACK behavior flag: 0=send once, 1=ACK/retry with MSG_STATUS reports for MSGs to one TAG_DST (node_link.hpp). */
   TAG_ACK_MODE    = 0x24,
 
+  /** Messages waiting in the outbound (host -> air) queue (unsigned 16-bit, read-only). */
+  TAG_Q_OUT       = 0x25,
+
+  /** Messages waiting in the inbound (air -> host) queue (unsigned 16-bit, read-only). */
+  TAG_Q_IN        = 0x26,
+
+  /** Messages refused or evicted by the queues since boot (unsigned 32-bit, read-only). */
+  TAG_Q_DROPS     = 0x27,
+
+  /** Node-assigned air message id (unsigned 16-bit; MSG reply, MSG_STATUS). */
+  TAG_MSG_ID      = 0x28,
+
+  /** Delivery outcome: 1=delivered (ACKed), 2=failed (unsigned 8-bit; MSG_STATUS). */
+  TAG_MSG_STATUS  = 0x29,
+
+  /** Transmissions used for the message (unsigned 8-bit; MSG_STATUS). */
+  TAG_MSG_TRIES   = 0x2A,
+
+  /** Power mode: 0=always awake, 1=light sleep when idle (unsigned 8-bit; node_power.hpp). */
+  TAG_SLEEP       = 0x2B,
+
+  /** On-air MSG payloads: 0=raw, 1=packed when shorter (unsigned 8-bit; node_smaz.hpp). */
+  TAG_COMPRESS    = 0x2C,
+
+  /** Store-and-forward: 0=off, 1=failed MSGs and host-away traffic go to flash (unsigned 8-bit; node_store.hpp). */
+  TAG_STORE       = 0x2D,
+
+  /** Messages waiting in the flash store, both directions (unsigned 16-bit). */
+  TAG_STORE_PEND  = 0x2E,
+
+  /** Config generation: +1 per SET_PARAM/SET_ID that changed something; persisted (unsigned 32-bit). */
+  TAG_CFG_GEN     = 0x2F,
+
   // ---------------- Diagnostics (read-only) ----------------
 
   /** Last received RSSI in dBm (signed 16-bit). */
@@ -258,20 +495,79 @@ enum Tag : uint8_t {
   /** Last received SNR in dB (signed 8-bit). */
   TAG_SNR_DB      = 0x31,
 
-  /** Supply or battery voltage in millivolts (unsigned 16-bit). */
+  /** Supply or battery voltage in millivolts, averaged (unsigned 16-bit; node_sense.hpp). */
   TAG_VBAT_MV     = 0x32,
 
-  /** Temperature in 0.1 °C units (signed 16-bit). */
+  /** ESP32 die temperature in 0.1 °C units, averaged (signed 16-bit; node_sense.hpp). */
   TAG_TEMP_C10    = 0x33,
 
   /** Free heap memory in bytes (unsigned 32-bit). */
   TAG_FREE_MEM    = 0x34,
 
-  /** Free flash storage in bytes (unsigned 32-bit). */
+  /** Free flash storage in bytes (unsigned 32-bit; message store room + NVS free entries x 32 B). */
   TAG_FREE_FLASH  = 0x35,
 
-  /** Log entry count (unsigned 16-bit). */
-  TAG_LOG_COUNT   = 0x36
+  /** Log entries currently retained (unsigned 16-bit). */
+  TAG_LOG_COUNT   = 0x36,
+
+  /** One binary log entry (16 bytes; layout in node_log.hpp). */
+  TAG_LOG_ENTRY   = 0x37,
+
+  /** First log id wanted by GET_LOG / next id to ask for (unsigned 16-bit). */
+  TAG_LOG_SINCE   = 0x38,
+
+  // ---------------- Benchmark (BENCH verb only) ----------------
+
+  /** Opaque bytes echoed by BENCH (repeatable, up to 255 bytes each). */
+  TAG_BENCH_DATA  = 0x39,
+
+  /** Pattern bytes BENCH should append to its reply (unsigned 16-bit). */
+  TAG_BENCH_FILL  = 0x3A,
+
+  /** esp_timer microseconds when the node began handling BENCH (unsigned 32-bit). */
+  TAG_BENCH_T_US  = 0x3B,
+
+  /** Microseconds the node spent building the BENCH reply (unsigned 32-bit). */
+  TAG_BENCH_DT_US = 0x3C,
+
+  // ---------------- Link quality (read-only) ----------------
+
+  /** SF that reaches every known neighbour with margin (unsigned 8-bit; node_adr.hpp). */
+  TAG_ADR_SF      = 0x3D,
+
+  // ---------------- Subscriptions (SUBSCRIBE) ----------------
+
+  /** Report period in seconds; 0 = only on watched changes (unsigned 16-bit). */
+  TAG_SUB_PERIOD_S = 0x3E,
+
+  /** Leads every report: count since SUBSCRIBE, from 1 (unsigned 16-bit). */
+  TAG_SUB_SEQ     = 0x3F,
+
+  // ---------------- Statistics (GET_STATS only; layouts in node_stats.hpp) ----------------
+
+  /** Link counters and heap (32 bytes). */
+  TAG_STAT_LINK   = 0x40,
+
+  /** RESP_ERR count per ErrReason (4 bytes each). */
+  TAG_STAT_ERR    = 0x41,
+
+  /** One verb's in/out counts and handler min/avg/max us (22 bytes, repeatable). */
+  TAG_STAT_VERB   = 0x42,
+
+  /** Request only: 1 = zero the counters after this reply (unsigned 8-bit). */
+  TAG_STAT_RESET  = 0x43,
+
+  /** Light-sleep counters and measured wake latency (28 bytes; node_power.hpp). */
+  TAG_STAT_POWER  = 0x44,
+
+  /** MSG packing byte counts and tx ratio in permille (36 bytes; node_stats.hpp). */
+  TAG_STAT_PACK   = 0x45,
+
+  /** One neighbour's averaged RSSI/SNR, beacons, age and per-link SF (11 bytes, repeatable; node_adr.hpp). */
+  TAG_STAT_NBR    = 0x46,
+
+  /** Listen-before-talk, hop-scan and TX start counters (32 bytes; node_radio.hpp). */
+  TAG_STAT_RADIO  = 0x47
 };
 
 
@@ -280,34 +576,81 @@ enum Tag : uint8_t {
 // -----------------------------------------------------------------------------
 
 /**
- * @brief Initialize the SLIP/Serial transport layer.
+ * @brief Initialize the host links.
  *
- * Sets up the UART (USB CDC) at the requested baud rate, attaches
- * PacketSerial for SLIP framing, and installs the internal packet
- * handler (`on_slip_packet()`).
+ * Sets up the UART (USB CDC) at the requested baud rate and starts the
+ * wireless links the build selected (Wi-Fi association and BLE advertising
+ * continue in the background).
  *
  * Call this once from `setup()` before using any protocol functions.
  *
  * @param baud Baud rate for the Serial link (default = 115200).
  *
  * @note This only sets up the transport. Actual frame processing
- *       happens when you call node_protocol_update() in loop().
+ *       happens when you call node_protocol_update() (transport task).
  */
 void node_protocol_begin(unsigned long baud = 115200);
 
 /**
- * @brief Advances the PacketSerial protocol handler.
+ * @brief Whether @p baud is a rate SET_BAUD accepts.
+ */
+bool node_protocol_baud_supported(uint32_t baud);
+
+/**
+ * @brief Schedule a link-rate change (the SET_BAUD mechanics).
+ *
+ * The switch happens in node_protocol_update() after the current handler
+ * returns and every queued TX byte has left at the old rate, so the reply
+ * that accepted the change is still readable by the host. A rate other than
+ * kBaudDefault must then be confirmed by one well-formed inbound frame
+ * within kBaudConfirmMs, or the link reverts to kBaudDefault.
+ *
+ * @param baud Requested rate.
+ * @return false (nothing scheduled) if the rate is not supported.
+ */
+bool node_protocol_set_baud(uint32_t baud);
+
+/** @brief Current serial link rate. Backs TAG_BAUD. */
+uint32_t node_protocol_baud();
+
+/**
+ * @brief Milliseconds since the last inbound frame, or 0 while bytes wait
+ *        in the UART or a SET_BAUD switch/confirmation is open. node_power
+ *        only sleeps once the host link has been quiet for a while.
+ */
+uint32_t node_protocol_idle_ms();
+
+/**
+ * @brief LinkId (node_transport.hpp) of the frame being handled, or
+ *        LINK_NONE outside a handler or on another task.
+ */
+uint8_t node_protocol_link();
+
+/**
+ * @brief Advances every host link.
  *
- * This function should be called from the main Arduino `loop()` to
- * service the PacketSerial state machine. It processes incoming bytes
- * from the serial buffer, assembles complete packets, and dispatches
- * them to the registered handler.
+ * This function should be called from the transport task to service the
+ * links. It processes incoming bytes and datagrams, assembles complete
+ * frames, and dispatches them to the registered handler.
  *
- * @note Non-blocking. Safe to call frequently.
+ * @note Non-blocking. Safe to call frequently. Also applies a scheduled
+ *       SET_BAUD switch and the fallback when its window expires, so the
+ *       caller must run it at least every few tens of milliseconds.
  */
 void node_protocol_update();
 
 
+/**
+ * @brief Register a callback fired when new serial bytes arrive.
+ *
+ * @param notify Function to call (from the UART driver's event task, or the
+ *        BLE host task) when RX data is available. Typically wakes the task that calls
+ *        node_protocol_update(). Must be short and must not touch Serial.
+ *
+ * @note Optional. Without it, callers simply poll node_protocol_update().
+ */
+void node_protocol_on_rx(void (*notify)());
+
 /**
  * @brief Set or replace the inbound packet handler.
  *
@@ -327,17 +670,19 @@ void node_protocol_update();
 void node_protocol_set_handler(void (*handler)(const uint8_t* frame, size_t len));
 
 /**
- * @brief Send one complete *inner* frame over Serial.
+ * @brief Send one complete *inner* frame to the host.
  *
- * This function accepts a raw, unencoded frame from the caller,
- * applies SLIP (Serial Line Internet Protocol) encoding, and writes
- * the resulting byte stream to the Serial port.
+ * This function accepts a raw, unencoded frame from the caller, applies
+ * the link's framing (SLIP for UART and BLE, one datagram for UDP), and
+ * writes it to the request's link (a reply) or to every link.
  *
  * @param frame Pointer to the raw (inner) frame data to be transmitted.
  * @param len   Length of the raw frame in bytes.
  *
  * @note The caller should pass the un-encoded frame. SLIP framing
  *       (start/end delimiters, escaping) is applied automatically here.
+ * @note Thread-safe: concurrent callers are serialized so frames never
+ *       interleave on the wire.
  */
 void protocol_send(const uint8_t* frame, size_t len);
 
@@ -348,8 +693,8 @@ void protocol_send(const uint8_t* frame, size_t len);
  * null-terminated string and sends it through the node protocol.
  *
  * @param s Pointer to a null-terminated C-string to be transmitted.
- *          The string should be short enough to fit within the 
- *          underlying frame buffer.
+ *          Up to 255 bytes go out in the classic 4-byte form; longer
+ *          strings (clamped to kFrameMax - 5) use FLAG_LEN16.
  *
  * @note This is a simplified helper intended for quick text-based
  *       messaging and testing. For full control, use the lower-level
@@ -0,0 +1,284 @@
+#pragma once
+/**
+ * @page vt-node-radio ViaText Node Radio (SX127x LoRa engine)
+ * @file node_radio.hpp
+ * @brief Interrupt-driven LoRa RX/TX for the TTGO LoRa32 SX1276/SX1278.
+ *
+ * Overview
+ * --------
+ * This module is the only code that talks to the SX127x. It brings the chip
+ * up with the node's stored radio parameters, keeps it listening (continuous
+ * RX, or a CAD scan when hopping), and moves packets between the air and two
+ * fixed-size SPSC rings:
+ *
+ *   DIO0 rise -> ISR -> radio task -> RX ring -> node_interface_update()
+ *   node_interface (MSG) -> TX ring -> radio task -> SX127x FIFO -> air
+ *
+ * The rest of the node only sees node_radio_send() / node_radio_receive().
+ *
+ * Buffers and Ownership
+ * ---------------------
+ * The radio keeps no packet storage for MSG traffic; it borrows it:
+ * - RX: the consumer lends empty buffers (node_radio_lend_rx(), up to
+ *   kRadioRxSlots). RxDone bursts the FIFO straight into the next one, and
+ *   node_radio_receive() hands it back holding the packet. With no buffer
+ *   lent the packet is dropped and counted, as a full ring was before.
+ * - TX: node_radio_send_ref() queues a pointer. The radio task loads the
+ *   FIFO from the caller's memory and then returns the owner cookie through
+ *   node_radio_sent(); until then the caller must leave the bytes alone.
+ *   If the modem refuses to start the transmit, the packet stays queued and
+ *   is tried again after one LBT slot; after kRadioTxStarts refusals it is
+ *   dropped, logged (EV_RADIO_TX_DROP), counted, and its cookie comes back
+ *   marked as not sent.
+ *   node_radio_send() still copies, for small packets built on the stack
+ *   (ACKs, beacons) and relay copies.
+ *
+ * Why a Radio Task
+ * ----------------
+ * On ESP32 the Arduino SPI driver takes a mutex per transaction, so SPI
+ * cannot run inside a GPIO ISR. The DIO0 ISR therefore does one thing: it
+ * notifies a small, high-priority radio task. That task drains the FIFO into
+ * the RX ring within microseconds of RxDone, independent of how long the
+ * transport task is busy with SLIP. Packets wait in the ring, not in the
+ * chip, so a slow host link no longer means a lost packet over the air.
+ *
+ * Design Objectives
+ * -----------------
+ * - Simplicity: one owner for SPI, one ISR, two rings. The only upward call
+ *   is an optional "packet ready" notifier (node_radio_on_rx()).
+ * - Portability: pins, backoff and scan timing are constants in
+ *   node_radio.cpp.
+ * - Autonomy: a missing or dead radio never blocks boot. All calls are
+ *   safe no-ops after a failed node_radio_begin(), like node_display.
+ *
+ * Channel Plan
+ * ------------
+ * TAG_CHAN picks one of kRadioChanCount channels above TAG_FREQ_HZ, which is
+ * channel 0; channel k sits k * 1.6 * BW higher (200 kHz steps at 125 kHz,
+ * the US915 raster). Nodes on different channels never hear or block each
+ * other, so a network split into channel groups carries up to
+ * kRadioChanCount times the traffic. The host picks a base frequency that
+ * keeps the top channel inside its band.
+ *
+ * TAG_CHAN = kRadioChanHop spreads one network over the whole plan instead:
+ * - TX: every packet goes out on a random plan channel.
+ * - RX: the radio scans the plan with CAD (channel activity detection, about
+ *   2 symbols per channel), and a CAD that sees a preamble makes it stay on
+ *   that channel in RX until the packet is in.
+ * - Every preamble is long enough to span one full scan, so a scanning
+ *   receiver always finds it (node_radio_preamble()).
+ * All nodes of a hopping network must hop. The scan keeps the radio task
+ * awake between CADs, which costs some power.
+ *
+ * Listen Before Talk
+ * ------------------
+ * Each transmit first runs one CAD on the channel the packet is about to go
+ * out on. If the channel is busy (a preamble on air, or a packet already
+ * being received), the packet waits a random 1..2^n backoff slots, with n
+ * the number of busy checks so far. The radio keeps listening while it
+ * waits. After kLbtMaxTries busy checks the packet is sent anyway; node_link
+ * retransmits if it collides.
+ * TAG_STAT_RADIO (node_radio_encode()) counts checks, deferrals, forced
+ * sends, backoff time, scan CADs, refused TX starts and dropped packets.
+ *
+ * Live Reconfiguration
+ * --------------------
+ * node_radio_configure() hands a full RadioConfig to the radio task, which
+ * applies it between packets (standby -> write registers -> RX). Callers
+ * never touch the chip directly, so SET_PARAM stays fast.
+ *
+ * Link Metrics
+ * ------------
+ * Each received packet carries its RSSI/SNR. The most recent values are also
+ * latched for TAG_RSSI_DBM / TAG_SNR_DB. Before the first packet both read
+ * as 0 ("no data yet").
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Largest payload the SX127x FIFO can carry in one LoRa packet. */
+static constexpr size_t kRadioMaxPayload = 255;
+
+/** RX buffers the radio can hold at once (lent, filled, or waiting in the RX ring). */
+static constexpr size_t kRadioRxSlots = 8;
+
+/** TX ring depth; also the most node_radio_send_ref() packets out at once. */
+static constexpr size_t kRadioTxSlots = 4;
+
+/** Channels in the plan (TAG_CHAN 0..kRadioChanCount-1). */
+static constexpr uint8_t kRadioChanCount = 8;
+
+/** TAG_CHAN value for hop mode: random TX channel, CAD scan on RX. */
+static constexpr uint8_t kRadioChanHop = 0xFF;
+
+/** Busy channel checks before a packet is sent regardless. */
+static constexpr uint8_t kLbtMaxTries = 6;
+
+/** Transmit starts the modem may refuse before the packet is dropped. */
+static constexpr uint8_t kRadioTxStarts = 3;
+
+/** TAG_STAT_RADIO record bytes. */
+static constexpr size_t kRadioStatWire = 32;
+
+/**
+ * @struct RadioConfig
+ * @brief Modem parameters, mirroring the radio tags in node_protocol.hpp.
+ */
+struct RadioConfig {
+  uint32_t freq_hz;   ///< RF center frequency (TAG_FREQ_HZ)
+  uint8_t  sf;        ///< Spreading factor 7..12 (TAG_SF)
+  uint32_t bw_hz;     ///< Signal bandwidth in Hz (TAG_BW_HZ)
+  uint8_t  cr;        ///< Coding rate denominator 5..8 (TAG_CR)
+  int8_t   tx_pwr;    ///< TX power in dBm (TAG_TX_PWR_DBM)
+  uint8_t  chan;      ///< Plan channel, or kRadioChanHop (TAG_CHAN)
+};
+
+/**
+ * @struct RadioPacket
+ * @brief One received packet, in a buffer lent with node_radio_lend_rx().
+ */
+struct RadioPacket {
+  uint8_t  len;                        ///< Payload bytes at data
+  int16_t  rssi_dbm;                   ///< Packet RSSI
+  int8_t   snr_db;                     ///< Packet SNR (rounded)
+  uint8_t* data;                       ///< The lent buffer, now holding the packet
+  void*    owner;                      ///< Cookie given with the buffer
+};
+
+/**
+ * @brief Bring up SPI, the SX127x, the DIO0 interrupt, and the radio task.
+ *
+ * @param cfg Initial modem parameters (normally loaded from NVS).
+ * @return true if the chip answered and RX is armed; false otherwise.
+ *
+ * @note Call once from boot. On failure every other node_radio_* call
+ *       degrades to a safe no-op and the node keeps serving serial.
+ */
+bool node_radio_begin(const RadioConfig& cfg);
+
+/**
+ * @brief Report whether the radio came up.
+ */
+bool node_radio_available();
+
+/**
+ * @brief Apply new modem parameters live.
+ *
+ * @param cfg Complete parameter set; caller has already validated ranges.
+ *
+ * @details Non-blocking. The radio task applies the change between packets.
+ *          A newer call before the task runs simply replaces the older one.
+ */
+void node_radio_configure(const RadioConfig& cfg);
+
+/**
+ * @brief Queue one payload for transmission.
+ *
+ * @param data Payload bytes.
+ * @param len  Payload length (1..kRadioMaxPayload).
+ * @return true if queued; false if the radio is down, the length is out of
+ *         range, or the TX ring is full (caller should report backpressure).
+ */
+bool node_radio_send(const uint8_t* data, size_t len);
+
+/** @brief True if the TX ring can take a packet now (node_radio_send_ref() will not refuse). */
+bool node_radio_tx_ready();
+
+/**
+ * @brief Queue a packet by reference; the radio reads @p data when it loads the FIFO.
+ *
+ * @param owner Cookie returned by node_radio_sent() once @p data is no
+ *              longer needed. The caller must not change or free the bytes
+ *              before that.
+ * @return false (nothing borrowed) under the same conditions as
+ *         node_radio_send(), or with kRadioTxSlots references already out.
+ */
+bool node_radio_send_ref(const uint8_t* data, size_t len, void* owner);
+
+/**
+ * @brief Take back one buffer queued with node_radio_send_ref().
+ * @return true with its @p owner, and @p aired false if the packet was
+ *         dropped without going out (kRadioTxStarts refused starts); false
+ *         if none is done yet.
+ */
+bool node_radio_sent(void*& owner, bool& aired);
+
+/** @brief True while the radio could take another RX buffer (it is up and holds fewer than kRadioRxSlots). */
+bool node_radio_wants_rx();
+
+/**
+ * @brief Lend an empty buffer of kRadioMaxPayload bytes for the next packet.
+ * @return false if the radio is down or already holds kRadioRxSlots (the
+ *         caller keeps the buffer).
+ */
+bool node_radio_lend_rx(uint8_t* buf, void* owner);
+
+/**
+ * @brief Pop the oldest received packet.
+ *
+ * @param out Set to the packet: its length, metrics, and the lent buffer it
+ *            was burst into, which is the caller's again.
+ * @return true if a packet was waiting; false if the ring is empty.
+ *
+ * @note Single consumer: call from one context only (the transport task),
+ *       the same one that lends buffers.
+ */
+bool node_radio_receive(RadioPacket& out);
+
+/**
+ * @brief Register a callback fired after each packet lands in the RX ring.
+ *
+ * @param notify Called from the radio task; typically wakes the consumer.
+ *        Must be short and non-blocking.
+ */
+void node_radio_on_rx(void (*notify)());
+
+/**
+ * @brief True when nothing is in flight: no TX queued or on air, no TX
+ *        buffer waiting to be returned, no RX waiting in the ring, DIO0
+ *        low. Always true without a radio.
+ */
+bool node_radio_idle();
+
+/** @brief Make DIO0 a light-sleep wake source (node_power, right before sleeping). */
+void node_radio_sleep_arm();
+
+/** @brief Undo node_radio_sleep_arm() and let the radio task check the chip. */
+void node_radio_sleep_disarm();
+
+/** @brief RSSI of the most recent packet in dBm (0 before the first packet). */
+int16_t node_radio_last_rssi();
+
+/** @brief SNR of the most recent packet in dB (0 before the first packet). */
+int8_t node_radio_last_snr();
+
+/** @brief Packets dropped because no RX buffer was lent. */
+uint32_t node_radio_rx_dropped();
+
+/** @brief Spacing between plan channels for a @p bw_hz bandwidth (1.6 x BW). */
+uint32_t node_radio_chan_step(uint32_t bw_hz);
+
+/**
+ * @brief Center frequency of plan channel @p chan under @p cfg.
+ * @details kRadioChanHop maps to channel 0, where a hopping node starts.
+ *          Other out-of-plan values wrap into the plan.
+ */
+uint32_t node_radio_chan_freq(const RadioConfig& cfg, uint8_t chan);
+
+/** @brief Preamble symbols @p cfg transmits: 8, or enough to span a full scan when hopping. */
+uint16_t node_radio_preamble(const RadioConfig& cfg);
+
+/**
+ * @brief Encode the channel access counters (little-endian u32 each): LBT
+ *        checks, busy checks (deferrals), forced sends, total backoff ms,
+ *        scan CADs, scan CADs that found a preamble, TX starts the modem
+ *        refused, packets dropped after kRadioTxStarts refusals.
+ */
+void node_radio_encode(uint8_t (&out)[kRadioStatWire]);
+
+/** @brief Zero the channel access counters. */
+void node_radio_reset_stats();
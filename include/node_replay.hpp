@@ -0,0 +1,85 @@
+#pragma once
+/**
+ * @page vt-node-replay ViaText Node Replay Cache (retransmitted requests)
+ * @file node_replay.hpp
+ * @brief Answers a retransmitted request from its cached reply instead of running it again.
+ *
+ * Overview
+ * --------
+ * The host's only signal that a request took effect is the reply. When that
+ * reply is lost (line noise, a host-side timeout racing a slow NVS erase),
+ * the host sends the same frame again, and without this module the node runs
+ * it again: a second SET_PARAM dirties and rewrites NVS, a second MSG goes
+ * out on air twice. node_interface records the reply to every state-changing
+ * request here and checks each incoming frame against the records first:
+ *
+ *   request -> node_replay_find()  hit: resend the recorded reply, done
+ *                                  miss: node_replay_begin()
+ *           -> dispatch -> reply() -> node_replay_record() -> wire
+ *           -> node_replay_end()
+ *
+ * Matching
+ * --------
+ * An entry is keyed by (host link, seq) and confirmed by the request's
+ * length and an FNV-1a hash of all its bytes, so reusing a seq for a
+ * different request executes it normally (and replaces the entry). seq 0
+ * means "unnumbered" and is never cached. Entries expire after kReplayTtlMs:
+ * a host that numbers nothing but still sends a nonzero constant seq must
+ * not have a deliberate repeat swallowed for long.
+ *
+ * Capacity
+ * --------
+ * kReplaySlots entries in a ring: the newest recorded request replaces the
+ * oldest, whatever the seq values, so the kReplaySlots most recent
+ * state-changing requests are always covered. That is the retry window a
+ * pipelining host may rely on (see "Retries and Pipelining" in
+ * node_protocol.hpp). A reply is kept only when it is one frame of at most
+ * kReplayFrameMax bytes (every classic-header reply); longer ones, and a
+ * BATCH answered with FLAG_MORE parts, are not cached and a retry runs again.
+ * Neither is a RESP_ERR: a refused request changed nothing, and a transient
+ * refusal (ERR_BUSY on a full queue) asks the host to resend exactly that
+ * frame, which must then run rather than get the old refusal back.
+ *
+ * On a hit the backpressure flags (FLAG_XOFF, FLAG_QLVL) are refreshed from
+ * the caller so the host never steers by a stale queue level.
+ *
+ * Context
+ * -------
+ * Transport task only (node_interface_on_packet() and its replies).
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "node_protocol.hpp"    // kFrameHdr
+
+/** Recorded requests; the retry window for a pipelining host. */
+static constexpr size_t kReplaySlots = 8;
+
+/** Largest reply kept (a full classic-header frame). */
+static constexpr size_t kReplayFrameMax = kFrameHdr + 255;
+
+/** A recorded reply older than this is no longer replayed. */
+static constexpr uint32_t kReplayTtlMs = 5000;
+
+/**
+ * @brief If @p frame repeats a recorded request on @p link, resend its reply
+ *        with the backpressure bits replaced by @p flags (FLAG_XOFF | FLAG_QLVL).
+ * @return true when the reply was resent; the request must not run.
+ */
+bool node_replay_find(uint8_t link, const uint8_t* frame, size_t len, uint8_t flags);
+
+/**
+ * @brief Start recording the reply to @p frame (seq 0 is ignored). Replaces
+ *        the oldest entry and any older one for the same (link, seq).
+ */
+void node_replay_begin(uint8_t link, const uint8_t* frame, size_t len);
+
+/** @brief A reply frame being sent; kept if a recording is open, it fits, and it is not RESP_ERR. */
+void node_replay_record(const uint8_t* reply, size_t len);
+
+/** @brief Close the recording: the entry is live only if exactly one reply fit. */
+void node_replay_end();
@@ -0,0 +1,81 @@
+#pragma once
+/**
+ * @file node_ring.hpp
+ * @brief Fixed-size single-producer/single-consumer ring with in-place slots.
+ *
+ * Overview
+ * --------
+ * A tiny lock-free queue for handing fixed-size records between exactly one
+ * producer context and exactly one consumer context (task <-> task, or
+ * task <-> loop()). No heap, no locks, no copies beyond what the caller does
+ * into the slot it was handed.
+ *
+ * Usage Model
+ * -----------
+ * Producer:
+ * @code
+ * if (T* slot = ring.write_slot()) { fill(*slot); ring.commit(); }
+ * @endcode
+ * Consumer:
+ * @code
+ * if (const T* slot = ring.read_slot()) { use(*slot); ring.release(); }
+ * @endcode
+ *
+ * Invariants
+ * ----------
+ * - N must be a power of two; indices wrap by masking.
+ * - head is written only by the producer, tail only by the consumer.
+ * - A slot returned by write_slot() is invisible to the consumer until
+ *   commit(); a slot returned by read_slot() is not reused until release().
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  // Producer side: next free slot, or nullptr when full.
+  T* write_slot() {
+    const uint32_t h = head_.load(std::memory_order_relaxed);
+    if (h - tail_.load(std::memory_order_acquire) >= N) return nullptr;
+    return &slots_[h & (N - 1)];
+  }
+
+  // Producer side: publish the slot handed out by write_slot().
+  void commit() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Consumer side: oldest published slot, or nullptr when empty.
+  const T* read_slot() const {
+    const uint32_t t = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == t) return nullptr;
+    return &slots_[t & (N - 1)];
+  }
+
+  // Consumer side: hand the slot from read_slot() back to the producer.
+  void release() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Approximate depth; exact when called from either owning context.
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  bool   empty() const { return size() == 0; }
+  bool   full()  const { return size() >= N; }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  T                     slots_[N];
+  std::atomic<uint32_t> head_{0};   // next slot the producer will fill
+  std::atomic<uint32_t> tail_{0};   // next slot the consumer will read
+};
@@ -0,0 +1,95 @@
+#pragma once
+/**
+ * @page vt-node-sched ViaText Node Scheduler (timer wheel, per-task budget)
+ * @file node_sched.hpp
+ * @brief Cooperative timers for periodic and deferred work on the node tasks.
+ *
+ * Overview
+ * --------
+ * Periodic chores (beacons, NVS commit checks, display refresh, sampling)
+ * should not each grow their own millis() bookkeeping inside a task loop.
+ * This module gives every task one hashed timer wheel instead:
+ *
+ *   vt_xport : node_protocol_update(); node_interface_update();
+ *              node_sched_run(SCHED_XPORT);          <- beacons
+ *   vt_work  : jobs; node_sched_run(SCHED_WORK);      <- NVS, display
+ *
+ * Timer Wheel
+ * -----------
+ * kSchedSlots buckets of kSchedTickMs each. A timer due at tick t sits in
+ * bucket t % kSchedSlots; timers further out than one rotation simply stay
+ * put until their tick comes round. Start, stop, and expiry are O(1) per
+ * timer; a run visits only the buckets whose ticks have passed (at most one
+ * full rotation, however long the task slept).
+ *
+ * Budget
+ * ------
+ * node_sched_run() fires at most kSchedBudget callbacks. Due timers beyond
+ * that wait in a ready list for the next pass, so a pile-up of chores can
+ * never hold the transport pump for more than a few callbacks. Callbacks
+ * must be short; anything slow belongs on SCHED_WORK.
+ *
+ * Periodic timers re-arm from their due tick (no drift). A timer that fell
+ * a whole period behind skips the missed runs instead of bursting.
+ *
+ * Context
+ * -------
+ * Each wheel belongs to its task: add/start/stop/run for SCHED_XPORT only
+ * from vt_xport (handlers included), for SCHED_WORK only from vt_work. Boot
+ * code may call anything before node_tasks_begin().
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Wheel resolution. */
+static constexpr uint32_t kSchedTickMs = 10;
+
+/** Buckets per wheel (power of two). One rotation = kSchedSlots * kSchedTickMs. */
+static constexpr size_t kSchedSlots = 32;
+
+/** Timers across both wheels. */
+static constexpr size_t kSchedTimers = 8;
+
+/** Callbacks fired per node_sched_run() call at most. */
+static constexpr size_t kSchedBudget = 4;
+
+/** @enum SchedCtx @brief Which task's wheel a timer runs on. */
+enum SchedCtx : uint8_t {
+  SCHED_XPORT = 0,    ///< vt_xport (core 1): may touch queues, link, host
+  SCHED_WORK  = 1     ///< vt_work (core 0): may block on I2C/flash
+};
+
+/** Timer callback. */
+typedef void (*SchedFn)();
+
+/** Handle returned by node_sched_add(); negative means none. */
+typedef int8_t SchedId;
+
+/**
+ * @brief Register a timer on @p ctx's wheel. It starts stopped.
+ * @return Handle, or -1 if all kSchedTimers are taken.
+ */
+SchedId node_sched_add(SchedCtx ctx, SchedFn fn);
+
+/**
+ * @brief (Re)arm @p id to fire in @p first_ms, then every @p period_ms.
+ *
+ * @p period_ms = 0 makes it one-shot. Restarting a running timer moves it.
+ */
+void node_sched_start(SchedId id, uint32_t first_ms, uint32_t period_ms);
+
+/** @brief Disarm @p id (including a run already waiting in the ready list). */
+void node_sched_stop(SchedId id);
+
+/** @brief Advance @p ctx's wheel to now and fire up to kSchedBudget callbacks. */
+void node_sched_run(SchedCtx ctx);
+
+/**
+ * @brief Milliseconds until @p ctx next needs node_sched_run(), capped at
+ *        @p cap_ms (0 if callbacks are already waiting). For task sleeps.
+ */
+uint32_t node_sched_idle_ms(SchedCtx ctx, uint32_t cap_ms);
@@ -0,0 +1,72 @@
+#pragma once
+/**
+ * @page vt-node-sense ViaText Node Sense (battery and die temperature sampler)
+ * @file node_sense.hpp
+ * @brief Background ADC sampling with cached, averaged telemetry.
+ *
+ * Overview
+ * --------
+ * An ADC conversion burst takes longer than a whole GET_ALL reply should,
+ * so handlers never touch the ADC. A SCHED_WORK timer samples every
+ * kSensePeriodMs into a moving average; TAG_VBAT_MV and TAG_TEMP_C10 read
+ * the cached averages, which costs the same as any other tag.
+ *
+ *   vt_work : sample() every kSensePeriodMs -> moving average -> cache
+ *   vt_xport: GET_ALL / GET_PARAM -> node_sense_vbat_mv() / _temp_c10()
+ *
+ * Battery
+ * -------
+ * The LoRa32 V2.1 feeds VBAT through a 100k/100k divider to GPIO35 (ADC1,
+ * so Wi-Fi never blocks it). Each sample is the mean of kSenseBurst
+ * conversions at 11 dB attenuation, converted with the core's eFuse
+ * calibration (analogReadMilliVolts) and scaled by the divider. With USB
+ * power and no cell the pin reads the charger output, about 4.2 V.
+ *
+ * Temperature
+ * -----------
+ * The ESP32's on-die sensor (temperatureRead()). It reads the silicon,
+ * several degrees above ambient, and varies between chips: good for trends
+ * and overheating, not for weather.
+ *
+ * Averaging
+ * ---------
+ * A box average over the last kSenseAvg samples (16 s), seeded by one
+ * synchronous sample in node_sense_begin() so the first GET_ALL is already
+ * real. The cached values are 16-bit and written in one store, so readers
+ * on the other core need no lock.
+ *
+ * Context
+ * -------
+ * node_sense_begin() at boot, before node_tasks_begin(). The readers from
+ * any task.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Battery divider tap (ADC1 channel 7). */
+static constexpr uint8_t kVbatPin = 35;
+
+/** VBAT / pin voltage (100k over 100k). */
+static constexpr uint32_t kVbatDivider = 2;
+
+/** Sampling period on the worker task. */
+static constexpr uint32_t kSensePeriodMs = 2000;
+
+/** Samples in the moving average. */
+static constexpr size_t kSenseAvg = 8;
+
+/** ADC conversions averaged into one battery sample. */
+static constexpr size_t kSenseBurst = 16;
+
+/** @brief Configure the ADC, take the first sample, and arm the sampler timer. */
+void node_sense_begin();
+
+/** @brief Averaged battery voltage in millivolts (TAG_VBAT_MV). */
+uint16_t node_sense_vbat_mv();
+
+/** @brief Averaged die temperature in 0.1 °C (TAG_TEMP_C10). */
+int16_t node_sense_temp_c10();
@@ -0,0 +1,56 @@
+#pragma once
+/**
+ * @page vt-node-smaz ViaText Node Short-Text Packer (static dictionary)
+ * @file node_smaz.hpp
+ * @brief SMAZ-style compression for short ASCII MSG payloads.
+ *
+ * Overview
+ * --------
+ * Every payload byte is airtime. MSG traffic is short English/ASCII status
+ * text, which general-purpose compressors cannot shrink (no history to work
+ * from in 30 bytes). A fixed dictionary of common fragments can: typical
+ * chat and status lines lose 25-40%. With TAG_COMPRESS=1 node_link packs
+ * each outbound DATA payload and sets AIR_F_PACKED when that made it
+ * shorter; receivers always unpack, so hosts only ever see plain text.
+ *
+ * Code Stream
+ * -----------
+ *   0x80..0xFF        dictionary entry (code - 0x80), 2..5 bytes of text
+ *   0x09 0x0A 0x0D    themselves
+ *   0x20..0x7E        themselves (printable ASCII costs nothing extra)
+ *   0x01 b            one verbatim byte
+ *   0x02 n b[n]       n verbatim bytes (n = 1..255), e.g. UTF-8 runs
+ * Every other byte is invalid and fails the unpack. The encoder is greedy
+ * (longest entry at each position), which is within a few percent of
+ * optimal for this dictionary and needs no buffers.
+ *
+ * Host Codec
+ * ----------
+ * bin/vt_smaz.py carries the same dictionary (same order) and stream
+ * format, so hosts can pack, unpack, or estimate savings offline. Changing
+ * the dictionary breaks interoperability with deployed nodes: append-only
+ * is not possible either (all 128 codes are used), so treat it as frozen.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Dictionary entries (codes 0x80..0xFF). */
+static constexpr size_t kSmazEntries = 128;
+
+/**
+ * @brief Pack @p n bytes of @p in into @p out.
+ * @return Packed length, or 0 if the result would not fit in @p cap bytes
+ *         (pass cap = n - 1 to accept only a real saving).
+ */
+size_t node_smaz_pack(const uint8_t* in, size_t n, uint8_t* out, size_t cap);
+
+/**
+ * @brief Unpack @p n bytes of code stream into @p out.
+ * @param out_len Set to the plain length on success.
+ * @return false on an invalid code or if the text exceeds @p cap.
+ */
+bool node_smaz_unpack(const uint8_t* in, size_t n, uint8_t* out, size_t cap, size_t& out_len);
@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * @page vt-node-stats ViaText Node Stats (always-on hot-path counters)
+ * @file node_stats.hpp
+ * @brief Frame, byte, error, and handler-time counters, read with GET_STATS.
+ *
+ * Overview
+ * --------
+ * Profiling a node in the field should not need a debugger or a special
+ * build. This module keeps a handful of plain counters that are cheap
+ * enough to leave on: a few adds under a spinlock per frame, and one cycle
+ * counter read either side of each handler. Nothing is formatted or sent
+ * until the host asks with GET_STATS.
+ *
+ * What Is Counted
+ * ---------------
+ * - Link   : frames/bytes in (decoded inner frames) and out (SLIP wire bytes),
+ *            malformed inner frames, receive-buffer overflows, heap low-water.
+ * - Errors : one counter per ErrReason, bumped for every RESP_ERR sent.
+ * - Packing: MSG payload bytes before and after node_smaz on the way to the
+ *            air (TAG_COMPRESS) and back, plus packets that failed to unpack.
+ * - Verbs  : per verb, frames handled and frames sent, plus min/avg/max
+ *            handler time (cycle counter, reported in microseconds). A
+ *            BATCH row's time includes its sub-frames, which are also
+ *            counted under their own verbs.
+ *
+ * Wire Records (little-endian; see GET_STATS in node_protocol.hpp)
+ * ----------------------------------------------------------------
+ *   TAG_STAT_LINK (32 bytes): rx_frames, rx_bytes, rx_malformed, rx_overflow,
+ *                             tx_frames, tx_bytes, free_heap, min_free_heap
+ *                             (all uint32)
+ *   TAG_STAT_ERR  (4 * kErrReasons bytes): uint32 per ErrReason, in code order
+ *   TAG_STAT_PACK (36 bytes): tx_msgs, tx_packed, tx_plain_bytes,
+ *                             tx_air_bytes, rx_packed, rx_air_bytes,
+ *                             rx_plain_bytes, rx_bad, tx_ratio_permille
+ *                             (air/plain * 1000; 0 before any traffic)
+ *   TAG_STAT_VERB (22 bytes, one per active verb):
+ *     [0]      verb    : uint8
+ *     [1]      reserved: uint8  (0)
+ *     [2..5]   in      : uint32 frames handled
+ *     [6..9]   out     : uint32 frames sent with this verb
+ *     [10..13] min_us  : uint32
+ *     [14..17] avg_us  : uint32
+ *     [18..21] max_us  : uint32
+ *
+ * Counters wrap at 2^32 and reset only at boot or on request. Like log
+ * event codes, ErrReason values are part of the host contract: append,
+ * never renumber.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** @enum ErrReason @brief Why a RESP_ERR was sent (one counter each). */
+enum ErrReason : uint8_t {
+  ERR_TRUNCATED  = 0,   ///< declared body longer than the frame
+  ERR_BAD_VERB   = 1,   ///< unknown verb
+  ERR_INVALID    = 2,   ///< missing, malformed, or out-of-range TLV
+  ERR_TOO_LARGE  = 3,   ///< request payload over a hard limit (e.g. one LoRa packet)
+  ERR_REPLY_FULL = 4,   ///< reply outgrew its frame
+  ERR_BUSY       = 5,   ///< resource full (radio TX ring); retry later
+  ERR_BATCH      = 6    ///< malformed or nested BATCH
+};
+
+/** Number of ErrReason codes. */
+static constexpr size_t kErrReasons = 7;
+
+/** Encoded record sizes. */
+static constexpr size_t kStatLinkWire = 32;
+static constexpr size_t kStatErrWire  = 4 * kErrReasons;
+static constexpr size_t kStatVerbWire = 22;
+static constexpr size_t kStatPackWire = 36;
+
+/** @brief One decoded inner frame arrived (@p bytes after SLIP decoding). */
+void node_stats_rx_frame(size_t bytes);
+
+/** @brief An inner frame failed the header/length check and was dropped. */
+void node_stats_rx_malformed();
+
+/** @brief The SLIP receive buffer overflowed (frame larger than kFrameMax). */
+void node_stats_rx_overflow();
+
+/** @brief One frame with verb @p verb went out as @p wire_bytes SLIP bytes. */
+void node_stats_tx_frame(uint8_t verb, size_t wire_bytes);
+
+/** @brief A handler for @p verb ran for @p cycles CPU cycles. */
+void node_stats_handled(uint8_t verb, uint32_t cycles);
+
+/** @brief A DATA payload of @p plain bytes went on air as @p air bytes (equal: sent raw). */
+void node_stats_pack_tx(size_t plain, size_t air);
+
+/** @brief A packed payload of @p air bytes unpacked to @p plain bytes. */
+void node_stats_pack_rx(size_t air, size_t plain);
+
+/** @brief A packed payload failed to unpack and was dropped. */
+void node_stats_pack_bad();
+
+/** @brief A RESP_ERR was sent for @p reason. */
+void node_stats_error(ErrReason reason);
+
+/** @brief Zero every counter (heap low-water is the allocator's own). */
+void node_stats_reset();
+
+/** @brief Encode the TAG_STAT_LINK record. */
+void node_stats_encode_link(uint8_t (&out)[kStatLinkWire]);
+
+/** @brief Encode the TAG_STAT_ERR record. */
+void node_stats_encode_err(uint8_t (&out)[kStatErrWire]);
+
+/** @brief Encode the TAG_STAT_PACK record. */
+void node_stats_encode_pack(uint8_t (&out)[kStatPackWire]);
+
+/** @brief Number of verb rows that node_stats_encode_verb() can be asked for. */
+size_t node_stats_verb_rows();
+
+/**
+ * @brief Encode verb row @p row as a TAG_STAT_VERB record.
+ * @return false (nothing written) if that verb has no traffic yet.
+ */
+bool node_stats_encode_verb(size_t row, uint8_t (&out)[kStatVerbWire]);
@@ -0,0 +1,125 @@
+#pragma once
+/**
+ * @page vt-node-store ViaText Node Store (append-only message log in flash)
+ * @file node_store.hpp
+ * @brief Store-and-forward for messages the air or the host could not take.
+ *
+ * Overview
+ * --------
+ * node_msgq holds a few dozen messages in RAM and forgets them on reset.
+ * With TAG_STORE=1 two kinds of message go to flash instead of being lost:
+ *
+ *   STORE_OUT  host MSG that exhausted its retries (LINK_FAILED). Replayed
+ *              into the outbound queue once another node is heard again.
+ *   STORE_IN   air message that arrived while the host was away (no frame
+ *              for kHostAwayMs). Replayed, oldest first, ahead of new
+ *              traffic as soon as the host sends any frame.
+ *
+ * A replayed outbound message keeps its TAG_MSG_ID, so the host sees a
+ * second MSG_STATUS (delivered) for the id it first saw fail.
+ *
+ * Partition
+ * ---------
+ * The log owns the "vtlog" data partition (subtype kStorePartSubtype, see
+ * partitions.csv), where the default layout had an unused SPIFFS area.
+ * Without that partition TAG_STORE=1 simply stores nothing.
+ *
+ * Log Layout
+ * ----------
+ * The partition is a ring of 4 KB sectors written strictly in order, so
+ * every sector is erased once per lap: wear levelling comes from the layout
+ * itself. Each sector starts with
+ *
+ *   [0..3] magic kStoreMagic   [4..7] generation (+1 per sector opened)
+ *
+ * followed by 4-byte aligned records:
+ *
+ *   [0]    mark  : 0xFE live, 0x00 consumed (cleared in place, no erase)
+ *   [1]    kind  : StoreKind
+ *   [2]    len   : payload bytes
+ *   [3]    hops  : hop budget (STORE_OUT) / 0
+ *   [4..5] id    : air message id / 0
+ *   [6..7] dst   : air destination (Msg::dst)
+ *   [8..9] crc   : CRC-16/CCITT over bytes 1..7 and the payload
+ *   [10..] payload
+ *
+ * A 0xFF mark ends a sector's records. Opening a new sector when the ring
+ * is full erases the oldest one; live records there are dropped and
+ * counted (the oldest messages lose, as in node_msgq's inbound queue).
+ *
+ * Index and Reads
+ * ---------------
+ * Boot scans the partition once and keeps, per kind, a FIFO of the flash
+ * offsets of live records (kStoreIndex each, 4 bytes per entry). The
+ * partition is mapped with esp_partition_mmap(), so a replay copies the
+ * record straight from the mapping into its queue slot with no flash read
+ * call and no bounce buffer; the CRC is re-checked on that copy.
+ * Consumption drops the index entry at once and clears the mark later, so
+ * a reset in between replays that message again (at least once, never lost).
+ *
+ * Context
+ * -------
+ * - node_store_put/peek/pop and the getters: transport task.
+ * - Flash writes and erases: worker task (SCHED_WORK timer), like NVS
+ *   commits. A sector erase stalls the flash cache for tens of ms; the host
+ *   link can lose bytes then and SLIP resyncs, as with NVS page erases.
+ * - node_store_begin() at boot, before node_tasks_begin().
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "node_msgq.hpp"        // Msg
+
+/** Partition subtype of "vtlog" (custom data range 0x40..0xFE). */
+static constexpr uint8_t kStorePartSubtype = 0x40;
+
+/** First word of every formatted sector ("VTL2"; "VTL1" logs had no dst and are not read). */
+static constexpr uint32_t kStoreMagic = 0x324C5456;
+
+/** Erase unit and log sector. */
+static constexpr size_t kStoreSector = 4096;
+
+/** Live records indexed per kind; beyond that new ones are refused. */
+static constexpr size_t kStoreIndex = 256;
+
+/** Host silence after which inbound messages go to the store. */
+static constexpr uint32_t kHostAwayMs = 60000;
+
+/** @enum StoreKind @brief Why a message was stored. */
+enum StoreKind : uint8_t {
+  STORE_OUT = 1,          ///< host -> air, delivery failed
+  STORE_IN  = 2           ///< air -> host, host away
+};
+
+/** @brief Find and map the partition, rebuild the index, arm the writer timer. */
+void node_store_begin();
+
+/** @brief True if the "vtlog" partition exists and is mapped. */
+bool node_store_ready();
+
+/**
+ * @brief Queue @p m for appending as @p kind (written by the worker shortly).
+ * @return false if there is no partition or the write queue is full.
+ */
+bool node_store_put(StoreKind kind, const Msg& m);
+
+/**
+ * @brief Copy the oldest live @p kind record into @p out (len, hops, id, dst, data).
+ * @return false if none is waiting.
+ */
+bool node_store_peek(StoreKind kind, Msg& out);
+
+/** @brief Consume the record node_store_peek() returned. */
+void node_store_pop(StoreKind kind);
+
+/** @brief Live records of @p kind. */
+size_t node_store_pending(StoreKind kind);
+
+/** @brief Bytes that can be appended before live records would be dropped. */
+uint32_t node_store_free_bytes();
+
+/** @brief Live records lost to ring wrap, index overflow, or a full write queue. */
+uint32_t node_store_drops();
@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * @page vt-node-tasks ViaText Node Tasks (dual-core runtime)
+ * @file node_tasks.hpp
+ * @brief FreeRTOS task layout: a pinned transport task and a worker task.
+ *
+ * Overview
+ * --------
+ * The ESP32 has two cores. This module puts them to work with a fixed,
+ * boring layout so serial latency no longer depends on what the display or
+ * flash happens to be doing:
+ *
+ *   Core 1 (APP_CPU)  vt_xport  high priority
+ *     - node_protocol_update()   : SLIP pump + verb handlers
+ *     - node_interface_update()  : radio RX ring -> host
+ *     - SCHED_XPORT timers       : beacons (node_sched)
+ *     Sleeps on a task notification from UART RX and radio RX, or until
+ *     its next timer is due; with TAG_SLEEP=1 and nothing pending anywhere,
+ *     puts the chip in light sleep instead (node_power).
+ *
+ *   Core 0 (PRO_CPU)  vt_radio  (node_radio.cpp, DIO0-driven)
+ *                     vt_work   low priority
+ *     - runs NodeJob items posted by handlers
+ *     - SCHED_WORK timers (node_sched):
+ *       node_display_service()   : render + push dirty OLED pages, 50 ms
+ *       node_interface_service() : deferred NVS commits, 100 ms
+ *
+ * Handlers never block on I2C or flash. Anything slow is wrapped in a
+ * NodeJob and posted to the bounded worker queue.
+ *
+ * Rules
+ * -----
+ * - Handlers run on vt_xport only. Keep them short and non-blocking.
+ * - Jobs carry their own copy of any data they need (up to kJobDataMax).
+ *   They must not point into frame buffers, which are gone by the time the
+ *   worker runs.
+ * - If the queue is full, node_tasks_post() returns false and the job is
+ *   dropped. Only post work that is safe to lose or that is re-derived from
+ *   state anyway. Subsystems with their own coalescing (display, NVS) skip
+ *   the queue entirely and are polled from the worker's timer wheel.
+ * - Periodic work is a node_sched timer on the right task's wheel, not a
+ *   millis() check added to a task loop.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Inline payload bytes carried by one job (enough for a 63-char line + NUL). */
+static constexpr size_t kJobDataMax = 64;
+
+/**
+ * @struct NodeJob
+ * @brief One unit of deferred work for the worker task (copied by value).
+ */
+struct NodeJob {
+  void    (*fn)(const NodeJob& job);   ///< Runs on the worker task
+  uint8_t len;                         ///< Bytes used in data[]
+  uint8_t data[kJobDataMax];           ///< Job-owned copy of its input
+};
+
+/**
+ * @brief Create the worker queue and start the transport and worker tasks.
+ *
+ * @note Call once at the end of setup(), after every subsystem is up. From
+ *       then on loop() has nothing to do.
+ */
+void node_tasks_begin();
+
+/**
+ * @brief Post a job to the worker task without blocking.
+ *
+ * @param job Job to copy into the queue.
+ * @return true if queued (or run); false if the queue is full.
+ *
+ * @note Before node_tasks_begin() the job runs inline on the caller. Boot
+ *       code may block, and this keeps setup() ordering obvious.
+ */
+bool node_tasks_post(const NodeJob& job);
+
+/**
+ * @brief Wake the transport task early (e.g., new bytes or a radio packet).
+ *
+ * @note Safe from any task context. Not for ISRs.
+ */
+void node_tasks_wake_transport();
+
+/** @brief Jobs dropped because the worker queue was full. */
+uint32_t node_tasks_dropped();
+
+/**
+ * @brief True while the worker is blocked waiting with no job queued
+ *        (node_power: light sleep would stall it mid-I2C or mid-flash).
+ */
+bool node_tasks_worker_idle();
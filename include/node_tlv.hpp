@@ -0,0 +1,91 @@
+#pragma once
+/**
+ * @page vt-node-tlv ViaText Node TLV View (validated request bodies)
+ * @file node_tlv.hpp
+ * @brief One-pass validated view over an inner frame's TLV body, with a per-frame tag index.
+ *
+ * Overview
+ * --------
+ * Every request TLV is parsed here and nowhere else. The constructor walks
+ * the body once and either accepts it whole or not at all:
+ *
+ *   ok()     header present, declared body inside the frame, every TLV
+ *            complete inside the body, no stray bytes at the end
+ *   find()   first TLV with a tag: O(1) below kTlvIndexSlots, a scan above
+ *   for (const TlvView::Item& t : view)   every TLV in wire order
+ *
+ * Handlers check ok() once (node_interface answers ERR_INVALID) and after
+ * that read values without bounds arithmetic of their own. Duplicate tags
+ * are kept for iteration; find() returns the first, as the wire order says.
+ *
+ * Cost
+ * ----
+ * The index is kTlvIndexSlots 16-bit offsets on the caller's stack, cleared
+ * and filled during the validating walk, so a frame is never scanned twice
+ * however many tags a handler looks up. Every table tag and request-side
+ * tag except TAG_STAT_RESET (0x43) falls below kTlvIndexSlots.
+ *
+ * Lifetime
+ * --------
+ * A view points into the frame it was built from; it owns nothing and must
+ * not outlive the handler call.
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/** Tags 0x00..kTlvIndexSlots-1 are looked up through the index. */
+static constexpr size_t kTlvIndexSlots = 64;
+
+/**
+ * @class TlvView
+ * @brief Validated, indexed, read-only view of one frame's TLV body.
+ */
+class TlvView {
+public:
+  /** One TLV. @p value points at @p len bytes inside the frame. */
+  struct Item {
+    uint8_t        tag;
+    uint8_t        len;
+    const uint8_t* value;
+  };
+
+  /** Forward iterator over a validated body (no checks needed while walking). */
+  class Iter {
+  public:
+    explicit Iter(const uint8_t* p) : p_(p) {}
+    Item  operator*() const            { return Item{p_[0], p_[1], p_ + 2}; }
+    Iter& operator++()                 { p_ += 2 + p_[1]; return *this; }
+    bool  operator!=(const Iter& o) const { return p_ != o.p_; }
+  private:
+    const uint8_t* p_;
+  };
+
+  /** @brief Validate and index the body of inner frame [frame, frame + len). */
+  TlvView(const uint8_t* frame, size_t len);
+
+  bool   ok() const    { return ok_; }
+  size_t count() const { return count_; }                ///< TLVs in the body (0 unless ok())
+
+  /**
+   * @brief First TLV with @p tag.
+   * @return its value and length in @p len, or nullptr when absent (or !ok()).
+   */
+  const uint8_t* find(uint8_t tag, uint8_t& len) const;
+
+  Iter begin() const { return Iter(body_); }
+  Iter end() const   { return Iter(body_ + blen_); }     ///< begin() for a rejected body
+
+private:
+  TlvView(const TlvView&) = delete;
+  TlvView& operator=(const TlvView&) = delete;
+
+  const uint8_t* body_;
+  size_t         blen_;
+  size_t         count_;
+  bool           ok_;
+  uint16_t       at_[kTlvIndexSlots];                    // 1 + offset of the first TLV per tag; 0 = none
+};
@@ -0,0 +1,244 @@
+#pragma once
+/**
+ * @page vt-node-transport ViaText Node Transports (USB, Wi-Fi UDP, BLE)
+ * @file node_transport.hpp
+ * @brief Host links behind node_protocol, chosen at build time.
+ *
+ * Overview
+ * --------
+ * node_protocol serves every compiled-in link at once. Each one delivers
+ * whole inner frames to the same handler and takes whole frames back:
+ *
+ *   LINK_USB  SLIP over the UART (always)
+ *   LINK_UDP  one frame per datagram on VT_UDP_PORT   (-D VT_TRANSPORT_UDP=1)
+ *   LINK_BLE  SLIP over the Nordic UART GATT service  (-D VT_TRANSPORT_BLE=1)
+ *
+ * A reply goes back on the link its request came in on; unsolicited frames
+ * (MSG from the air, MSG_STATUS, hello) go to every link with a host.
+ *
+ * Static Dispatch
+ * ---------------
+ * Links are plain classes with the same member names, not a base class:
+ * node_protocol calls each one by its concrete type, so the per-byte SLIP
+ * loops inline and nothing on the hot path goes through a vtable.
+ * SlipLink<Port, P> binds the decoder to one port object at compile time
+ * (SlipLink<HardwareSerial, Serial>), which also lets the compiler call the
+ * port's own read/write directly instead of through Stream.
+ *
+ *   template <typename Deliver> void update(Deliver deliver);  // frames in
+ *   size_t send(const uint8_t* frame, size_t len);             // wire bytes out
+ *   bool   pending();                                          // input waiting
+ *   explicit operator bool();                                  // host present
+ *   uint32_t take_overflows();                                 // frames > kFrameMax
+ *
+ * Wi-Fi UDP
+ * ---------
+ * Station mode with VT_WIFI_SSID / VT_WIFI_PASS (build flags). The socket
+ * is raw lwIP, non-blocking, receiving straight into the link's frame
+ * buffer: no per-datagram heap. The host is whoever sent the last datagram.
+ * Datagrams wait for the transport task's next pass (at most kXportIdleMs);
+ * there is no wakeup callback as for UART and BLE.
+ *
+ * BLE
+ * ---
+ * Nordic UART Service (RX write, TX notify) advertised as VT_BLE_NAME.
+ * GATT writes land in a byte ring and wake the transport task; replies are
+ * notified in pieces of the MTU the central negotiated (20 bytes until it
+ * asks for more). Meant for a phone at chat rates, not bulk.
+ *
+ * Power
+ * -----
+ * Wi-Fi and BLE keep their radios associated, which light sleep would
+ * break, so either one disables TAG_SLEEP (kTransportWireless).
+ *
+ * @author Leo
+ * @author ChatGPT
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "node_protocol.hpp"    // kFrameMax
+#include "node_ring.hpp"        // SpscRing (BLE RX bytes)
+
+// -----------------------------------------------------------------------------
+// Build selection (platformio.ini build_flags)
+// -----------------------------------------------------------------------------
+#ifndef VT_TRANSPORT_UDP
+#define VT_TRANSPORT_UDP 0
+#endif
+#ifndef VT_TRANSPORT_BLE
+#define VT_TRANSPORT_BLE 0
+#endif
+#ifndef VT_UDP_PORT
+#define VT_UDP_PORT 4210
+#endif
+#ifndef VT_BLE_NAME
+#define VT_BLE_NAME "ViaText"
+#endif
+#if VT_TRANSPORT_UDP && !(defined(VT_WIFI_SSID) && defined(VT_WIFI_PASS))
+#error "VT_TRANSPORT_UDP=1 needs VT_WIFI_SSID and VT_WIFI_PASS"
+#endif
+
+/** True when a link that light sleep would break is compiled in. */
+static constexpr bool kTransportWireless = VT_TRANSPORT_UDP || VT_TRANSPORT_BLE;
+
+/** @enum LinkId @brief Which host link a frame came from. */
+enum LinkId : uint8_t {
+  LINK_USB  = 0,
+  LINK_UDP  = 1,
+  LINK_BLE  = 2,
+  LINK_NONE = 0xFF        ///< not inside a handler: send to every link
+};
+
+/** SLIP (RFC 1055) bytes. */
+static constexpr uint8_t kSlipEnd    = 0xC0;
+static constexpr uint8_t kSlipEsc    = 0xDB;
+static constexpr uint8_t kSlipEscEnd = 0xDC;
+static constexpr uint8_t kSlipEscEsc = 0xDD;
+
+// -----------------------------------------------------------------------------
+// SlipLink: SLIP over any byte port
+// Port needs: int available(), size_t read(uint8_t*, size_t),
+//             size_t write(const uint8_t*, size_t), explicit operator bool.
+// -----------------------------------------------------------------------------
+template <typename Port, Port& P>
+class SlipLink {
+public:
+  // Decode everything the port holds; deliver(frame, len) per complete frame.
+  // An oversized frame is cut at kFrameMax and still delivered (the handler
+  // answers RESP_ERR on the bad length), and counted.
+  template <typename Deliver>
+  void update(Deliver deliver) {
+    uint8_t chunk[64];
+    for (;;) {
+      const int avail = P.available();
+      if (avail <= 0) return;
+      const size_t n = P.read(chunk, static_cast<size_t>(avail) < sizeof(chunk) ? static_cast<size_t>(avail) : sizeof(chunk));
+      if (n == 0) return;
+      for (size_t i = 0; i < n; ++i) feed(chunk[i], deliver);
+    }
+  }
+
+  // One pass from the caller's frame to the port through a small staging
+  // chunk: END, escaped body, END.
+  size_t send(const uint8_t* frame, size_t len) {
+    uint8_t chunk[64];                  // fits an escaped pair at the end
+    size_t  k = 0;
+    size_t  wire = 0;
+    chunk[k++] = kSlipEnd;              // leading END flushes any line noise at the receiver
+    for (size_t n = 0; n < len; ++n) {
+      const uint8_t c = frame[n];
+      if (c == kSlipEnd)      { chunk[k++] = kSlipEsc; chunk[k++] = kSlipEscEnd; }
+      else if (c == kSlipEsc) { chunk[k++] = kSlipEsc; chunk[k++] = kSlipEscEsc; }
+      else                    { chunk[k++] = c; }
+      if (k >= sizeof(chunk) - 2) { P.write(chunk, k); wire += k; k = 0; }
+    }
+    chunk[k++] = kSlipEnd;
+    P.write(chunk, k);
+    return wire + k;
+  }
+
+  bool pending() { return P.available() > 0; }
+  explicit operator bool() { return static_cast<bool>(P); }
+
+  uint32_t take_overflows() {
+    const uint32_t n = overflows_;
+    overflows_ = 0;
+    return n;
+  }
+
+private:
+  template <typename Deliver>
+  void feed(uint8_t c, Deliver& deliver) {
+    if (c == kSlipEnd) {
+      if (over_) ++overflows_;
+      if (n_) deliver(static_cast<const uint8_t*>(buf_), n_);   // back-to-back ENDs carry nothing
+      n_ = 0; esc_ = false; over_ = false;
+      return;
+    }
+    if (esc_) {
+      esc_ = false;
+      if (c == kSlipEscEnd) c = kSlipEnd;
+      else if (c == kSlipEscEsc) c = kSlipEsc;
+    } else if (c == kSlipEsc) {
+      esc_ = true;
+      return;
+    }
+    if (n_ < kFrameMax) buf_[n_++] = c;
+    else over_ = true;
+  }
+
+  uint8_t  buf_[kFrameMax];
+  size_t   n_ = 0;
+  bool     esc_ = false;
+  bool     over_ = false;
+  uint32_t overflows_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// UdpLink: one inner frame per datagram (no SLIP)
+// -----------------------------------------------------------------------------
+class UdpLink {
+public:
+  /** @brief Join Wi-Fi (VT_WIFI_SSID) and bind VT_UDP_PORT; returns at once. */
+  void begin();
+
+  template <typename Deliver>
+  void update(Deliver deliver) {
+    for (size_t k = 0; k < kBurst; ++k) {             // bounded: the UART gets its turn
+      const int n = recv();
+      if (n < 0) return;
+      if (static_cast<size_t>(n) > kFrameMax) { ++overflows_; continue; }
+      if (n > 0) deliver(static_cast<const uint8_t*>(buf_), static_cast<size_t>(n));
+    }
+  }
+
+  size_t send(const uint8_t* frame, size_t len);
+  bool pending() { return false; }                   // only a receive can tell
+  explicit operator bool() const { return have_peer_; }
+
+  uint32_t take_overflows() {
+    const uint32_t n = overflows_;
+    overflows_ = 0;
+    return n;
+  }
+
+private:
+  static constexpr size_t kBurst = 4;                // datagrams per pass
+
+  int recv();                                        // bytes, > kFrameMax if cut, -1 if none
+
+  uint8_t  buf_[kFrameMax + 1];                      // one spare byte detects oversize
+  int      fd_ = -1;
+  bool     have_peer_ = false;
+  uint32_t peer_ip_ = 0;                             // network order
+  uint16_t peer_port_ = 0;                           // network order
+  uint32_t overflows_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// BleUartPort: Nordic UART Service as a byte port for SlipLink
+// -----------------------------------------------------------------------------
+class BleUartPort {
+public:
+  /** @brief Start BLE, the service, and advertising as @p name. */
+  void begin(const char* name);
+
+  /** @brief Wake hook for GATT writes (BLE host task context). */
+  void on_rx(void (*notify)()) { notify_ = notify; }
+
+  int available() const { return static_cast<int>(rx_.size()); }
+  size_t read(uint8_t* out, size_t n);
+  size_t write(const uint8_t* p, size_t n);
+  explicit operator bool() const { return connected_; }
+
+  // GATT callbacks (BLE task).
+  void on_write(const uint8_t* p, size_t n);
+  void on_connect(bool up) { connected_ = up; }
+
+private:
+  SpscRing<uint8_t, 1024> rx_;                       // BLE task -> transport task
+  void (*notify_)() = nullptr;
+  volatile bool connected_ = false;
+  bool drop_ = false;                                // BLE task only: discarding to the next END
+};
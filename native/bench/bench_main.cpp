@@ -0,0 +1,158 @@
+// -----------------------------------------------------------------------------
+// bench_main.cpp
+// Host microbenchmarks for the inbound frame path, in ns per frame.
+//
+//   pio run -e native_bench && .pio/build/native_bench/program [min_ms]
+//
+// Notes:
+//  * "handler" rows time node_interface_on_packet() alone: TLV parsing,
+//    the verb's work, and building + SLIP-encoding the reply. "wire" rows
+//    add SLIP decoding by feeding bytes through node_protocol_update().
+//  * Replies are discarded by the shim so the numbers carry no host I/O.
+//  * Each case runs for at least min_ms (default 200) after a warm-up;
+//    compare runs on the same machine only. No radio is fitted natively,
+//    so MSG measures its no-radio path.
+//  * Handler rows step seq on every frame, so state-changing verbs run
+//    each time instead of being answered by node_replay.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "native_host.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Case {
+  const char* name;
+  bool        wire;                       // through SLIP + node_protocol_update()
+  uint8_t     frame[kFrameMax];
+  size_t      len;
+};
+
+uint32_t g_min_ms = 200;
+
+// Build [verb][flags][seq][len(16)][body] into c.
+void make(Case& c, const char* name, uint8_t verb, bool len16, const uint8_t* body, size_t blen, bool wire = false) {
+  c.name = name;
+  c.wire = wire;
+  size_t i = 0;
+  c.frame[i++] = verb;
+  c.frame[i++] = len16 ? FLAG_LEN16 : 0;
+  c.frame[i++] = 1;
+  c.frame[i++] = static_cast<uint8_t>(blen);
+  if (len16) c.frame[i++] = static_cast<uint8_t>(blen >> 8);
+  if (blen) memcpy(c.frame + i, body, blen);
+  c.len = i + blen;
+}
+
+// SLIP bytes for c (END, escaped body, END), as a host would send them.
+size_t slip(const Case& c, uint8_t* out) {
+  size_t k = 0;
+  out[k++] = 0xC0;
+  for (size_t n = 0; n < c.len; ++n) {
+    const uint8_t b = c.frame[n];
+    if (b == 0xC0)      { out[k++] = 0xDB; out[k++] = 0xDC; }
+    else if (b == 0xDB) { out[k++] = 0xDB; out[k++] = 0xDD; }
+    else                { out[k++] = b; }
+  }
+  out[k++] = 0xC0;
+  return k;
+}
+
+void once(Case& c, const uint8_t* wire, size_t wlen) {
+  if (c.wire) {
+    native_serial_feed(wire, wlen);
+    node_protocol_update();
+  } else {
+    c.frame[2] = static_cast<uint8_t>(c.frame[2] % 255 + 1);      // a new request, never a retry
+    node_interface_on_packet(c.frame, c.len);
+  }
+}
+
+void run(Case& c) {
+  static uint8_t wire[2 * kFrameMax + 2];
+  const size_t wlen = c.wire ? slip(c, wire) : 0;
+  for (int k = 0; k < 1000; ++k) once(c, wire, wlen);          // warm caches and branch predictors
+
+  typedef std::chrono::steady_clock Clock;
+  uint64_t iters = 0;
+  const Clock::time_point t0 = Clock::now();
+  Clock::duration dt;
+  do {
+    for (int k = 0; k < 1000; ++k) once(c, wire, wlen);
+    iters += 1000;
+    dt = Clock::now() - t0;
+  } while (dt < std::chrono::milliseconds(g_min_ms));
+
+  const double ns = std::chrono::duration<double, std::nano>(dt).count() / static_cast<double>(iters);
+  printf("%-8s %-28s %5u B %10.1f ns/frame\n", c.wire ? "wire" : "handler", c.name,
+         static_cast<unsigned>(c.len), ns);
+}
+
+// GET_ALL once, captured: its body is every readable row with a valid value.
+size_t snapshot_all(uint8_t* body, size_t cap) {
+  static uint8_t reply[kFrameMax + 1];
+  const uint8_t get_all[] = {Verb::GET_ALL, 0, 1, 0};
+  native_serial_capture(true);
+  native_serial_clear();
+  node_interface_on_packet(get_all, sizeof(get_all));
+  const size_t n = native_serial_take_frame(reply, sizeof(reply));
+  native_serial_capture(false);
+  if (n < kFrameHdr || n > sizeof(reply)) return 0;
+  const size_t blen = frame_body_len(reply);
+  if (blen > cap) return 0;
+  memcpy(body, reply + frame_hdr_len(reply), blen);
+  return blen;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 1) g_min_ms = static_cast<uint32_t>(atoi(argv[1]));
+
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+  native_serial_capture(false);
+
+  static Case cases[16];
+  size_t n = 0;
+  uint8_t body[kFrameMax];
+
+  make(cases[n++], "PING", Verb::PING, false, nullptr, 0);
+  make(cases[n++], "GET_ID", Verb::GET_ID, false, nullptr, 0);
+  { const uint8_t b[] = {TAG_ID, 6, 'b', 'e', 'n', 'c', 'h', '1'};
+    make(cases[n++], "SET_ID", Verb::SET_ID, false, b, sizeof(b)); }
+  { const uint8_t b[] = {TAG_SF, 0};
+    make(cases[n++], "GET_PARAM (1 tag)", Verb::GET_PARAM, false, b, sizeof(b)); }
+  { size_t k = 0;                                               // every tag id, known or not
+    for (uint8_t t = 0x01; t < 0x50; ++t) { body[k++] = t; body[k++] = 0; }
+    make(cases[n++], "GET_PARAM (79 tags)", Verb::GET_PARAM, true, body, k); }
+  { const uint8_t b[] = {TAG_SF, 1, 9};
+    make(cases[n++], "SET_PARAM (1 tag)", Verb::SET_PARAM, false, b, sizeof(b)); }
+  { const size_t k = snapshot_all(body, 255);                   // current values: always valid
+    make(cases[n++], "SET_PARAM (GET_ALL body)", Verb::SET_PARAM, false, body, k); }
+  make(cases[n++], "GET_ALL", Verb::GET_ALL, true, nullptr, 0);
+  make(cases[n++], "GET_LOG", Verb::GET_LOG, true, nullptr, 0);
+  make(cases[n++], "GET_STATS", Verb::GET_STATS, true, nullptr, 0);
+  { const char* s = "hello from the bench";
+    make(cases[n++], "MSG (no radio)", Verb::MSG, false, reinterpret_cast<const uint8_t*>(s), strlen(s)); }
+  { size_t k = 0;
+    for (uint8_t j = 0; j < 4; ++j) { body[k++] = Verb::PING; body[k++] = 0; body[k++] = j; body[k++] = 0; }
+    make(cases[n++], "BATCH (4 x PING)", Verb::BATCH, false, body, k); }
+  { body[0] = TAG_BENCH_DATA; body[1] = 64;
+    for (uint8_t j = 0; j < 64; ++j) body[2 + j] = static_cast<uint8_t>(j * 4);   // includes C0 / DB
+    make(cases[n++], "BENCH (64 B echo)", Verb::BENCH, false, body, 66); }
+  make(cases[n++], "PING", Verb::PING, false, nullptr, 0, true);
+  make(cases[n++], "GET_ALL", Verb::GET_ALL, true, nullptr, 0, true);
+
+  printf("%-8s %-28s %7s %19s\n", "path", "case", "frame", "time");
+  for (size_t k = 0; k < n; ++k) run(cases[k]);
+  return 0;
+}
@@ -0,0 +1,8 @@
+# PlatformIO extra script for env:native_fuzz: libFuzzer needs clang, and the
+# sanitizers must be on the link line as well as the compile line.
+Import("env")
+
+SANITIZERS = "-fsanitize=fuzzer,address,undefined"
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")
+env.Append(CCFLAGS=[SANITIZERS, "-g", "-O1"], LINKFLAGS=[SANITIZERS])
@@ -0,0 +1,85 @@
+// -----------------------------------------------------------------------------
+// fuzz_frame.cpp
+// libFuzzer harness for the inbound frame path.
+//
+//   pio run -e native_fuzz
+//   .pio/build/native_fuzz/program -max_len=1100 native/fuzz/corpus
+//
+// Notes:
+//  * Each input goes in twice: once as an inner frame straight into
+//    node_interface_on_packet() (the parser and every verb), once as host
+//    bytes through SLIP and node_protocol_update() (framing, overflow).
+//  * Built with ASan/UBSan, so any read past the frame aborts. On top of
+//    that every reply must be a well-formed frame: header present, declared
+//    body exactly the bytes sent, BATCH sub-responses likewise.
+//  * State carries over between inputs (config, log, queues) as it would
+//    on a node talking to a hostile host; the clock moves 10 ms per input so
+//    timers and the SET_BAUD window get exercised too.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "native_host.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+uint8_t g_out[kFrameMax + 1];
+
+void fail(const char* why, size_t n) {
+  fprintf(stderr, "bad reply (%s): %zu bytes, verb 0x%02X\n", why, n, n ? g_out[0] : 0);
+  abort();
+}
+
+// [off, off + n) holds exactly one frame.
+bool well_formed(const uint8_t* f, size_t n) {
+  return n >= kFrameHdr && n >= frame_hdr_len(f) && frame_hdr_len(f) + frame_body_len(f) == n;
+}
+
+void check_replies() {
+  size_t n;
+  while ((n = native_serial_take_frame(g_out, sizeof(g_out))) != 0) {
+    if (n > kFrameMax) fail("over kFrameMax", n);
+    if (!well_formed(g_out, n)) fail("length", n);
+    if (g_out[0] != Verb::BATCH) continue;
+    for (size_t off = frame_hdr_len(g_out); off < n; ) {      // sub-responses back to back
+      const uint8_t* s = g_out + off;
+      if (n - off < kFrameHdr || n - off < frame_hdr_len(s)) fail("batch sub-header", n);
+      const size_t sub = frame_hdr_len(s) + frame_body_len(s);
+      if (sub > n - off) fail("batch sub-length", n);
+      off += sub;
+    }
+  }
+}
+
+bool boot() {
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+  node_interface_send_hello();
+  check_replies();
+  return true;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  static const bool up = boot();
+  (void)up;
+
+  node_interface_on_packet(data, size < kFrameMax ? size : kFrameMax);
+  check_replies();
+
+  static const uint8_t kEnd = 0xC0;
+  native_serial_feed(data, size);
+  native_serial_feed(&kEnd, 1);                               // close whatever the input left open
+  node_protocol_update();
+  node_interface_update();
+  check_replies();
+
+  native_advance_ms(10);
+  return 0;
+}
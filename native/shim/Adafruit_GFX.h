@@ -0,0 +1,11 @@
+#pragma once
+// Adafruit_GFX.h (native): text calls accepted and dropped.
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t, int16_t) {}
+  void setTextColor(uint16_t) {}
+  void setTextSize(uint8_t) {}
+  void setCursor(int16_t, int16_t) {}
+};
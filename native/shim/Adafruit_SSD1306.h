@@ -0,0 +1,22 @@
+#pragma once
+// Adafruit_SSD1306.h (native): a panel that never answers, so node_display
+// runs headless exactly as on a board without the OLED.
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_SWITCHCAPVCC 2
+#define SSD1306_WHITE        1
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire*, int8_t, uint32_t, uint32_t)
+      : Adafruit_GFX(w, h) {}
+  bool begin(uint8_t, uint8_t) { return false; }
+  void display() {}
+  void clearDisplay() { memset(buf_, 0, sizeof(buf_)); }
+  uint8_t* getBuffer() { return buf_; }
+  void ssd1306_command(uint8_t) {}
+
+private:
+  uint8_t buf_[128 * 64 / 8] = {};
+};
@@ -0,0 +1,100 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// Arduino.h (native)
+// Just enough of the ESP32 Arduino core for the firmware to build and run on
+// the host, single-threaded. Serial is a pair of byte buffers the tests and
+// benchmarks fill and drain (native_host.h); time is the host clock.
+// -----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#define IRAM_ATTR
+#define RISING  1
+#define FALLING 2
+#define CHANGE  3
+#define INPUT   0
+#define OUTPUT  1
+#define HIGH    1
+#define LOW     0
+#define ADC_11db 3
+#define digitalPinToInterrupt(p) (p)
+#define F(s) (s)
+
+typedef uint8_t byte;
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) { return write(&c, 1); }
+  virtual size_t write(const uint8_t*, size_t n) { return n; }
+  size_t write(const char* s) { return write(reinterpret_cast<const uint8_t*>(s), strlen(s)); }
+  size_t print(const char* s) { return write(s); }
+  size_t println(const char* s) { return write(s) + write("\r\n"); }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { baud_ = baud; }
+  void updateBaudRate(unsigned long baud) { baud_ = baud; }
+  unsigned long baudRate() const { return baud_; }
+  size_t setRxBufferSize(size_t n) { return n; }
+  void onReceive(std::function<void(void)> cb) { on_rx_ = cb; }
+
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* out, size_t n);
+  using Print::write;
+  size_t write(const uint8_t* p, size_t n) override;
+  explicit operator bool() const { return true; }
+
+private:
+  unsigned long baud_ = 0;
+  std::function<void(void)> on_rx_;
+  friend void native_serial_feed(const uint8_t*, size_t);
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int  digitalRead(uint8_t);
+void attachInterrupt(uint8_t, void (*)(void), int);
+void analogSetPinAttenuation(uint8_t, int);
+uint32_t analogReadMilliVolts(uint8_t);
+float temperatureRead();
+
+long random(long hi);
+long random(long lo, long hi);
+uint32_t esp_random();
+
+class EspClass {
+public:
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getFreeHeap() { return 200000; }
+  uint32_t getMinFreeHeap() { return 180000; }
+};
+
+extern EspClass ESP;
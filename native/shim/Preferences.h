@@ -0,0 +1,28 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// Preferences.h (native)
+// NVS as an in-memory map shared by every instance, keyed "namespace/key";
+// survives node re-init within one process, cleared by native_prefs_clear().
+// -----------------------------------------------------------------------------
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char* ns, bool read_only = false);
+  void end() {}
+  size_t freeEntries();
+
+  int8_t   getChar(const char* key, int8_t dflt = 0);
+  uint8_t  getUChar(const char* key, uint8_t dflt = 0);
+  uint16_t getUShort(const char* key, uint16_t dflt = 0);
+  uint32_t getULong(const char* key, uint32_t dflt = 0);
+  size_t   getString(const char* key, char* out, size_t cap);
+  size_t   getBytesLength(const char* key);
+  size_t   getBytes(const char* key, void* out, size_t cap);
+
+  size_t putBytes(const char* key, const void* p, size_t n);
+
+private:
+  char ns_[16] = {};
+  bool ro_ = false;
+};
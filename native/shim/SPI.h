@@ -0,0 +1,20 @@
+#pragma once
+// SPI.h (native): reads return 0, so node_radio finds no SX127x.
+#include <Arduino.h>
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+struct SPISettings {
+  SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+public:
+  void begin(int8_t, int8_t, int8_t, int8_t) {}
+  void beginTransaction(const SPISettings&) {}
+  void endTransaction() {}
+  uint8_t transfer(uint8_t) { return 0; }
+};
+
+extern SPIClass SPI;
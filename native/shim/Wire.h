@@ -0,0 +1,14 @@
+#pragma once
+// Wire.h (native): an I2C bus with nothing on it.
+#include <Arduino.h>
+
+class TwoWire : public Stream {
+public:
+  bool begin(int, int, uint32_t) { return true; }
+  void beginTransmission(uint8_t) {}
+  uint8_t endTransmission() { return 2; }       // NACK on address: no device
+  using Print::write;
+  size_t write(const uint8_t*, size_t n) override { return n; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,195 @@
+// -----------------------------------------------------------------------------
+// arduino_shim.cpp
+// Host definitions behind native/shim/Arduino.h and the esp_* headers.
+//
+// Notes:
+//  * Serial RX is fed by native_serial_feed(); TX lands in a buffer the
+//    caller drains with native_serial_take() (or drops, for benchmarks).
+//  * Time is the host's monotonic clock from first use, plus whatever
+//    native_advance_ms() has added, so timeouts can be stepped in tests.
+//  * Peripherals answer as absent, never as broken.
+//  * native_request() and friends are the host side of a request/reply
+//    exchange, shared by the test suites.
+//
+// -----------------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <LoRa.h>
+#include <Wire.h>
+#include "native_host.h"
+#include "node_protocol.hpp"    // frame header helpers, kFrameMax
+#include "node_interface.hpp"   // node_interface_on_packet()
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+HardwareSerial Serial;
+SPIClass       SPI;
+LoRaClass      LoRa;
+TwoWire        Wire;
+EspClass       ESP;
+
+namespace {
+
+std::deque<uint8_t>  g_rx;
+std::vector<uint8_t> g_tx;
+bool                 g_capture = true;
+uint8_t              g_reply[kFrameMax + 1];
+size_t               g_reply_len = 0;
+uint8_t              g_req_seq   = 1;
+int64_t              g_skew_us = 0;
+uint32_t             g_rand    = 0x2545F491u;
+bool                 g_lora    = false;   // native_radio_fit()
+
+int64_t now_us() {
+  static const auto t0 = std::chrono::steady_clock::now();
+  const auto dt = std::chrono::steady_clock::now() - t0;
+  return std::chrono::duration_cast<std::chrono::microseconds>(dt).count() + g_skew_us;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Serial
+// -----------------------------------------------------------------------------
+int HardwareSerial::available() { return static_cast<int>(g_rx.size()); }
+
+int HardwareSerial::read() {
+  if (g_rx.empty()) return -1;
+  const uint8_t c = g_rx.front();
+  g_rx.pop_front();
+  return c;
+}
+
+size_t HardwareSerial::read(uint8_t* out, size_t n) {
+  size_t k = 0;
+  for (; k < n && !g_rx.empty(); ++k) { out[k] = g_rx.front(); g_rx.pop_front(); }
+  return k;
+}
+
+size_t HardwareSerial::write(const uint8_t* p, size_t n) {
+  if (g_capture) g_tx.insert(g_tx.end(), p, p + n);
+  return n;
+}
+
+void native_serial_feed(const uint8_t* p, size_t n) {
+  g_rx.insert(g_rx.end(), p, p + n);
+  if (n && Serial.on_rx_) Serial.on_rx_();
+}
+
+size_t native_serial_pending() { return g_tx.size(); }
+
+size_t native_serial_take(uint8_t* out, size_t cap) {
+  const size_t n = g_tx.size() < cap ? g_tx.size() : cap;
+  if (n) memcpy(out, g_tx.data(), n);
+  g_tx.erase(g_tx.begin(), g_tx.begin() + static_cast<std::ptrdiff_t>(n));
+  return n;
+}
+
+size_t native_serial_take_frame(uint8_t* out, size_t cap) {
+  for (;;) {
+    size_t end = 0;
+    while (end < g_tx.size() && g_tx[end] != 0xC0) ++end;
+    if (end == g_tx.size()) return 0;                      // no closing END yet
+    size_t n = 0;
+    bool   esc = false;
+    for (size_t k = 0; k < end; ++k) {
+      uint8_t c = g_tx[k];
+      if (esc) { c = (c == 0xDC) ? 0xC0 : (c == 0xDD) ? 0xDB : c; esc = false; }
+      else if (c == 0xDB) { esc = true; continue; }
+      if (n < cap) out[n] = c;
+      ++n;
+    }
+    g_tx.erase(g_tx.begin(), g_tx.begin() + static_cast<std::ptrdiff_t>(end + 1));
+    if (n) return n <= cap ? n : cap + 1;                  // skip the leading END's empty frame
+  }
+}
+
+void native_serial_clear() { g_rx.clear(); g_tx.clear(); }
+
+size_t native_exchange(const uint8_t* frame, size_t n) {
+  native_serial_clear();
+  node_interface_on_packet(frame, n);
+  return native_take_reply();
+}
+
+size_t native_take_reply() {
+  g_reply_len = native_serial_take_frame(g_reply, sizeof(g_reply));
+  return g_reply_len;
+}
+
+size_t native_request(uint8_t verb, const uint8_t* body, size_t blen) {
+  uint8_t f[kFrameHdr + 255];
+  if (blen > 255) blen = 255;
+  f[0] = verb; f[1] = 0; f[2] = g_req_seq; f[3] = static_cast<uint8_t>(blen);
+  g_req_seq = static_cast<uint8_t>(g_req_seq % 255 + 1);
+  if (blen) memcpy(f + kFrameHdr, body, blen);
+  return native_exchange(f, kFrameHdr + blen);
+}
+
+const uint8_t* native_reply() { return g_reply; }
+size_t native_reply_len()     { return g_reply_len; }
+
+const uint8_t* native_reply_tlv(uint8_t tag, uint8_t* vlen) {
+  if (g_reply_len < kFrameHdr || g_reply_len > kFrameMax) return nullptr;
+  const size_t hdr = frame_hdr_len(g_reply);
+  if (hdr > g_reply_len) return nullptr;
+  const size_t end = hdr + frame_body_len(g_reply);
+  if (end > g_reply_len) return nullptr;
+  for (size_t off = hdr; off + 2 <= end; off += 2 + g_reply[off + 1]) {
+    if (off + 2 + g_reply[off + 1] > end) return nullptr;
+    if (g_reply[off] != tag) continue;
+    if (vlen) *vlen = g_reply[off + 1];
+    return g_reply + off + 2;
+  }
+  return nullptr;
+}
+void native_serial_capture(bool on) { g_capture = on; }
+
+// -----------------------------------------------------------------------------
+// Radio
+// -----------------------------------------------------------------------------
+int LoRaClass::begin(long) { return g_lora ? 1 : 0; }
+void native_radio_fit(bool on) { g_lora = on; }
+
+// -----------------------------------------------------------------------------
+// Time
+// -----------------------------------------------------------------------------
+void native_advance_ms(uint32_t ms) { g_skew_us += static_cast<int64_t>(ms) * 1000; }
+
+unsigned long millis() { return static_cast<unsigned long>(now_us() / 1000); }
+unsigned long micros() { return static_cast<unsigned long>(now_us()); }
+void delay(uint32_t ms) { native_advance_ms(ms); }
+int64_t esp_timer_get_time() { return now_us(); }
+uint32_t EspClass::getCycleCount() { return static_cast<uint32_t>(now_us() * 240); }
+
+// -----------------------------------------------------------------------------
+// Pins, ADC, randomness
+// -----------------------------------------------------------------------------
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int  digitalRead(uint8_t) { return LOW; }
+void attachInterrupt(uint8_t, void (*)(void), int) {}
+void analogSetPinAttenuation(uint8_t, int) {}
+uint32_t analogReadMilliVolts(uint8_t) { return 2050; }   // 4.1 V behind the /2 divider
+float temperatureRead() { return 45.0f; }
+
+uint32_t esp_random() {                                     // xorshift32: reproducible runs
+  g_rand ^= g_rand << 13;
+  g_rand ^= g_rand >> 17;
+  g_rand ^= g_rand << 5;
+  return g_rand;
+}
+
+long random(long hi) { return hi > 0 ? static_cast<long>(esp_random() % static_cast<uint32_t>(hi)) : 0; }
+long random(long lo, long hi) { return hi > lo ? lo + random(hi - lo) : lo; }
+
+// -----------------------------------------------------------------------------
+// System
+// -----------------------------------------------------------------------------
+int esp_register_shutdown_handler(shutdown_handler_t) { return 0; }
+esp_reset_reason_t esp_reset_reason() { return ESP_RST_POWERON; }
+void esp_restart() {}
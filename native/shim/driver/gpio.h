@@ -0,0 +1,10 @@
+#pragma once
+// driver/gpio.h (native)
+typedef int gpio_num_t;
+typedef enum { GPIO_INTR_DISABLE = 0, GPIO_INTR_POSEDGE = 1, GPIO_INTR_HIGH_LEVEL = 5 } gpio_int_type_t;
+
+inline int gpio_intr_disable(gpio_num_t) { return 0; }
+inline int gpio_intr_enable(gpio_num_t) { return 0; }
+inline int gpio_set_intr_type(gpio_num_t, gpio_int_type_t) { return 0; }
+inline int gpio_wakeup_enable(gpio_num_t, gpio_int_type_t) { return 0; }
+inline int gpio_wakeup_disable(gpio_num_t) { return 0; }
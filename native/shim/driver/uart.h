@@ -0,0 +1,7 @@
+#pragma once
+// driver/uart.h (native)
+typedef int uart_port_t;
+enum { UART_NUM_0 = 0 };
+
+inline int uart_wait_tx_idle_polling(uart_port_t) { return 0; }
+inline int uart_set_wakeup_threshold(uart_port_t, int) { return 0; }
@@ -0,0 +1,19 @@
+#pragma once
+// esp_sleep.h (native): light sleep returns at once with a timer wake.
+#include <cstdint>
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_ALL       = 1,
+  ESP_SLEEP_WAKEUP_TIMER     = 4,
+  ESP_SLEEP_WAKEUP_GPIO      = 7,
+  ESP_SLEEP_WAKEUP_UART      = 8
+} esp_sleep_wakeup_cause_t;
+typedef esp_sleep_wakeup_cause_t esp_sleep_source_t;
+
+inline int esp_sleep_enable_uart_wakeup(int) { return 0; }
+inline int esp_sleep_enable_gpio_wakeup() { return 0; }
+inline int esp_sleep_enable_timer_wakeup(uint64_t) { return 0; }
+inline int esp_light_sleep_start() { return 0; }
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return ESP_SLEEP_WAKEUP_TIMER; }
+inline int esp_sleep_disable_wakeup_source(esp_sleep_source_t) { return 0; }
@@ -0,0 +1,10 @@
+#pragma once
+// esp_system.h (native): restarts are counted, not performed.
+#include <cstdint>
+
+typedef void (*shutdown_handler_t)(void);
+typedef enum { ESP_RST_UNKNOWN = 0, ESP_RST_POWERON = 1 } esp_reset_reason_t;
+
+int esp_register_shutdown_handler(shutdown_handler_t handler);
+esp_reset_reason_t esp_reset_reason();
+void esp_restart();
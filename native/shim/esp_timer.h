@@ -0,0 +1,5 @@
+#pragma once
+// esp_timer.h (native): microseconds on the same clock as millis().
+#include <cstdint>
+
+int64_t esp_timer_get_time();
@@ -0,0 +1,32 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// freertos/FreeRTOS.h (native)
+// One thread, no scheduler: critical sections are no-ops, tasks are never
+// started, and a wait that could only end by another task running aborts.
+// -----------------------------------------------------------------------------
+#include <cstdint>
+
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+#define portMAX_DELAY      0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  (static_cast<TickType_t>(ms))
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m)     ((void)(m))
+#define portEXIT_CRITICAL(m)      ((void)(m))
+#define portENTER_CRITICAL_ISR(m) ((void)(m))
+#define portEXIT_CRITICAL_ISR(m)  ((void)(m))
+#define portYIELD_FROM_ISR(...)   ((void)0)
+
+// Room for the host-side object; the firmware only passes pointers to these.
+typedef struct { uint32_t words[8]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
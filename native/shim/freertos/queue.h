@@ -0,0 +1,10 @@
+#pragma once
+// freertos/queue.h (native): FIFO of fixed-size items on the heap.
+#include "FreeRTOS.h"
+
+typedef struct NativeQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t item);
+BaseType_t    xQueueSend(QueueHandle_t q, const void* item, TickType_t wait);
+BaseType_t    xQueueReceive(QueueHandle_t q, void* out, TickType_t wait);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t q);
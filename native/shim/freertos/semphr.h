@@ -0,0 +1,10 @@
+#pragma once
+// freertos/semphr.h (native): counting semaphores count; mutexes always succeed.
+#include "queue.h"
+
+typedef struct NativeSem* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buf);
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t initial, StaticSemaphore_t* buf);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t s);
@@ -0,0 +1,14 @@
+#pragma once
+// freertos/task.h (native): every caller runs on the one "current" task.
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                     UBaseType_t prio, TaskHandle_t* out, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void         vTaskDelete(TaskHandle_t);
+uint32_t     ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+BaseType_t   xTaskNotifyGive(TaskHandle_t);
+void         vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*);
@@ -0,0 +1,111 @@
+// -----------------------------------------------------------------------------
+// freertos_shim.cpp
+// Host definitions behind native/shim/freertos/*.h.
+//
+// Notes:
+//  * Nothing is scheduled: xTaskCreatePinnedToCore() records nothing and
+//    never runs the task, so node_tasks_post() keeps its boot-time inline
+//    path and tests drive node_protocol_update()/node_interface_update().
+//  * Blocking on an empty counting semaphore would wait forever here (no
+//    other task can give it back); that is a bug in the caller, so abort.
+//
+// -----------------------------------------------------------------------------
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+struct NativeQueue {
+  UBaseType_t                       depth;
+  UBaseType_t                       item;
+  std::deque<std::vector<uint8_t>>  items;
+};
+
+struct NativeSem {
+  bool        counting;
+  UBaseType_t max;
+  UBaseType_t count;
+};
+
+namespace {
+
+int g_current_task;                       // address is the one task handle
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Tasks
+// -----------------------------------------------------------------------------
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*,
+                                   UBaseType_t, TaskHandle_t* out, BaseType_t) {
+  if (out) *out = nullptr;
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return &g_current_task; }
+void vTaskDelete(TaskHandle_t) {}
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) {}
+
+// -----------------------------------------------------------------------------
+// Queues
+// -----------------------------------------------------------------------------
+QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t item) {
+  return new NativeQueue{depth, item, {}};
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t) {
+  if (!q || q->items.size() >= q->depth) return pdFAIL;
+  const uint8_t* p = static_cast<const uint8_t*>(item);
+  q->items.emplace_back(p, p + q->item);
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* out, TickType_t) {
+  if (!q || q->items.empty()) return pdFAIL;
+  memcpy(out, q->items.front().data(), q->item);
+  q->items.pop_front();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  return q ? static_cast<UBaseType_t>(q->items.size()) : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Semaphores (the Static buffers only need to outlive the handle; the state
+// lives on the heap so its layout never depends on StaticSemaphore_t)
+// -----------------------------------------------------------------------------
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t*) {
+  return new NativeSem{false, 1, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t initial, StaticSemaphore_t*) {
+  return new NativeSem{true, max, initial};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+  if (!s->counting) return pdTRUE;        // one thread: a mutex is always free
+  if (s->count == 0) {
+    if (wait == 0) return pdFALSE;
+    fprintf(stderr, "native: blocking take on an empty semaphore would never return\n");
+    abort();
+  }
+  --s->count;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  if (!s->counting) return pdTRUE;
+  if (s->count >= s->max) return pdFALSE;
+  ++s->count;
+  return pdTRUE;
+}
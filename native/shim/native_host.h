@@ -0,0 +1,74 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// native_host.h
+// Hooks the host build gives tests, benchmarks and the fuzzer: drive the
+// serial link, inspect what the node wrote, and step the clock.
+// -----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+/** @brief Queue @p n bytes as if the host had written them to the UART. */
+void native_serial_feed(const uint8_t* p, size_t n);
+
+/** @brief Bytes the node wrote since the last take (SLIP as on the wire). */
+size_t native_serial_pending();
+
+/** @brief Move up to @p cap written bytes into @p out; returns the count. */
+size_t native_serial_take(uint8_t* out, size_t cap);
+
+/**
+ * @brief SLIP-decode the next frame the node wrote into @p out.
+ * @return its length, 0 if no complete frame is waiting, or cap + 1 if it
+ *         did not fit (the frame is consumed either way).
+ */
+size_t native_serial_take_frame(uint8_t* out, size_t cap);
+
+/**
+ * @brief Hand one inner frame straight to node_interface_on_packet() and
+ *        keep the first reply (see native_reply()).
+ * @return the reply's length as native_serial_take_frame() reports it.
+ */
+size_t native_exchange(const uint8_t* frame, size_t n);
+
+/**
+ * @brief native_exchange() of [verb][0][seq][len][body], short form. Every
+ *        call takes a fresh seq (1..255), so node_replay never answers.
+ */
+size_t native_request(uint8_t verb, const uint8_t* body, size_t blen);
+
+/** @brief Keep the next frame the node wrote (e.g. an unsolicited report) as the reply; returns its length. */
+size_t native_take_reply();
+
+/** @brief The reply kept by the last native_exchange()/native_request()/native_take_reply(). */
+const uint8_t* native_reply();
+
+/** @brief Its length (0 = no reply). */
+size_t native_reply_len();
+
+/**
+ * @brief Value of the first @p tag in the kept reply's declared body; its
+ *        length goes to @p vlen when given.
+ * @return nullptr if absent, or if the reply is malformed (body declared
+ *         past what arrived, a TLV running past the body).
+ */
+const uint8_t* native_reply_tlv(uint8_t tag, uint8_t* vlen = nullptr);
+
+/** @brief Drop RX and TX bytes. */
+void native_serial_clear();
+
+/** @brief Keep (default) or discard what the node writes; benchmarks discard. */
+void native_serial_capture(bool on);
+
+/**
+ * @brief Let LoRa.begin() succeed from now on (call before
+ *        node_interface_begin()). No radio task runs natively, so queued
+ *        packets stay in the TX ring and MSG backpressure can be tested.
+ */
+void native_radio_fit(bool on);
+
+/** @brief Move millis()/micros()/esp_timer forward by @p ms. */
+void native_advance_ms(uint32_t ms);
+
+/** @brief Forget everything stored through Preferences (a fresh NVS). */
+void native_prefs_clear();
@@ -0,0 +1,78 @@
+// -----------------------------------------------------------------------------
+// preferences_shim.cpp
+// Host definitions behind native/shim/Preferences.h: one process-wide map.
+// Integers are stored little-endian at their own width, as NVS does.
+// -----------------------------------------------------------------------------
+
+#include <Preferences.h>
+#include "native_host.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::map<std::string, std::vector<uint8_t>>& store() {
+  static std::map<std::string, std::vector<uint8_t>> m;
+  return m;
+}
+
+const std::vector<uint8_t>* find(const char* ns, const char* key) {
+  auto it = store().find(std::string(ns) + "/" + key);
+  return it == store().end() ? nullptr : &it->second;
+}
+
+template <typename T>
+T get_int(const char* ns, const char* key, T dflt) {
+  const std::vector<uint8_t>* v = find(ns, key);
+  if (!v || v->size() != sizeof(T)) return dflt;
+  T out = 0;
+  for (size_t j = 0; j < sizeof(T); ++j) out = static_cast<T>(out | (static_cast<T>((*v)[j]) << (8 * j)));
+  return out;
+}
+
+}  // namespace
+
+void native_prefs_clear() { store().clear(); }
+
+bool Preferences::begin(const char* ns, bool read_only) {
+  strncpy(ns_, ns, sizeof(ns_) - 1);
+  ro_ = read_only;
+  return true;
+}
+
+size_t Preferences::freeEntries() { return 630 - store().size(); }   // 5 pages of 126 entries
+
+int8_t   Preferences::getChar(const char* key, int8_t dflt)     { return get_int<int8_t>(ns_, key, dflt); }
+uint8_t  Preferences::getUChar(const char* key, uint8_t dflt)   { return get_int<uint8_t>(ns_, key, dflt); }
+uint16_t Preferences::getUShort(const char* key, uint16_t dflt) { return get_int<uint16_t>(ns_, key, dflt); }
+uint32_t Preferences::getULong(const char* key, uint32_t dflt)  { return get_int<uint32_t>(ns_, key, dflt); }
+
+size_t Preferences::getString(const char* key, char* out, size_t cap) {
+  const std::vector<uint8_t>* v = find(ns_, key);
+  if (!v || cap == 0) return 0;
+  const size_t n = v->size() < cap - 1 ? v->size() : cap - 1;
+  memcpy(out, v->data(), n);
+  out[n] = '\0';
+  return n + 1;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  const std::vector<uint8_t>* v = find(ns_, key);
+  return v ? v->size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* out, size_t cap) {
+  const std::vector<uint8_t>* v = find(ns_, key);
+  if (!v || v->size() > cap) return 0;
+  memcpy(out, v->data(), v->size());
+  return v->size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* p, size_t n) {
+  if (ro_) return 0;
+  const uint8_t* b = static_cast<const uint8_t*>(p);
+  store()[std::string(ns_) + "/" + key].assign(b, b + n);
+  return n;
+}
@@ -6,8 +6,8 @@
  * Purpose
  * -------
  * This file is intentionally boring. It wires up transport, command/state,
- * and an optional OLED status panel, then hands control to a cooperative
- * update loop. All heavy lifting lives in modules that can be tested or
+ * and an optional OLED status panel, then hands control to two FreeRTOS
+ * tasks (node_tasks.*). All heavy lifting lives in modules that can be tested or
  * swapped without touching main(). Keep this file clean so field debugging
  * is obvious and rebuilds are low-risk.
  *
@@ -21,7 +21,8 @@
  *    boot banner and current Node ID (node_display.*).
  * 4) Emits an unsolicited hello (seq=0) so the host immediately knows the
  *    node is online.
- * 5) Enters a cooperative loop that services the SLIP state machine.
+ * 5) Starts the runtime: a high-priority transport task pinned to core 1
+ *    (SLIP pump + handlers) and a worker task on core 0 (display, flash).
  *
  * Why It Is Structured This Way
  * -----------------------------
@@ -49,7 +50,8 @@
  *
  * Transport Details
  * -----------------
- * - Host link: USB CDC serial with SLIP framing (PacketSerial).
+ * - Host link: USB CDC serial with SLIP framing; optionally also Wi-Fi UDP
+ *   and/or BLE (build flags, see node_transport.hpp).
  * - Default baud: 115200.
  * - Inner frame: [verb][flags][seq][len][TLVs...] handled upstream.
  *
@@ -57,23 +59,26 @@
  * ------------
  * void setup():
  *   - node_protocol_begin(115200)
- *       Initialize USB CDC + SLIP transport.
+ *       Initialize USB CDC + SLIP transport (and UDP/BLE if built in).
  *   - node_protocol_set_handler(node_interface_on_packet)
  *       Route complete inner frames to the interface layer.
  *   - node_interface_begin()
- *       Load persisted settings (ID, radio params, behavior) and arm handlers.
+ *       Load persisted settings (ID, radio params, behavior), start the LoRa
+ *       radio with them (node_radio.*), take the first battery/temperature
+ *       sample (node_sense.*), and arm handlers.
  *   - node_display_begin(21, 22, 0x3C)
  *       Attempt OLED init (probes 0x3C, then 0x3D). On success, draw a simple
  *       boot banner and show the current Node ID.
  *   - node_interface_send_hello()
  *       Fire a seq=0 RESP_OK with ID so the host can register presence without
  *       waiting for a poll.
+ *   - node_tasks_begin()
+ *       Start vt_xport (node_protocol_update + node_interface_update, woken by
+ *       UART/radio RX) and vt_work (display jobs, deferred NVS commits).
  *
  * void loop():
- *   - node_protocol_update()
- *       Pump SLIP; on complete frames the registered callback runs.
- *   - (optional) yield() or other non-blocking tasks
- *       Add cooperative work here. Never block; keep the radio/serial path hot.
+ *   - Nothing left to do; the Arduino loop task deletes itself. New periodic
+ *     work is a node_sched timer on one of the node_tasks, not code here.
  *
  * Operational Notes
  * -----------------
@@ -108,8 +113,9 @@
 
 #include <Arduino.h>
 #include "node_protocol.hpp"   // node_protocol_begin, node_protocol_set_handler, node_protocol_update
-#include "node_interface.hpp"  // node_interface_begin, node_interface_on_packet, node_interface_send_hello, node_interface_id
+#include "node_interface.hpp"  // node_interface_begin, node_interface_on_packet, node_interface_update, node_interface_send_hello, node_interface_id
 #include "node_display.hpp"    // node_display_begin, node_display_draw_boot, node_display_draw_id
+#include "node_tasks.hpp"      // node_tasks_begin
 
 // TTGO LoRa32 I2C pins
 static constexpr int I2C_SDA_PIN = 21;
@@ -131,12 +137,12 @@ void setup() {
 
   // 4) Unsolicited hello (seq=0) so the host knows we're up
   node_interface_send_hello();
+
+  // 5) Runtime: transport task (core 1) + worker task (core 0)
+  node_tasks_begin();
 }
 
 void loop() {
-  // Pump SLIP; will call node_interface_on_packet() on full frames
-  node_protocol_update();
-
-  // add other cooperative (non-blocking) tasks here if needed
-  // yield();  // optional
+  // All work runs in node_tasks; the Arduino loop task has nothing left to do
+  vTaskDelete(nullptr);
 }
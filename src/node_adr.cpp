@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------------
+// node_adr.cpp
+// Implementation of the neighbour table declared in node_adr.hpp.
+//
+// Notes:
+//  * See node_adr.hpp for what is measured and how an SF is chosen.
+//  * SNR and RSSI are averaged in 0.1 dB units so the EWMA keeps its
+//    fraction; a lookup is a linear scan over kAdrSlots entries.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_adr.hpp"
+#include "node_log.hpp"         // EV_ADR_SF
+
+#include <Arduino.h>            // millis()
+
+namespace {
+
+constexpr uint8_t kSfMin = 7;
+constexpr uint8_t kSfMax = 12;
+
+struct Neighbour {
+  bool     used;
+  uint8_t  sf;                            // current per-link choice
+  uint16_t addr;
+  uint16_t samples;                       // beacons heard, saturating
+  int16_t  rssi10;                        // EWMA, 0.1 dBm
+  int16_t  snr10;                         // EWMA, 0.1 dB
+  uint32_t last_ms;
+};
+
+Neighbour g_nbr[kAdrSlots];
+uint8_t   g_base_sf = 9;                  // TAG_SF
+
+void put16(uint8_t* p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+
+bool expired(const Neighbour& n, uint32_t now) {
+  return now - n.last_ms >= kAdrTtlMs;
+}
+
+// Demodulation floor at @p sf, 0.1 dB.
+int floor10(uint8_t sf) {
+  return -75 - 25 * (sf - kSfMin);
+}
+
+// Lowest SF the averaged SNR carries with the margin (kSfMax if none does).
+uint8_t needed_sf(int snr10) {
+  for (uint8_t sf = kSfMin; sf < kSfMax; ++sf) {
+    if (snr10 >= floor10(sf) + kAdrMarginDb * 10) return sf;
+  }
+  return kSfMax;
+}
+
+int16_t ewma(int16_t avg, int x) {
+  return static_cast<int16_t>(avg + (x - avg) / 4);
+}
+
+// Up at once, down one step with hysteresis once enough beacons are in.
+void evaluate(Neighbour& n) {
+  const uint8_t old = n.sf;
+  const uint8_t need = needed_sf(n.snr10);
+  if (need > n.sf) {
+    n.sf = need;
+  } else if (n.sf > kSfMin && n.samples >= kAdrMinSamples &&
+             n.snr10 >= floor10(n.sf - 1) + (kAdrMarginDb + kAdrHystDb) * 10) {
+    --n.sf;
+  }
+  if (n.sf != old) node_log(LVL_DEBUG, EV_ADR_SF, n.addr, old | (n.sf << 8));
+}
+
+// The entry for @p addr, else a free or expired one, else the stalest.
+Neighbour& slot_for(uint16_t addr, uint32_t now) {
+  Neighbour* spare  = nullptr;
+  Neighbour* oldest = &g_nbr[0];
+  for (auto& n : g_nbr) {
+    if (n.used && n.addr == addr && !expired(n, now)) return n;
+    if ((!n.used || expired(n, now)) && !spare) spare = &n;
+    if (now - n.last_ms > now - oldest->last_ms) oldest = &n;
+  }
+  return spare ? *spare : *oldest;
+}
+
+} // namespace
+
+void node_adr_configure(uint8_t sf) {
+  g_base_sf = (sf < kSfMin) ? kSfMin : (sf > kSfMax ? kSfMax : sf);
+}
+
+// -----------------------------------------------------------------------------
+// Observe
+// - First beacon seeds the averages and starts the link at TAG_SF
+// - Later beacons fold in with 1/4 weight, then the SF is re-evaluated
+// -----------------------------------------------------------------------------
+void node_adr_observe(uint16_t addr, int16_t rssi_dbm, int8_t snr_db) {
+  const uint32_t now = millis();
+  Neighbour& n = slot_for(addr, now);
+  if (!n.used || n.addr != addr || expired(n, now)) {
+    n = Neighbour{true, g_base_sf, addr, 0,
+                  static_cast<int16_t>(rssi_dbm * 10), static_cast<int16_t>(snr_db * 10), now};
+  } else {
+    n.rssi10 = ewma(n.rssi10, rssi_dbm * 10);
+    n.snr10  = ewma(n.snr10, snr_db * 10);
+  }
+  n.last_ms = now;
+  if (n.samples < 0xFFFF) ++n.samples;
+  evaluate(n);
+}
+
+uint8_t node_adr_sf() {
+  const uint32_t now = millis();
+  uint8_t sf = 0;
+  for (const auto& n : g_nbr) {
+    if (n.used && !expired(n, now) && n.sf > sf) sf = n.sf;
+  }
+  return sf ? sf : g_base_sf;
+}
+
+size_t node_adr_rows() {
+  return kAdrSlots;
+}
+
+bool node_adr_encode(size_t row, uint8_t (&out)[kAdrWire]) {
+  if (row >= kAdrSlots) return false;
+  Neighbour& n = g_nbr[row];
+  const uint32_t now = millis();
+  if (n.used && expired(n, now)) n.used = false;
+  if (!n.used) return false;
+  const uint32_t age_s = (now - n.last_ms) / 1000;
+  put16(out + 0, n.addr);
+  put16(out + 2, static_cast<uint16_t>((n.rssi10 + (n.rssi10 < 0 ? -5 : 5)) / 10));
+  put16(out + 4, static_cast<uint16_t>(n.snr10));
+  put16(out + 6, n.samples);
+  put16(out + 8, static_cast<uint16_t>(age_s < 0xFFFF ? age_s : 0xFFFF));
+  out[10] = n.sf;
+  return true;
+}
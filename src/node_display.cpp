@@ -13,38 +13,263 @@
 /* Arduino I2C core (ESP32/Arduino). Repo (ESP32 core): https://github.com/espressif/arduino-esp32 */
 #include <Wire.h>               // TwoWire / I2C bus access
 
-/* Graphics primitives. Repo: https://github.com/adafruit/Adafruit-GFX-Library */
-#include <Adafruit_GFX.h>       // Text, lines, rectangles, coordinate space
-
 /* SSD1306 panel driver. Repo: https://github.com/adafruit/Adafruit_SSD1306 */
-#include <Adafruit_SSD1306.h>   // 128x64 OLED control (buffered)
+#include <Adafruit_SSD1306.h>   // 128x64 OLED init + page-major framebuffer
+
+#include "node_font.hpp"        // 6x8 glyphs blitted straight into page memory
+
+#include <cstring>              // memcpy, memset, strlen, strncpy
 
 /*------------------------------------------------------------------------------
   Internal state
   --------------
   We hide concrete driver types and globals in an anonymous namespace to keep the
   header clean and avoid leaking Adafruit types across translation units.
+
+  Pipeline:
+    draw_*()  (any task)  -> g_req (latest request wins, under g_mux)
+    draw_message()        -> g_hist ring + a History request
+    service() (worker)    -> render g_req into the Adafruit framebuffer
+                             (node_font, one memcpy per glyph; no GFX calls)
+                          -> diff each 128-byte page against g_glass
+                          -> push only the changed column span of changed pages
+
+  Rows are logical: row r lives in GDDRAM page (r + g_origin) % 8, and the
+  panel's display start line points at page g_origin. Scrolling the history
+  by k rows is then one command plus k freshly drawn pages.
 ------------------------------------------------------------------------------*/
 namespace {
-constexpr int  kWidth  = 128;   // Physical panel width (columns)
-constexpr int  kHeight = 64;    // Physical panel height (rows)
-constexpr int  kReset  = -1;    // No dedicated reset pin on TTGO; use -1 per driver spec
+constexpr int      kWidth  = 128;   // Physical panel width (columns)
+constexpr int      kHeight = 64;    // Physical panel height (rows)
+constexpr int      kPages  = kHeight / 8;   // SSD1306 page = 8 pixel rows, 1 byte per column
+constexpr int      kReset  = -1;    // No dedicated reset pin on TTGO; use -1 per driver spec
+constexpr uint32_t kI2cHz  = 400000;        // Fast-mode; SSD1306 spec limit (many panels take 800k+)
+constexpr size_t   kChunk  = 31;    // Data bytes per I2C transaction (+1 control byte = 32)
+constexpr size_t   kLineMax = 64;   // Text bytes kept per requested line (incl. NUL)
+constexpr size_t   kHistory = 8;    // Messages kept for the scrollback (8 rows minimum)
 
 // Global, single display instance bound to Wire. This is acceptable because the
-// node has exactly one panel; callers never see this concrete type.
-Adafruit_SSD1306 g_display(kWidth, kHeight, &Wire, kReset);
+// node has exactly one panel; callers never see this concrete type. Same clock
+// during and after transfers so the driver never toggles bus speed.
+Adafruit_SSD1306 g_display(kWidth, kHeight, &Wire, kReset, kI2cHz, kI2cHz);
 
 // Latched "display ready" flag. All draw functions short-circuit if false.
 bool g_ok = false;
+uint8_t g_addr = 0x3C;              // Address that answered in begin()
+
+// What the caller asked for most recently. Scenes overwrite each other, so a
+// burst of requests between two service() passes costs one render.
+enum class Scene : uint8_t { None, Clear, Boot, Id, TwoLines, History };
+struct Request {
+  Scene scene;
+  bool  has_a, has_b;
+  char  a[kLineMax];
+  char  b[kLineMax];
+};
+portMUX_TYPE g_mux     = portMUX_INITIALIZER_UNLOCKED;
+Request      g_req     = {};        // pending (guarded by g_mux)
+bool         g_pending = false;     // g_req not yet rendered
+bool         g_force   = false;     // next push ignores the shadow (flush())
+
+// Scrollback: the last kHistory messages, oldest overwritten (guarded by g_mux).
+char     g_hist[kHistory][kLineMax];
+uint32_t g_hist_total = 0;          // messages ever posted; slot = total % kHistory
+
+// Shadow of what is currently on glass, page-major like the SSD1306 GDDRAM.
+uint8_t g_glass[kWidth * kPages];
+
+// Worker-only render state: what the framebuffer holds and where row 0 is.
+int      g_origin       = 0;        // GDDRAM page shown on the top row
+int      g_glass_origin = 0;        // start line the panel currently has
+Scene    g_drawn        = Scene::None;
+uint32_t g_drawn_total  = 0;        // g_hist_total the History rows reflect
+
+// Copy a possibly-null C string into a fixed request line.
+inline bool take_line(char (&dst)[kLineMax], const char* src) {
+  if (!src) { dst[0] = '\0'; return false; }
+  strncpy(dst, src, kLineMax - 1);
+  dst[kLineMax - 1] = '\0';
+  return true;
+}
+
+// Record a request; cheap enough for handler context.
+void post(Scene scene, const char* a, const char* b) {
+  portENTER_CRITICAL(&g_mux);
+  g_req.scene = scene;
+  g_req.has_a = take_line(g_req.a, a);
+  g_req.has_b = take_line(g_req.b, b);
+  g_pending   = true;
+  portEXIT_CRITICAL(&g_mux);
+}
+
+// Append up to the line limit; returns the new length.
+inline size_t append(char (&dst)[kLineMax], size_t n, const char* src) {
+  while (src && *src && n < kLineMax - 1) dst[n++] = *src++;
+  dst[n] = '\0';
+  return n;
+}
+
+// Framebuffer page holding logical row r.
+inline uint8_t* page_at(int r) {
+  return g_display.getBuffer() + ((r + g_origin) % kPages) * kWidth;
+}
 
-// Optional hook to centralize any "make sure device is awake" work later.
-// Currently a no-op, but kept to make guard logic grep-able.
-inline void ensure_on() {
-  if (!g_ok) return;            // If init failed, all display ops are no-ops by design.
-  // no-op hook; kept so we can centralize guard if needed
+// Text rows a string wraps to (an empty one still takes a row).
+inline int rows_for(const char* s) {
+  const size_t n = strlen(s);
+  return n ? static_cast<int>((n + kFontCols - 1) / kFontCols) : 1;
+}
+
+// Draw s from row r on, kFontCols chars per row, clearing each row it owns.
+// Rows above the top (a message scrolled half off) and below the bottom are
+// skipped. Returns the row after the text.
+int text_rows(int r, const char* s) {
+  const size_t n = strlen(s);
+  size_t off = 0;
+  do {
+    if (r >= 0 && r < kPages) {
+      uint8_t* p = page_at(r);
+      memset(p, 0, kWidth);
+      node_font_draw(p, kWidth, s + off, kFontCols);
+    }
+    ++r;
+    off += kFontCols;
+  } while (off < n);
+  return r;
+}
+
+// Same at 2x: two rows per line, half the characters.
+void text_rows_2x(int r, const char* s) {
+  const size_t n = strlen(s);
+  for (size_t off = 0; off < n && r + 1 < kPages; off += kFontCols / 2, r += 2)
+    node_font_draw_2x(page_at(r), page_at(r + 1), kWidth, s + off, kFontCols / 2);
 }
 } // namespace
 
+/*------------------------------------------------------------------------------
+  render
+  ------
+  Paint one request into the framebuffer, page-aligned: text rows are the
+  SSD1306 pages, so every glyph is a straight column copy. Long lines wrap
+  at kFontCols characters, as GFX println() wrapped them. CPU only; no bus
+  traffic here.
+------------------------------------------------------------------------------*/
+static void render(const Request& r) {
+  memset(g_display.getBuffer(), 0, kWidth * kPages);
+
+  switch (r.scene) {
+    case Scene::Boot:
+      text_rows(0, "ViaText Booting...");
+      if (r.has_a && r.a[0]) text_rows(2, r.a);  // Defensive: require non-null and non-empty.
+      break;
+
+    case Scene::Id:
+      text_rows(0, "ViaText Node");
+      text_rows(2, "NODE ID:");                  // Leave a blank row between title and label for clarity.
+      text_rows_2x(4, r.a);                      // Large, readable at arm's length. Null is "" already.
+      break;
+
+    case Scene::TwoLines: {
+      int row = 0;
+      if (r.has_a) row = text_rows(row, r.a);    // Null lines are skipped, as before.
+      if (r.has_b) text_rows(row, r.b);
+      break;
+    }
+
+    case Scene::History:                         // Painted by render_history() instead.
+    case Scene::Clear:
+    case Scene::None:
+      break;                                     // Blank framebuffer.
+  }
+}
+
+/*------------------------------------------------------------------------------
+  render_history
+  --------------
+  Messages msgs[0..n) are oldest to newest; the newest ends on the bottom row.
+
+  full:   repaint every row, stacking older messages upwards until the top is
+          reached (the oldest visible one may show only its tail).
+  append: the framebuffer already shows everything before msgs[0]. Move the
+          origin down by the new rows (the panel follows with one start-line
+          command) and draw only those rows; every other page is untouched,
+          so push_dirty() moves just the new ones.
+------------------------------------------------------------------------------*/
+static void render_history(const char (*msgs)[kLineMax], size_t n, bool append_only) {
+  int rows = 0;
+  for (size_t i = 0; i < n; ++i) rows += rows_for(msgs[i]);
+
+  if (append_only && rows < kPages) {
+    g_origin = (g_origin + rows) % kPages;
+    int row = kPages - rows;
+    for (size_t i = 0; i < n; ++i) row = text_rows(row, msgs[i]);
+    return;
+  }
+
+  memset(g_display.getBuffer(), 0, kWidth * kPages);
+  int bottom = kPages;
+  for (size_t i = n; i-- > 0 && bottom > 0; ) {
+    bottom -= rows_for(msgs[i]);
+    text_rows(bottom, msgs[i]);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  push_page_span
+  --------------
+  Write columns [c0..c1] of one page. Horizontal addressing mode (set by the
+  driver's init) lets us bound the window with PAGEADDR/COLUMNADDR and then
+  stream data bytes in small I2C transactions.
+------------------------------------------------------------------------------*/
+static void push_page_span(int page, int c0, int c1) {
+  g_display.ssd1306_command(0x22);              // PAGEADDR
+  g_display.ssd1306_command(page);
+  g_display.ssd1306_command(page);
+  g_display.ssd1306_command(0x21);              // COLUMNADDR
+  g_display.ssd1306_command(c0);
+  g_display.ssd1306_command(c1);
+
+  const uint8_t* src = g_display.getBuffer() + page * kWidth;
+  int c = c0;
+  while (c <= c1) {
+    Wire.beginTransmission(g_addr);
+    Wire.write(static_cast<uint8_t>(0x40));     // Co=0, D/C#=1: data stream follows
+    for (size_t k = 0; k < kChunk && c <= c1; ++k, ++c) Wire.write(src[c]);
+    Wire.endTransmission();
+  }
+  memcpy(g_glass + page * kWidth + c0, src + c0, c1 - c0 + 1);   // glass now matches
+
+}
+
+/*------------------------------------------------------------------------------
+  push_dirty
+  ----------
+  Compare the framebuffer against the glass shadow page by page; push only the
+  changed column span of each changed page. A typical status update touches
+  two or three pages instead of the whole 1 KB. A moved origin goes first, so
+  a history scroll reads like a terminal: lines move up, then the new line
+  fills in at the bottom.
+------------------------------------------------------------------------------*/
+static void push_dirty(bool force) {
+  if (force || g_origin != g_glass_origin) {
+    g_display.ssd1306_command(0x40 | (g_origin * 8));   // SETSTARTLINE: row 0 = page g_origin
+    g_glass_origin = g_origin;
+  }
+
+  const uint8_t* fb = g_display.getBuffer();
+  for (int p = 0; p < kPages; ++p) {
+    const uint8_t* now  = fb + p * kWidth;
+    const uint8_t* was  = g_glass + p * kWidth;
+    int c0 = 0, c1 = kWidth - 1;
+    if (!force) {
+      while (c0 < kWidth && now[c0] == was[c0]) ++c0;
+      if (c0 == kWidth) continue;               // Page unchanged: no bus traffic.
+      while (now[c1] == was[c1]) --c1;
+    }
+    push_page_span(p, c0, c1);
+  }
+}
+
 /*------------------------------------------------------------------------------
   node_display_begin
   ------------------
@@ -64,28 +289,29 @@ inline void ensure_on() {
   - No retries/backoff here; higher layers decide how noisy to be.
 
   Phases:
-  1) Start I2C on provided pins.
+  1) Start I2C on provided pins at fast-mode clock.
   2) Try primary address; if that fails and isn't already 0x3D, try 0x3D.
-  3) If up, set legible defaults, paint a one-shot status, and latch g_ok.
+  3) If up, paint a one-shot status synchronously (boot may block), seed the
+     glass shadow from it, and latch g_ok.
 ------------------------------------------------------------------------------*/
 bool node_display_begin(int sda_pin, int scl_pin, uint8_t addr) {
   // Phase 1: I2C bus selection on ESP32-style cores.
-  Wire.begin(sda_pin, scl_pin);
+  Wire.begin(sda_pin, scl_pin, kI2cHz);
 
   // Phase 2: Probe primary, then fallback commonly seen on TTGO boards.
+  g_addr = addr;
   g_ok = g_display.begin(SSD1306_SWITCHCAPVCC, addr);
   if (!g_ok && addr != 0x3D) {                  // Avoid redundant retry if caller already passed 0x3D.
+    g_addr = 0x3D;
     g_ok = g_display.begin(SSD1306_SWITCHCAPVCC, 0x3D);
   }
 
   // Phase 3: Minimal confirmation splash; keep it short to not block boot.
   if (g_ok) {
-    g_display.clearDisplay();
-    g_display.setTextColor(SSD1306_WHITE);      // Monochrome buffer; WHITE lights pixels.
-    g_display.setTextSize(1);                   // Small font = most lines visible for diagnostics.
-    g_display.setCursor(0, 0);                  // Top-left origin.
-    g_display.println(F("Display OK"));         // F() stores literal in flash to save RAM.
-    g_display.display();                        // Push buffer to glass.
+    g_display.clearDisplay();                   // Driver init leaves start line 0, origin 0.
+    text_rows(0, "Display OK");
+    g_display.display();                        // Full push once; diffs start from here.
+    memcpy(g_glass, g_display.getBuffer(), sizeof(g_glass));
   }
   return g_ok;
 }
@@ -101,123 +327,109 @@ bool node_display_available() {
 }
 
 /*------------------------------------------------------------------------------
-  node_display_clear
-  ------------------
-  Clear and flush the screen. Safe no-op when display is absent.
+  Request helpers
+  ---------------
+  clear / draw_boot / draw_id / draw_two_lines only record what should be on
+  screen. They copy their strings (callers may reuse buffers immediately) and
+  return in microseconds. The newest request replaces any unrendered one.
 
-  Phases:
-  1) Guard on g_ok.
-  2) Clear local buffer.
-  3) Flush buffer to panel.
+  Assumptions:
+  - Any pointer may be null; null is stored as "absent" and rendered exactly
+    as the old synchronous helpers did (skipped line / empty ID).
 ------------------------------------------------------------------------------*/
 void node_display_clear() {
   if (!g_ok) return;                             // Headless-friendly: do nothing if panel is down.
-  g_display.clearDisplay();                      // Zero the framebuffer.
-  g_display.display();                           // Commit to glass.
+  post(Scene::Clear, nullptr, nullptr);
 }
 
-/*------------------------------------------------------------------------------
-  node_display_draw_boot
-  ----------------------
-  Paint a simple boot/status screen. Always uses small font for maximum text.
-  If a custom message is provided, we stack it beneath the fixed header.
-
-  Assumptions:
-  - msg may be null or empty; both are valid and ignored.
-
-  Phases:
-  1) Guard and clear.
-  2) Draw fixed header ("ViaText Booting...").
-  3) Optionally draw caller-provided line at y=12.
-  4) Flush.
-------------------------------------------------------------------------------*/
 void node_display_draw_boot(const char* msg) {
   if (!g_ok) return;
-  g_display.clearDisplay();
-  g_display.setTextColor(SSD1306_WHITE);
-  g_display.setTextSize(1);
-  g_display.setCursor(0, 0);
-  g_display.println(F("ViaText Booting..."));
-  if (msg && *msg) {                             // Defensive: require non-null and non-empty.
-    g_display.setCursor(0, 12);                  // Next text row (8px font height + spacing).
-    g_display.println(msg);
-  }
-  g_display.display();
+  post(Scene::Boot, msg, nullptr);
 }
 
-/*------------------------------------------------------------------------------
-  node_display_draw_id
-  --------------------
-  Render a three-line identity screen: title, label, and the ID in large font.
-
-  Assumptions:
-  - 'id' may be null; we print an empty string in that case to avoid crashes.
-
-  Tradeoffs:
-  - Fixed positions and sizes for legibility; no horizontal centering logic to
-    keep code obvious and predictable in the field.
-
-  Phases:
-  1) Guard and clear.
-  2) Title line (small font).
-  3) Label line (small font).
-  4) ID line (large font).
-  5) Flush.
-------------------------------------------------------------------------------*/
 void node_display_draw_id(const char* id) {
   if (!g_ok) return;
-  g_display.clearDisplay();
-  g_display.setTextColor(SSD1306_WHITE);
-
-  g_display.setTextSize(1);
-  g_display.setCursor(0, 0);
-  g_display.println(F("ViaText Node"));
+  post(Scene::Id, id, nullptr);
+}
 
-  g_display.setCursor(0, 16);                    // Leave a blank row between title and label for clarity.
-  g_display.println(F("NODE ID:"));
+void node_display_draw_two_lines(const char* line1, const char* line2) {
+  if (!g_ok) return;
+  post(Scene::TwoLines, line1, line2);
+}
 
-  g_display.setTextSize(2);                      // Large, readable at arm's length.
-  g_display.setCursor(0, 30);                    // Chosen to keep 2x font within 64px height.
-  g_display.print(id ? id : "");                 // Null-safe; avoid derefing null pointer.
-  g_display.display();
+// Compose "label + text" outside the lock; the lock covers one 64-byte copy.
+void node_display_draw_message(const char* label, const char* text) {
+  if (!g_ok) return;
+  char line[kLineMax];
+  append(line, append(line, 0, label), text);
+  portENTER_CRITICAL(&g_mux);
+  memcpy(g_hist[g_hist_total % kHistory], line, kLineMax);
+  ++g_hist_total;
+  g_req.scene = Scene::History;
+  g_pending   = true;
+  portEXIT_CRITICAL(&g_mux);
 }
 
 /*------------------------------------------------------------------------------
-  node_display_draw_two_lines
-  ---------------------------
-  Quick two-line text helper in small font. Useful for ad-hoc status.
-
-  Assumptions:
-  - Either line pointer may be null; null lines are simply skipped.
-
-  Phases:
-  1) Guard and clear.
-  2) Draw line1 if present.
-  3) Draw line2 if present (auto-advances vertically via println()).
-  4) Flush.
+  node_display_flush
+  ------------------
+  Forget what we think is on glass so the next service() pushes every page.
+  Use after a suspected panel glitch or brown-out.
 ------------------------------------------------------------------------------*/
-void node_display_draw_two_lines(const char* line1, const char* line2) {
+void node_display_flush() {
   if (!g_ok) return;
-  g_display.clearDisplay();
-  g_display.setTextColor(SSD1306_WHITE);
-  g_display.setTextSize(1);
-  g_display.setCursor(0, 0);
-  if (line1) g_display.println(line1);          // Safe: println(nullptr) would crash; we guard.
-  if (line2) g_display.println(line2);
-  g_display.display();
+  portENTER_CRITICAL(&g_mux);
+  g_force   = true;
+  g_pending = true;
+  portEXIT_CRITICAL(&g_mux);
+}
+
+bool node_display_idle() {
+  return !g_ok || !g_pending;
 }
 
 /*------------------------------------------------------------------------------
-  node_display_flush
-  ------------------
-  Expose a raw "flush buffer to glass" call. Most helpers already flush, but
-  this is useful when composing multiple draws manually.
+  node_display_service
+  --------------------
+  Background half of the pipeline (worker task). Only this function touches
+  the driver after begin(), so I2C has a single owner.
 
   Phases:
-  1) Guard.
-  2) Flush.
+  1) Take the pending request (if any) under the lock. For History, copy
+     only the messages posted since the framebuffer last showed the history
+     (all of the visible ones after another scene, a flush, or an overrun).
+  2) Render it into the framebuffer.
+  3) Push only the pages/columns that differ from the glass shadow.
 ------------------------------------------------------------------------------*/
-void node_display_flush() {
+void node_display_service() {
   if (!g_ok) return;
-  g_display.display();
+
+  // Phase 1: snapshot
+  static Request r;                              // static: 130 B off the worker stack
+  static char    msgs[kHistory][kLineMax];       // static: 512 B likewise
+  bool     force, append_only = false;
+  uint32_t total;
+  size_t   n = 0;
+  portENTER_CRITICAL(&g_mux);
+  if (!g_pending) { portEXIT_CRITICAL(&g_mux); return; }
+  r         = g_req;
+  force     = g_force;
+  total     = g_hist_total;
+  g_pending = false;
+  g_force   = false;
+  if (r.scene == Scene::History) {
+    uint32_t first = total > kHistory ? total - kHistory : 0;
+    if (!force && g_drawn == Scene::History && g_drawn_total >= first) {
+      first       = g_drawn_total;
+      append_only = true;
+    }
+    for (uint32_t k = first; k < total; ++k) memcpy(msgs[n++], g_hist[k % kHistory], kLineMax);
+  }
+  portEXIT_CRITICAL(&g_mux);
+
+  // Phase 2 + 3
+  if (r.scene == Scene::History) render_history(msgs, n, append_only);
+  else if (r.scene != Scene::None) render(r);
+  if (r.scene != Scene::None) { g_drawn = r.scene; g_drawn_total = total; }
+  push_dirty(force);
 }
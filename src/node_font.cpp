@@ -0,0 +1,87 @@
+// -----------------------------------------------------------------------------
+// node_font.cpp
+// Implementation of the page-native glyph blitter declared in node_font.hpp.
+//
+// Notes:
+//  * See node_font.hpp for the page layout and what the calls write.
+//  * The table is const, so on the ESP32 it stays in flash (rodata); a
+//    glyph is one 6-byte memcpy.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_font.hpp"
+
+#include <cstring>              // memcpy
+
+namespace {
+
+constexpr char kFirst = 0x20;
+constexpr char kLast  = 0x7E;
+
+// Column-major, bit 0 = top row; the sixth byte is the inter-glyph gap.
+const uint8_t kGlyphs[kLast - kFirst + 1][kFontW] = {
+  {0x00,0x00,0x00,0x00,0x00,0}, {0x00,0x00,0x5F,0x00,0x00,0}, {0x00,0x07,0x00,0x07,0x00,0}, // ' ' ! "
+  {0x14,0x7F,0x14,0x7F,0x14,0}, {0x24,0x2A,0x7F,0x2A,0x12,0}, {0x23,0x13,0x08,0x64,0x62,0}, // # $ %
+  {0x36,0x49,0x55,0x22,0x50,0}, {0x00,0x05,0x03,0x00,0x00,0}, {0x00,0x1C,0x22,0x41,0x00,0}, // & ' (
+  {0x00,0x41,0x22,0x1C,0x00,0}, {0x08,0x2A,0x1C,0x2A,0x08,0}, {0x08,0x08,0x3E,0x08,0x08,0}, // ) * +
+  {0x00,0x50,0x30,0x00,0x00,0}, {0x08,0x08,0x08,0x08,0x08,0}, {0x00,0x60,0x60,0x00,0x00,0}, // , - .
+  {0x20,0x10,0x08,0x04,0x02,0}, {0x3E,0x51,0x49,0x45,0x3E,0}, {0x00,0x42,0x7F,0x40,0x00,0}, // / 0 1
+  {0x42,0x61,0x51,0x49,0x46,0}, {0x21,0x41,0x45,0x4B,0x31,0}, {0x18,0x14,0x12,0x7F,0x10,0}, // 2 3 4
+  {0x27,0x45,0x45,0x45,0x39,0}, {0x3C,0x4A,0x49,0x49,0x30,0}, {0x01,0x71,0x09,0x05,0x03,0}, // 5 6 7
+  {0x36,0x49,0x49,0x49,0x36,0}, {0x06,0x49,0x49,0x29,0x1E,0}, {0x00,0x36,0x36,0x00,0x00,0}, // 8 9 :
+  {0x00,0x56,0x36,0x00,0x00,0}, {0x08,0x14,0x22,0x41,0x00,0}, {0x14,0x14,0x14,0x14,0x14,0}, // ; < =
+  {0x00,0x41,0x22,0x14,0x08,0}, {0x02,0x01,0x51,0x09,0x06,0}, {0x32,0x49,0x79,0x41,0x3E,0}, // > ? @
+  {0x7E,0x11,0x11,0x11,0x7E,0}, {0x7F,0x49,0x49,0x49,0x36,0}, {0x3E,0x41,0x41,0x41,0x22,0}, // A B C
+  {0x7F,0x41,0x41,0x22,0x1C,0}, {0x7F,0x49,0x49,0x49,0x41,0}, {0x7F,0x09,0x09,0x01,0x01,0}, // D E F
+  {0x3E,0x41,0x41,0x51,0x32,0}, {0x7F,0x08,0x08,0x08,0x7F,0}, {0x00,0x41,0x7F,0x41,0x00,0}, // G H I
+  {0x20,0x40,0x41,0x3F,0x01,0}, {0x7F,0x08,0x14,0x22,0x41,0}, {0x7F,0x40,0x40,0x40,0x40,0}, // J K L
+  {0x7F,0x02,0x04,0x02,0x7F,0}, {0x7F,0x04,0x08,0x10,0x7F,0}, {0x3E,0x41,0x41,0x41,0x3E,0}, // M N O
+  {0x7F,0x09,0x09,0x09,0x06,0}, {0x3E,0x41,0x51,0x21,0x5E,0}, {0x7F,0x09,0x19,0x29,0x46,0}, // P Q R
+  {0x46,0x49,0x49,0x49,0x31,0}, {0x01,0x01,0x7F,0x01,0x01,0}, {0x3F,0x40,0x40,0x40,0x3F,0}, // S T U
+  {0x1F,0x20,0x40,0x20,0x1F,0}, {0x7F,0x20,0x18,0x20,0x7F,0}, {0x63,0x14,0x08,0x14,0x63,0}, // V W X
+  {0x03,0x04,0x78,0x04,0x03,0}, {0x61,0x51,0x49,0x45,0x43,0}, {0x00,0x7F,0x41,0x41,0x00,0}, // Y Z [
+  {0x02,0x04,0x08,0x10,0x20,0}, {0x00,0x41,0x41,0x7F,0x00,0}, {0x04,0x02,0x01,0x02,0x04,0}, // \ ] ^
+  {0x40,0x40,0x40,0x40,0x40,0}, {0x00,0x01,0x02,0x04,0x00,0}, {0x20,0x54,0x54,0x54,0x78,0}, // _ ` a
+  {0x7F,0x48,0x44,0x44,0x38,0}, {0x38,0x44,0x44,0x44,0x20,0}, {0x38,0x44,0x44,0x48,0x7F,0}, // b c d
+  {0x38,0x54,0x54,0x54,0x18,0}, {0x08,0x7E,0x09,0x01,0x02,0}, {0x08,0x14,0x54,0x54,0x3C,0}, // e f g
+  {0x7F,0x08,0x04,0x04,0x78,0}, {0x00,0x44,0x7D,0x40,0x00,0}, {0x20,0x40,0x44,0x3D,0x00,0}, // h i j
+  {0x00,0x7F,0x10,0x28,0x44,0}, {0x00,0x41,0x7F,0x40,0x00,0}, {0x7C,0x04,0x18,0x04,0x78,0}, // k l m
+  {0x7C,0x08,0x04,0x04,0x78,0}, {0x38,0x44,0x44,0x44,0x38,0}, {0x7C,0x14,0x14,0x14,0x08,0}, // n o p
+  {0x08,0x14,0x14,0x18,0x7C,0}, {0x7C,0x08,0x04,0x04,0x08,0}, {0x48,0x54,0x54,0x54,0x20,0}, // q r s
+  {0x04,0x3F,0x44,0x40,0x20,0}, {0x3C,0x40,0x40,0x20,0x7C,0}, {0x1C,0x20,0x40,0x20,0x1C,0}, // t u v
+  {0x3C,0x40,0x30,0x40,0x3C,0}, {0x44,0x28,0x10,0x28,0x44,0}, {0x0C,0x50,0x50,0x50,0x3C,0}, // w x y
+  {0x44,0x64,0x54,0x4C,0x44,0}, {0x00,0x08,0x36,0x41,0x00,0}, {0x00,0x00,0x7F,0x00,0x00,0}, // z { |
+  {0x00,0x41,0x36,0x08,0x00,0}, {0x08,0x04,0x08,0x10,0x08,0},                               // } ~
+};
+
+// Nibble -> byte with every bit doubled (0b0101 -> 0b00110011).
+const uint8_t kDouble[16] = {
+  0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+  0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF,
+};
+
+}  // namespace
+
+const uint8_t* node_font_glyph(char c) {
+  if (c < kFirst || c > kLast) c = '?';
+  return kGlyphs[c - kFirst];
+}
+
+size_t node_font_draw(uint8_t* page, size_t width, const char* s, size_t n) {
+  size_t col = 0;
+  for (size_t i = 0; i < n && s[i] && col + kFontW <= width; ++i, col += kFontW)
+    memcpy(page + col, node_font_glyph(s[i]), kFontW);
+  return col;
+}
+
+size_t node_font_draw_2x(uint8_t* top, uint8_t* bottom, size_t width, const char* s, size_t n) {
+  size_t col = 0;
+  for (size_t i = 0; i < n && s[i] && col + 2 * kFontW <= width; ++i) {
+    const uint8_t* g = node_font_glyph(s[i]);
+    for (size_t k = 0; k < kFontW; ++k, col += 2) {
+      top[col]    = top[col + 1]    = kDouble[g[k] & 0x0F];
+      bottom[col] = bottom[col + 1] = kDouble[g[k] >> 4];
+    }
+  }
+  return col;
+}
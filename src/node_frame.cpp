@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------------
+// node_frame.cpp
+// Implementation of the pooled frame writer declared in node_frame.hpp.
+//
+// Notes:
+//  * See node_frame.hpp for capacity, truncation, and pool rules.
+//  * A counting semaphore tracks free slots; a bitmask under a spinlock
+//    picks which one, so acquire/release never touch the heap.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_frame.hpp"
+
+#include <Arduino.h>            // FreeRTOS semaphore + portMUX via the ESP32 core
+#include <cstring>              // memcpy
+
+namespace {
+
+uint8_t           g_pool[kTxPoolSlots][kFrameMax];
+uint8_t           g_used = 0;                 // bit k set = slot k borrowed
+portMUX_TYPE      g_mux  = portMUX_INITIALIZER_UNLOCKED;
+StaticSemaphore_t g_free_buf;
+SemaphoreHandle_t g_free = nullptr;           // counts free slots
+
+static_assert(kTxPoolSlots <= 8, "g_used is an 8-bit mask");
+
+}  // namespace
+
+void node_frame_begin() {
+  if (!g_free) g_free = xSemaphoreCreateCountingStatic(kTxPoolSlots, kTxPoolSlots, &g_free_buf);
+}
+
+// -----------------------------------------------------------------------------
+// Borrow a slot and write the header
+// -----------------------------------------------------------------------------
+FrameWriter::FrameWriter(uint8_t verb, uint8_t seq, bool len16)
+    : buf_(nullptr), slot_(0), hdr_(len16 ? kFrameHdr16 : kFrameHdr), trunc_(false),
+      i_(0), cap_(len16 ? kFrameMax : kFrameHdr + 255) {
+  if (!g_free || xSemaphoreTake(g_free, portMAX_DELAY) != pdTRUE) return;
+  portENTER_CRITICAL(&g_mux);
+  for (uint8_t k = 0; k < kTxPoolSlots; ++k) {
+    if (!(g_used & (1u << k))) { g_used |= (1u << k); slot_ = k; break; }
+  }
+  portEXIT_CRITICAL(&g_mux);
+  buf_ = g_pool[slot_];
+  buf_[0] = verb;
+  buf_[1] = len16 ? FLAG_LEN16 : 0;
+  buf_[2] = seq;
+  buf_[3] = 0;
+  buf_[4] = 0;                                // harmless for the 4-byte form (body overwrites)
+  i_ = hdr_;
+}
+
+FrameWriter::~FrameWriter() {
+  if (!buf_) return;
+  portENTER_CRITICAL(&g_mux);
+  g_used &= ~(1u << slot_);
+  portEXIT_CRITICAL(&g_mux);
+  xSemaphoreGive(g_free);
+}
+
+// -----------------------------------------------------------------------------
+// Appends: all-or-nothing against cap_
+// -----------------------------------------------------------------------------
+bool FrameWriter::tlv(uint8_t tag, const void* p, size_t len) {
+  if (!buf_ || len > 255 || 2 + len > room()) { trunc_ = true; return false; }
+  buf_[i_++] = tag;
+  buf_[i_++] = static_cast<uint8_t>(len);
+  if (len) { memcpy(buf_ + i_, p, len); i_ += len; }
+  return true;
+}
+
+bool FrameWriter::raw(const void* p, size_t n) {
+  if (!buf_ || n > room()) { trunc_ = true; return false; }
+  if (n) { memcpy(buf_ + i_, p, n); i_ += n; }
+  return true;
+}
+
+void FrameWriter::restart(uint8_t verb) {
+  if (!buf_) return;
+  buf_[0] = verb;
+  buf_[1] &= FLAG_LEN16;
+  i_ = hdr_;
+  trunc_ = false;
+}
+
+void FrameWriter::set_flags(uint8_t bits) {
+  if (buf_) buf_[1] |= static_cast<uint8_t>(bits & ~FLAG_LEN16);
+}
+
+// -----------------------------------------------------------------------------
+// Close and ship
+// -----------------------------------------------------------------------------
+const uint8_t* FrameWriter::finish() {
+  if (!buf_) return nullptr;
+  const size_t n = i_ - hdr_;
+  buf_[3] = static_cast<uint8_t>(n);
+  if (hdr_ == kFrameHdr16) buf_[4] = static_cast<uint8_t>(n >> 8);
+  return buf_;
+}
+
+void FrameWriter::send() {
+  if (!buf_) return;
+  protocol_send(finish(), i_);
+}
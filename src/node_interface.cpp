@@ -4,9 +4,25 @@
 #include "node_interface.hpp"   // Node-facing API: I/O, IDs, hello, send/receive
 #include "node_protocol.hpp"    // Core protocol loop: begin, update, handlers
 #include "node_display.hpp"     // OLED/LCD drawing: boot screen, ID display
+#include "node_radio.hpp"       // LoRa engine: live config, TX queue, RX ring, link metrics
+#include "node_log.hpp"         // Binary event ring: TAG_LOG_COUNT, GET_LOG
+#include "node_frame.hpp"       // FrameWriter: pooled, bounds-checked outbound frames
+#include "node_stats.hpp"       // Hot-path counters: RESP_ERR reasons, handler times, GET_STATS
+#include "node_msgq.hpp"        // Outbound/inbound message queues (TAG_BUF_SIZE, lanes, XOFF)
+#include "node_link.hpp"        // Air header, ACK/retry (TAG_ACK_MODE), duplicate suppression
+#include "node_sched.hpp"       // Timer wheel: TAG_BEACON_SEC beacons on the transport task
+#include "node_adr.hpp"         // Neighbour link quality, TAG_ADR_SF, TAG_STAT_NBR
+#include "node_sense.hpp"       // Cached battery / die temperature (TAG_VBAT_MV, TAG_TEMP_C10)
+#include "node_store.hpp"       // Flash store-and-forward (TAG_STORE)
+#include "node_power.hpp"       // Light sleep when idle (TAG_SLEEP), TAG_STAT_POWER
+#include "node_transport.hpp"   // LinkId (SET_BAUD is UART-only)
+#include "node_replay.hpp"      // Retransmitted requests answered from their recorded reply
+#include "node_tlv.hpp"         // TlvView: validated, indexed request bodies
 
 #include <Arduino.h>            // Arduino framework base (pins, Serial, etc.)
 #include <Preferences.h>        // ESP32 NVS key/value storage (persist ID/alias)
+#include <esp_system.h>         // esp_register_shutdown_handler (flush before reboot)
+#include <esp_timer.h>          // esp_timer_get_time (BENCH timestamps)
 #include <cstring>              // Standard C string utilities (memcpy, strcmp, etc.)
 
 // ============================================================================
@@ -18,6 +34,7 @@ static bool        s_prefs_open = false; // Tracks whether NVS is successfully o
 
 static char        s_id[32]    = "HckrMn";   // Node ID (31 chars + NUL terminator)
 static char        s_alias[32] = "";         // Human-friendly alias/name
+static char        s_fw_version[8] = "1.0.0"; // TODO: tie to build version macro if available
 
 static uint32_t    s_freq_hz   = 915000000;  // Default radio frequency (Hz)
 static uint8_t     s_sf        = 9;          // LoRa spreading factor
@@ -25,96 +42,77 @@ static uint32_t    s_bw_hz     = 125000;     // LoRa bandwidth (Hz)
 static uint8_t     s_cr        = 5;          // LoRa coding rate (4/5 default)
 static int8_t      s_tx_pwr    = 17;         // Radio TX power (dBm)
 
-static uint8_t     s_chan      = 0;          // Logical channel index
+static uint8_t     s_chan      = 0;          // Channel plan index, or kRadioChanHop (node_radio)
 static uint8_t     s_mode      = 0;          // Node mode (0=relay, etc.)
 static uint8_t     s_hops      = 1;          // Maximum relay hops allowed
 static uint32_t    s_beacon_s  = 0;          // Beacon interval (seconds, 0=disabled)
-static uint16_t    s_buf_size  = 32;         // Outbound buffer/queue size
+static uint16_t    s_buf_size  = 32;         // Per-direction message queue capacity (node_msgq)
 static uint8_t     s_ack_mode  = 0;          // ACK setting (0=off, 1=on)
+static uint16_t    s_dst       = kAirBroadcast;  // Air address MSGs go to (RAM only)
+static uint8_t     s_sleep     = 0;          // Power mode (0=awake, 1=light sleep when idle)
+static uint8_t     s_compress  = 0;          // Pack MSG payloads on air (0=raw, 1=node_smaz)
+static uint8_t     s_store     = 0;          // Store-and-forward in flash (0=off, 1=on)
+static uint32_t    s_cfg_gen   = 0;          // Config generation (TAG_CFG_GEN), persisted with the rows
 
 
 // last received text for UI/debug
 static char s_last_text[64] = "";  // Holds the most recent incoming MSG text
 
-// ============================================================================
-// Load / Save helpers
-// ============================================================================
+static volatile uint32_t s_nvs_free = 0;  // free NVS bytes, refreshed after each load/commit
+
+// radio_config() — snapshot the radio globals in the shape node_radio expects.
+static RadioConfig radio_config() {
+  RadioConfig c;
+  c.freq_hz = s_freq_hz;
+  c.sf      = s_sf;
+  c.bw_hz   = s_bw_hz;
+  c.cr      = s_cr;
+  c.tx_pwr  = s_tx_pwr;
+  c.chan    = s_chan;
+  return c;
+}
 
-//
-// load_from_nvs()
-// ----------------
-// Pulls persisted configuration out of ESP32 NVS into our globals.
-// If NVS is unavailable, keep defaults in memory and exit quietly.
-//
-// Process:
-//   1. Attempt to open the "viatext" namespace in read/write mode.
-//   2. If open fails, leave defaults untouched.
-//   3. Otherwise, read each key into its associated global.
-//      Each getter takes a fallback default (the in-memory value).
-//
-static void load_from_nvs() {
-  // Phase 1: open NVS (read/write so we can later update too)
-  s_prefs_open = s_prefs.begin("viatext", /*readOnly=*/false);
-  if (!s_prefs_open) return;  // If open fails, don't touch defaults
+// radio_apply() — push the radio globals to the modem and to the ACK timing.
+static void radio_apply() {
+  const RadioConfig c = radio_config();
+  node_radio_configure(c);
+  node_link_configure(c);
+  node_adr_configure(c.sf);
+}
 
-  // Phase 2: identity strings (guarded by buffer sizes)
-  s_prefs.getString("id", s_id, sizeof(s_id));
-  s_prefs.getString("alias", s_alias, sizeof(s_alias));
+static SchedId s_beacon_timer = -1;               // SCHED_XPORT; stopped while TAG_BEACON_SEC=0
+static constexpr uint32_t kBeaconMaxS = 86400;    // longer periods clamp to one day
 
-  // Phase 3: radio/system parameters (numeric values)
-  s_freq_hz  = s_prefs.getULong("freq_hz", s_freq_hz);
-  s_sf       = s_prefs.getUChar("sf", s_sf);
-  s_bw_hz    = s_prefs.getULong("bw_hz", s_bw_hz);
-  s_cr       = s_prefs.getUChar("cr", s_cr);
-  s_tx_pwr   = s_prefs.getChar("tx_pwr", s_tx_pwr);
-  s_chan     = s_prefs.getUChar("chan", s_chan);
-  s_mode     = s_prefs.getUChar("mode", s_mode);
-  s_hops     = s_prefs.getUChar("hops", s_hops);
-  s_beacon_s = s_prefs.getULong("beacon_s", s_beacon_s);
-  s_buf_size = s_prefs.getUShort("buf_size", s_buf_size);
-  s_ack_mode = s_prefs.getUChar("ack_mode", s_ack_mode);
+// send_beacon() — timer callback: announce this node to its neighbours.
+static void send_beacon() {
+  if (node_radio_available()) node_link_beacon(s_id);       // TX ring full: next period
 }
 
+// beacon_apply() — (re)arm the beacon timer from TAG_BEACON_SEC; first beacon one period out.
+static void beacon_apply() {
+  if (s_beacon_timer < 0) s_beacon_timer = node_sched_add(SCHED_XPORT, send_beacon);
+  if (s_beacon_s == 0) { node_sched_stop(s_beacon_timer); return; }
+  const uint32_t ms = (s_beacon_s < kBeaconMaxS ? s_beacon_s : kBeaconMaxS) * 1000u;
+  node_sched_start(s_beacon_timer, ms, ms);
+}
 
-//
-// save_to_nvs()
-// --------------
-// Push current in-memory config back into ESP32 NVS.
-// Ensures persistence across resets/power cycles.
-//
-// Process:
-//   1. If NVS isn't open yet, try to open it now (read/write).
-//      If that fails, exit without saving.
-//   2. Write each field to its matching key.
-//      Each call replaces or creates the key with the new value.
-//
-// Notes:
-//   - All globals are assumed valid by this point (validated earlier).
-//   - NVS commit is implicit in Preferences API (auto after each put).
-//
-static void save_to_nvs() {
-  // Step 1: open storage if not already open
-  if (!s_prefs_open) {
-    s_prefs_open = s_prefs.begin("viatext", false);
-    if (!s_prefs_open) return;  // bail out if open fails
-  }
+static uint32_t s_heard_mark = 0;                 // node_link_heard() when the last MSG failed
 
-  // Step 2: write identity strings
-  s_prefs.putString("id", s_id);
-  s_prefs.putString("alias", s_alias);
+// store_failed() — node_link hook: keep an undeliverable MSG for later (TAG_STORE=1).
+static void store_failed(const Msg& m) {
+  if (s_store == 1) node_store_put(STORE_OUT, m);
+  s_heard_mark = node_link_heard();               // replay once someone is heard again
+}
 
-  // Step 3: write radio/system parameters
-  s_prefs.putULong("freq_hz", s_freq_hz);
-  s_prefs.putUChar("sf", s_sf);
-  s_prefs.putULong("bw_hz", s_bw_hz);
-  s_prefs.putUChar("cr", s_cr);
-  s_prefs.putChar("tx_pwr", s_tx_pwr);
-  s_prefs.putUChar("chan", s_chan);
-  s_prefs.putUChar("mode", s_mode);
-  s_prefs.putUChar("hops", s_hops);
-  s_prefs.putULong("beacon_s", s_beacon_s);
-  s_prefs.putUShort("buf_size", s_buf_size);
-  s_prefs.putUChar("ack_mode", s_ack_mode);
+// replay_outbound() — stored MSGs back into the outbound queue, as many as it takes.
+// Each record is read from flash straight into the pool slot that carries it on.
+static void replay_outbound() {
+  if (!node_store_pending(STORE_OUT) || node_link_heard() == s_heard_mark) return;
+  while (Msg* m = node_msgq_alloc()) {
+    if (!node_store_peek(STORE_OUT, *m)) { node_msgq_free(m); return; }
+    if (!node_msgq_commit(MQ_OUT, m)) return;                 // queue full: the record waits
+    node_store_pop(STORE_OUT);
+  }
 }
 
 
@@ -166,149 +164,483 @@ static bool is_valid_id(const char* p) {
  * -------------
  * Legal LoRa spreading factors are 7..12 inclusive.
  */
-static bool is_valid_sf(uint8_t v)      { return v >= 7 && v <= 12; }
+static bool is_valid_sf(uint32_t v)     { return v >= 7 && v <= 12; }
 
 /*
  * is_valid_cr()
  * -------------
  * Coding rate code 5..8 maps to 4/5..4/8.
  */
-static bool is_valid_cr(uint8_t v)      { return v >= 5 && v <= 8; }
+static bool is_valid_cr(uint32_t v)     { return v >= 5 && v <= 8; }
 
 /*
- * is_valid_ack()
+ * is_valid_flag()
+ * ---------------
+ * Boolean settings (ACK mode, sleep) are encoded as 0 or 1.
+ */
+static bool is_valid_flag(uint32_t v)   { return v == 0 || v == 1; }
+
+/*
+ * is_valid_qcap()
+ * ---------------
+ * Queue capacity must fit the static pool in node_msgq.
+ */
+static bool is_valid_qcap(uint32_t v)  { return v >= kMsgQueueMin && v <= kMsgQueueMax; }
+
+/*
+ * is_valid_chan()
+ * ---------------
+ * A channel of node_radio's plan, or hop mode.
+ */
+static bool is_valid_chan(uint32_t v)  { return v < kRadioChanCount || v == kRadioChanHop; }
+
+/*
+ * is_valid_dst()
  * --------------
- * ACK mode is a boolean flag encoded as 0 or 1.
+ * Any node address or kAirBroadcast; 0 is never assigned (node_link_set_addr).
  */
-static bool is_valid_ack(uint8_t v)     { return v == 0 || v == 1; }
+static bool is_valid_dst(uint32_t v)   { return v != 0; }
+
+
 
 
 // ============================================================================
-// TLV helpers
+// Tag descriptor table
 // ============================================================================
+//
+// One row per protocol tag. Everything tag-specific is derived from kTags:
+// GET_PARAM/GET_ALL encoding, SET_PARAM decoding and validation, the SET_PARAM
+// echo, the NVS blob image, and the legacy NVS keys. Adding a tag is one row
+// here (plus its global or getter). Rows are sorted by tag, and persisted rows
+// therefore also fix the blob field order.
+
+enum DirtyBit : uint16_t {
+  DIRTY_ID       = 1u << 0,
+  DIRTY_ALIAS    = 1u << 1,
+  DIRTY_FREQ     = 1u << 2,
+  DIRTY_SF       = 1u << 3,
+  DIRTY_BW       = 1u << 4,
+  DIRTY_CR       = 1u << 5,
+  DIRTY_TX_PWR   = 1u << 6,
+  DIRTY_CHAN     = 1u << 7,
+  DIRTY_MODE     = 1u << 8,
+  DIRTY_HOPS     = 1u << 9,
+  DIRTY_BEACON   = 1u << 10,
+  DIRTY_BUF_SIZE = 1u << 11,
+  DIRTY_ACK_MODE = 1u << 12,
+  DIRTY_SLEEP    = 1u << 13,
+  DIRTY_COMPRESS = 1u << 14,
+  DIRTY_STORE    = 1u << 15,
+  DIRTY_ALL      = (1u << 16) - 1
+};
+
+enum TagKind : uint8_t {
+  TK_UINT,    // unsigned little-endian integer of `width` bytes
+  TK_SINT,    // signed (two's complement) little-endian integer of `width` bytes
+  TK_STR      // raw bytes, no NUL on the wire; `width` is the buffer size incl. NUL
+};
+
+enum TagFlag : uint8_t {
+  TF_RW    = 1u << 0,   // writable via SET_PARAM (and echoed in its reply)
+  TF_NVS   = 1u << 1,   // persisted in the "cfg" blob
+  TF_RADIO = 1u << 2,   // a write must be pushed to the modem
+  TF_ALL   = 1u << 3    // included in GET_ALL
+};
+
+struct TagDesc {
+  uint8_t     tag;
+  uint8_t     kind;               // TagKind
+  uint8_t     width;              // wire bytes (1/2/4), or buffer size for TK_STR
+  uint8_t     flags;              // TagFlag mask
+  uint16_t    dirty;              // DirtyBit for TF_NVS rows, else 0
+  void*       ptr;                // backing storage; nullptr when get() computes the value
+  uint32_t  (*get)();             // computed read-only value (numeric rows without ptr)
+  bool      (*valid)(uint32_t);   // write range check; nullptr accepts any value of the width
+  const char* key;                // legacy per-field NVS key (pre-blob layout)
+};
+
+// Computed, read-only values.
+static uint32_t get_uptime_s()   { return millis() / 1000; }
+static uint32_t get_boot_time()  { return 0; }       // TODO: real epoch from RTC if available
+static uint32_t get_baud()       { return node_protocol_baud(); }
+static uint32_t get_addr()       { return node_link_addr(); }
+static uint32_t get_rssi()       { return static_cast<uint16_t>(node_radio_last_rssi()); }
+static uint32_t get_snr()        { return static_cast<uint8_t>(node_radio_last_snr()); }
+static uint32_t get_adr_sf()     { return node_adr_sf(); }
+static uint32_t get_vbat_mv()    { return node_sense_vbat_mv(); }   // averaged by the worker; no ADC here
+static uint32_t get_temp_c10()   { return static_cast<uint16_t>(node_sense_temp_c10()); }
+static uint32_t get_free_mem()   { return ESP.getFreeHeap(); }
+static uint32_t get_free_flash() { return s_nvs_free + node_store_free_bytes(); }  // NVS part cached by the worker
+static uint32_t get_store_pend() { return node_store_pending(STORE_OUT) + node_store_pending(STORE_IN); }
+static uint32_t get_log_count()  { return node_log_count(); }
+static uint32_t get_q_out()      { return node_msgq_depth(MQ_OUT); }
+static uint32_t get_q_in()       { return node_msgq_depth(MQ_IN); }
+static uint32_t get_q_drops()    { return node_msgq_drops(); }
+
+static constexpr uint8_t kRwNvs = TF_RW | TF_NVS | TF_ALL;
+
+static constexpr TagDesc kTags[] = {
+  // tag             kind     width                 flags               dirty           ptr            get             valid          key
+  { TAG_ID,          TK_STR,  sizeof(s_id),         TF_NVS | TF_ALL,    DIRTY_ID,       s_id,          nullptr,        nullptr,       "id"       },
+  { TAG_ALIAS,       TK_STR,  sizeof(s_alias),      kRwNvs,             DIRTY_ALIAS,    s_alias,       nullptr,        nullptr,       "alias"    },
+  { TAG_FW_VERSION,  TK_STR,  sizeof(s_fw_version), 0,                  0,              s_fw_version,  nullptr,        nullptr,       nullptr    },
+  { TAG_UPTIME_S,    TK_UINT, 4,                    0,                  0,              nullptr,       get_uptime_s,   nullptr,       nullptr    },
+  { TAG_BOOT_TIME,   TK_UINT, 4,                    0,                  0,              nullptr,       get_boot_time,  nullptr,       nullptr    },
+  { TAG_BAUD,        TK_UINT, 4,                    0,                  0,              nullptr,       get_baud,       nullptr,       nullptr    },
+  { TAG_ADDR,        TK_UINT, 2,                    TF_ALL,             0,              nullptr,       get_addr,       nullptr,       nullptr    },
+  { TAG_DST,         TK_UINT, 2,                    TF_RW | TF_ALL,     0,              &s_dst,        nullptr,        is_valid_dst,  nullptr    },
+  { TAG_FREQ_HZ,     TK_UINT, 4,                    kRwNvs | TF_RADIO,  DIRTY_FREQ,     &s_freq_hz,    nullptr,        nullptr,       "freq_hz"  },
+  { TAG_SF,          TK_UINT, 1,                    kRwNvs | TF_RADIO,  DIRTY_SF,       &s_sf,         nullptr,        is_valid_sf,   "sf"       },
+  { TAG_BW_HZ,       TK_UINT, 4,                    kRwNvs | TF_RADIO,  DIRTY_BW,       &s_bw_hz,      nullptr,        nullptr,       "bw_hz"    },
+  { TAG_CR,          TK_UINT, 1,                    kRwNvs | TF_RADIO,  DIRTY_CR,       &s_cr,         nullptr,        is_valid_cr,   "cr"       },
+  { TAG_TX_PWR_DBM,  TK_SINT, 1,                    kRwNvs | TF_RADIO,  DIRTY_TX_PWR,   &s_tx_pwr,     nullptr,        nullptr,       "tx_pwr"   },
+  { TAG_CHAN,        TK_UINT, 1,                    kRwNvs | TF_RADIO,  DIRTY_CHAN,     &s_chan,       nullptr,        is_valid_chan, "chan"     },
+  { TAG_MODE,        TK_UINT, 1,                    kRwNvs,             DIRTY_MODE,     &s_mode,       nullptr,        nullptr,       "mode"     },
+  { TAG_HOPS,        TK_UINT, 1,                    kRwNvs,             DIRTY_HOPS,     &s_hops,       nullptr,        nullptr,       "hops"     },
+  { TAG_BEACON_SEC,  TK_UINT, 4,                    kRwNvs,             DIRTY_BEACON,   &s_beacon_s,   nullptr,        nullptr,       "beacon_s" },
+  { TAG_BUF_SIZE,    TK_UINT, 2,                    kRwNvs,             DIRTY_BUF_SIZE, &s_buf_size,   nullptr,        is_valid_qcap, "buf_size" },
+  { TAG_ACK_MODE,    TK_UINT, 1,                    kRwNvs,             DIRTY_ACK_MODE, &s_ack_mode,   nullptr,        is_valid_flag, "ack_mode" },
+  { TAG_Q_OUT,       TK_UINT, 2,                    TF_ALL,             0,              nullptr,       get_q_out,      nullptr,       nullptr    },
+  { TAG_Q_IN,        TK_UINT, 2,                    TF_ALL,             0,              nullptr,       get_q_in,       nullptr,       nullptr    },
+  { TAG_Q_DROPS,     TK_UINT, 4,                    TF_ALL,             0,              nullptr,       get_q_drops,    nullptr,       nullptr    },
+  { TAG_SLEEP,       TK_UINT, 1,                    kRwNvs,             DIRTY_SLEEP,    &s_sleep,      nullptr,        is_valid_flag, "sleep"    },
+  { TAG_COMPRESS,    TK_UINT, 1,                    kRwNvs,             DIRTY_COMPRESS, &s_compress,   nullptr,        is_valid_flag, "compress" },
+  { TAG_STORE,       TK_UINT, 1,                    kRwNvs,             DIRTY_STORE,    &s_store,      nullptr,        is_valid_flag, "store"    },
+  { TAG_STORE_PEND,  TK_UINT, 2,                    TF_ALL,             0,              nullptr,       get_store_pend, nullptr,       nullptr    },
+  { TAG_CFG_GEN,     TK_UINT, 4,                    TF_NVS | TF_ALL,    0,              &s_cfg_gen,    nullptr,        nullptr,       nullptr    },
+  { TAG_RSSI_DBM,    TK_SINT, 2,                    TF_ALL,             0,              nullptr,       get_rssi,       nullptr,       nullptr    },
+  { TAG_SNR_DB,      TK_SINT, 1,                    TF_ALL,             0,              nullptr,       get_snr,        nullptr,       nullptr    },
+  { TAG_VBAT_MV,     TK_UINT, 2,                    TF_ALL,             0,              nullptr,       get_vbat_mv,    nullptr,       nullptr    },
+  { TAG_TEMP_C10,    TK_SINT, 2,                    TF_ALL,             0,              nullptr,       get_temp_c10,   nullptr,       nullptr    },
+  { TAG_FREE_MEM,    TK_UINT, 4,                    TF_ALL,             0,              nullptr,       get_free_mem,   nullptr,       nullptr    },
+  { TAG_FREE_FLASH,  TK_UINT, 4,                    TF_ALL,             0,              nullptr,       get_free_flash, nullptr,       nullptr    },
+  { TAG_LOG_COUNT,   TK_UINT, 2,                    TF_ALL,             0,              nullptr,       get_log_count,  nullptr,       nullptr    },
+  { TAG_ADR_SF,      TK_UINT, 1,                    TF_ALL,             0,              nullptr,       get_adr_sf,     nullptr,       nullptr    },
+};
+
+static constexpr size_t kTagCount = sizeof(kTags) / sizeof(kTags[0]);
+static constexpr size_t kTagSlots = 64;     // every table tag lives in 0x00..0x3F
+
+// Compile-time table checks (C++11 constexpr: recursion instead of loops).
+static constexpr bool tags_sorted(size_t k) {
+  return k + 1 >= kTagCount ||
+         (kTags[k].tag < kTags[k + 1].tag && kTags[k + 1].tag < kTagSlots && tags_sorted(k + 1));
+}
+static constexpr size_t blob_fields(size_t k) {
+  return k >= kTagCount ? 0 : ((kTags[k].flags & TF_NVS) ? kTags[k].width : 0) + blob_fields(k + 1);
+}
+static_assert(tags_sorted(0), "kTags must be sorted by tag and below kTagSlots");
+
+// tag -> row index + 1 (0 = unknown). O(1) lookup; filled once from kTags at boot.
+static uint8_t s_tag_slot[kTagSlots];
+
+static void build_tag_index() {
+  for (size_t k = 0; k < kTagCount; ++k) s_tag_slot[kTags[k].tag] = static_cast<uint8_t>(k + 1);
+}
+
+// find_tag() — descriptor for `tag`, or nullptr if this node does not know it.
+static const TagDesc* find_tag(uint8_t tag) {
+  if (tag >= kTagSlots || !s_tag_slot[tag]) return nullptr;
+  return &kTags[s_tag_slot[tag] - 1];
+}
+
+// Generation in which each row last changed (kTags order). RAM only: at boot every
+// row takes the persisted s_cfg_gen, so a delta GET_ALL from an older generation
+// returns all rows (safe) and one from the current generation returns none.
+static uint32_t s_tag_gen[kTagCount];
+
+// tag_read() — current numeric value (low `width` bytes are the wire value).
+static uint32_t tag_read(const TagDesc& d) {
+  if (d.get) return d.get();
+  switch (d.width) {
+    case 1:  return *static_cast<const uint8_t*>(d.ptr);
+    case 2:  return *static_cast<const uint16_t*>(d.ptr);
+    default: return *static_cast<const uint32_t*>(d.ptr);
+  }
+}
+
 
+// ============================================================================
+// Load / Save helpers
+// ============================================================================
 //
-// frame_begin()
-// -------------
-// Start a new outbound frame in the caller’s buffer.
+// Config is persisted as ONE packed blob under key "cfg" (version + CRC32),
+// so boot is a single NVS read and a commit is a single NVS write. Setters
+// mark per-field dirty bits only when a value actually changes; the commit is
+// deferred until the link has been quiet for kCommitQuietMs (or the oldest
+// change is kCommitMaxAgeMs old), so a burst of SET_PARAMs costs one write.
+// Re-applying identical values costs nothing.
 //
-// Process:
-//   1. Reset the write index `i` to 0 (fresh buffer).
-//   2. Write standard 4-byte header:
-//        [0] verb   — command type (GET_ID, SET_PARAM, etc.)
-//        [1] flags  — currently unused, set to 0
-//        [2] seq    — sequence number for matching responses
-//        [3] TLV_LEN— placeholder (0 for now, patched by frame_end())
-//   3. Caller will append TLVs starting at buf[4].
+// Blob image: [version][every TF_NVS row's storage in kTags order][crc32].
+// Numbers are stored in native (little-endian) order; strings are NUL-padded.
 //
-// Notes:
-//   - This does not allocate; caller must supply a buffer large enough.
-//   - `i` is passed by reference so the caller’s index advances in place.
+// The legacy one-key-per-field layout is still read once if no valid blob
+// exists; the next commit migrates it to "cfg". Newer versions only append
+// rows, so an older image is a valid prefix: its fields load and the rows it
+// lacks keep their defaults.
+
+static constexpr uint8_t  kCfgVersion     = 5;     // bump when the blob image changes
+static constexpr size_t   kBlobBytes      = 1 + blob_fields(0) + 4;
+static constexpr size_t   kBlobSizes[]    = { 0, 90, 91, 92, 93, 97 };   // by version: + TAG_SLEEP, + TAG_COMPRESS, + TAG_STORE, + TAG_CFG_GEN
+static constexpr uint32_t kCommitQuietMs  = 250;   // coalescing window after the last change
+static constexpr uint32_t kCommitMaxAgeMs = 2000;  // upper bound on unsaved exposure
+
+// Any change to persisted rows must bump kCfgVersion and append its size to kBlobSizes.
+static_assert(kCfgVersion + 1u == sizeof(kBlobSizes) / sizeof(kBlobSizes[0]), "kBlobSizes needs the new version");
+static_assert(kBlobBytes == kBlobSizes[kCfgVersion], "cfg blob layout changed: bump kCfgVersion");
+
+static uint16_t s_dirty          = 0;   // DirtyBit mask of fields changed since last commit
+static uint32_t s_dirty_first_ms = 0;   // millis() of the oldest pending change
+static uint32_t s_dirty_last_ms  = 0;   // millis() of the newest pending change
+
+// Setters run on the transport task, commits on the worker task. This lock
+// covers the dirty mask and the blob snapshot so a commit never clears a bit
+// for a change it did not capture.
+static portMUX_TYPE s_cfg_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// crc32() — plain reflected CRC-32 (poly 0xEDB88320). Boot/commit only, so
+// a bitwise loop beats carrying a 1 KB table in flash.
+static uint32_t crc32(const uint8_t* p, size_t n) {
+  uint32_t c = 0xFFFFFFFFu;
+  while (n--) {
+    c ^= *p++;
+    for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+  }
+  return ~c;
+}
 
-static inline void frame_begin(uint8_t verb, uint8_t seq, uint8_t* buf, size_t& i) {
-  i = 0;                 // reset write pointer to beginning of buffer
-  buf[i++] = verb;       // field 0: verb
-  buf[i++] = 0;          // field 1: flags (unused, always 0)
-  buf[i++] = seq;        // field 2: sequence number
-  buf[i++] = 0;          // field 3: TLV length placeholder (filled in later)
+// mark_dirty() — record which fields changed and when (starts/extends the window).
+static void mark_dirty(uint16_t bits) {
+  const uint32_t now = millis();
+  portENTER_CRITICAL(&s_cfg_mux);
+  if (!s_dirty) s_dirty_first_ms = now;
+  s_dirty |= bits;
+  s_dirty_last_ms = now;
+  portEXIT_CRITICAL(&s_cfg_mux);
+}
+
+// set_field() — assign only on change so identical writes never dirty NVS.
+template<typename T>
+static bool set_field(T& dst, T v, uint16_t bit) {
+  if (dst == v) return false;
+  dst = v;
+  mark_dirty(bit);
+  return true;
+}
+
+// set_string_field() — same as set_field() for fixed char buffers of `cap` bytes.
+static bool set_string_field(char* dst, size_t cap, const char* src, size_t n, uint16_t bit) {
+  char tmp[32] = {};
+  if (cap > sizeof(tmp)) cap = sizeof(tmp);
+  size_t copy = (n >= cap) ? (cap - 1) : n;                    // clamp, leave room for NUL
+  memcpy(tmp, src, copy);
+  if (strcmp(dst, tmp) == 0) return false;
+  memcpy(dst, tmp, cap);
+  mark_dirty(bit);
+  return true;
+}
+
+// tag_write() — store an already validated value into a writable row; true if it changed.
+static bool tag_write(const TagDesc& d, const uint8_t* p, uint8_t L) {
+  if (d.kind == TK_STR)
+    return set_string_field(static_cast<char*>(d.ptr), d.width, reinterpret_cast<const char*>(p), L, d.dirty);
+  uint32_t v = 0;
+  for (size_t j = 0; j < d.width; ++j) v |= static_cast<uint32_t>(p[j]) << (8 * j);
+  switch (d.width) {
+    case 1:  return set_field(*static_cast<uint8_t*>(d.ptr),  static_cast<uint8_t>(v),  d.dirty);
+    case 2:  return set_field(*static_cast<uint16_t*>(d.ptr), static_cast<uint16_t>(v), d.dirty);
+    default: return set_field(*static_cast<uint32_t*>(d.ptr), v,                        d.dirty);
+  }
+}
+
+// cfg_stamp() — row `d` just changed: open this request's generation (once per request,
+// via `opened`) and stamp the row with it. Re-marking the row dirty after the bump makes
+// sure a commit that raced the bump is followed by one carrying the new TAG_CFG_GEN.
+static void cfg_stamp(const TagDesc& d, bool& opened) {
+  if (!opened) { ++s_cfg_gen; opened = true; }
+  s_tag_gen[&d - kTags] = s_cfg_gen;
+  mark_dirty(d.dirty);
+}
+
+// blob_pack() — serialize every persisted row (caller holds s_cfg_mux).
+static void blob_pack(uint8_t (&img)[kBlobBytes]) {
+  size_t off = 0;
+  img[off++] = kCfgVersion;
+  for (size_t k = 0; k < kTagCount; ++k) {
+    const TagDesc& d = kTags[k];
+    if (!(d.flags & TF_NVS)) continue;
+    if (d.kind == TK_STR) {
+      const size_t n = strnlen(static_cast<const char*>(d.ptr), d.width - 1);
+      memcpy(img + off, d.ptr, n);
+      memset(img + off + n, 0, d.width - n);           // deterministic padding
+    } else {
+      memcpy(img + off, d.ptr, d.width);
+    }
+    off += d.width;
+  }
+}
+
+// blob_unpack() — accept an n-byte image only if its version, size and CRC
+// match (current, or an older version as a prefix), then load the rows it holds.
+static bool blob_unpack(const uint8_t* img, size_t n) {
+  uint32_t crc;
+  if (n < 5 || img[0] == 0 || img[0] > kCfgVersion || n != kBlobSizes[img[0]]) return false;
+  memcpy(&crc, img + n - 4, sizeof(crc));
+  if (crc != crc32(img, n - 4)) return false;
+  size_t off = 1;
+  for (size_t k = 0; k < kTagCount; ++k) {
+    const TagDesc& d = kTags[k];
+    if (!(d.flags & TF_NVS)) continue;
+    if (off + d.width > n - 4) break;                  // older image: the rest keep defaults
+    memcpy(d.ptr, img + off, d.width);
+    if (d.kind == TK_STR) static_cast<char*>(d.ptr)[d.width - 1] = '\0';
+    off += d.width;
+  }
+  return true;
 }
 
 //
-// tlv_put()
-// ---------
-// Append a TLV triplet at the current write index.
-// Caller supplies:
-//   - tag  : what the value means
-//   - p    : pointer to value bytes (may be nullptr if len == 0)
-//   - len  : number of bytes to copy
-//
-// Process:
-//   1) Write tag.
-//   2) Write len.
-//   3) If len > 0, memcpy value bytes and advance index.
-//
-// Assumptions / notes:
-//   - Caller guarantees `buf` has enough headroom (no bounds checks here).
-//   - `p` must point to at least `len` bytes when len > 0.
-//   - Use tlv_put_le<T>() for numeric types to ensure little-endian encoding.
-//   - memcpy() is correct here; the source never overlaps with destination.
-
-static inline void tlv_put(uint8_t* buf, size_t& i, uint8_t tag, const void* p, uint8_t len) {
-  buf[i++] = tag;                  // T
-  buf[i++] = len;                  // L
-  if (len) { memcpy(buf + i, p, len); i += len; }  // V (optional payload)
-}
-
-// tlv_put_le<T>()
-// ---------------
-// Serialize an integral value into little-endian byte order and append as a TLV.
-// Useful for numeric tags where the protocol standardizes on LE.
+// load_from_nvs()
+// ----------------
+// Pulls persisted configuration out of ESP32 NVS into our globals.
+// If NVS is unavailable, keep defaults in memory and exit quietly.
 //
 // Process:
-//   1) Create a fixed-size temp buffer for T's bytes.
-//   2) For each byte position j, extract the 8-bit slice (LSB first).
-//   3) Delegate to tlv_put() with the tag and serialized bytes.
+//   1. Attempt to open the "viatext" namespace in read/write mode.
+//   2. If open fails, leave defaults untouched.
+//   3. Read the "cfg" blob; accept it only if size, version and CRC match.
+//   4. Otherwise fall back to the legacy per-key layout (each row's `key`)
+//      and mark everything dirty so the next commit writes a fresh blob.
 //
-// Notes:
-//   - Works for any integral T (uint8_t, uint16_t, uint32_t, int8_t, etc.).
-//   - Little-endian means least-significant byte goes out first.
-//   - No dynamic allocation; temp buffer lives on the stack.
+static void load_from_nvs() {
+  // Phase 1: open NVS (read/write so we can later update too)
+  s_prefs_open = s_prefs.begin("viatext", /*readOnly=*/false);
+  if (!s_prefs_open) return;  // If open fails, don't touch defaults
 
-template<typename T>
-static inline void tlv_put_le(uint8_t* buf, size_t& i, uint8_t tag, T value) {
-  uint8_t tmp[sizeof(T)];                               // step 1: hold serialized bytes
-  for (size_t j = 0; j < sizeof(T); ++j)                // step 2: byte-wise extract
-    tmp[j] = (uint8_t)((value >> (8 * j)) & 0xFF);      //   take LSB first, then next...
-  tlv_put(buf, i, tag, tmp, sizeof(T));                 // step 3: append TLV triplet
+  s_nvs_free = s_prefs.freeEntries() * 32;   // 32-byte NVS entries
+
+  // Phase 2: packed blob (one read)
+  uint8_t img[kBlobBytes];
+  const size_t n = s_prefs.getBytesLength("cfg");
+  if (n <= sizeof(img) && s_prefs.getBytes("cfg", img, n) == n && blob_unpack(img, n)) {
+    if (n != kBlobBytes) mark_dirty(DIRTY_ALL);        // rewrite in the current layout
+    return;
+  }
+
+  // Phase 3: legacy per-key layout (defaults survive missing keys)
+  for (size_t k = 0; k < kTagCount; ++k) {
+    const TagDesc& d = kTags[k];
+    if (!(d.flags & TF_NVS) || !d.key) continue;              // rows newer than the legacy layout
+    if (d.kind == TK_STR) {
+      s_prefs.getString(d.key, static_cast<char*>(d.ptr), d.width);
+      continue;
+    }
+    switch (d.width) {
+      case 1: {
+        uint8_t& v = *static_cast<uint8_t*>(d.ptr);
+        v = (d.kind == TK_SINT) ? static_cast<uint8_t>(s_prefs.getChar(d.key, static_cast<int8_t>(v)))
+                                : s_prefs.getUChar(d.key, v);
+        break;
+      }
+      case 2: {
+        uint16_t& v = *static_cast<uint16_t*>(d.ptr);
+        v = s_prefs.getUShort(d.key, v);
+        break;
+      }
+      default: {
+        uint32_t& v = *static_cast<uint32_t*>(d.ptr);
+        v = s_prefs.getULong(d.key, v);
+        break;
+      }
+    }
+  }
+  mark_dirty(DIRTY_ALL);      // migrate to the blob on the first commit
 }
 
 
-// frame_end()
-// -----------
-// Close out a TLV frame by patching the payload length.
-// Up to now, we've been writing bytes into buf[] and bumping `i`.
-// The first 4 bytes of the header reserved byte [3] as a placeholder.
-// Here we overwrite buf[3] with the true payload length = (i - 4).
+//
+// save_to_nvs()
+// --------------
+// Commit pending changes to ESP32 NVS as one blob write.
+// Ensures persistence across resets/power cycles.
 //
 // Process:
-//   1. Take the current cursor `i` (index after last written byte).
-//   2. Subtract 4 (the header size).
-//   3. Store result as an unsigned 8-bit in header slot [3].
+//   1. Nothing dirty -> nothing to do (no flash wear).
+//   2. If NVS isn't open yet, try to open it now (read/write).
+//      If that fails, keep the dirty bits so a later attempt can retry.
+//   3. Under s_cfg_mux: pack the globals and take the dirty mask.
+//   4. Stamp CRC, write "cfg"; on failure put the taken bits back.
 //
 // Notes:
-//   - Max payload length is capped at 255 because field is uint8_t.
-//   - Caller must call this once after writing all TLVs.
-
-static inline void frame_end(uint8_t* buf, size_t& i) {
-  buf[3] = static_cast<uint8_t>(i - 4);  // length = total - header
-}
-
-// tlv_find() — scan TLV area for first matching tag; return pointer to value or nullptr.
-// Purpose: locate `tag` inside frame’s TLV block; set `out_len` to its value length.
-// Assumptions: 4-byte header present; frame[3] holds TLV payload length (set by frame_end()).
-// Invariants: never read past `len`; abort on malformed TLV.
-// Tradeoffs: returns only the first match; duplicates ignored.
-// Flow: header check -> TLV bounds check -> iterate TLVs -> return on match.
-
-static const uint8_t* tlv_find(const uint8_t* frame, size_t len, uint8_t tag, uint8_t& out_len) {
-  if (len < 4) return nullptr;                 // not enough bytes for header
-  size_t tlv_len = frame[3];                   // declared TLV section length (bytes after header)
-  if (4 + tlv_len > len) return nullptr;       // TLV block would overrun provided frame length
-
-  size_t off = 4, end = 4 + tlv_len;           // scan window: start right after header
-  while (off + 2 <= end) {                     // need at least tag(1)+len(1) available
-    uint8_t t = frame[off++];                  // read Tag
-    uint8_t L = frame[off++];                  // read Length
-    if (off + L > end) break;                  // malformed: value claims to run past TLV block
-    if (t == tag) {                            // match — hand back value pointer and length
-      out_len = L;
-      return frame + off;                      // value starts at current offset
-    }
-    off += L;                                  // skip over Value to next TLV
+//   - All globals are assumed valid by this point (validated earlier).
+//   - Called from the worker (commit_if_due) and node_interface_flush().
+//
+static void save_to_nvs() {
+  // Step 1: skip clean state
+  if (!s_dirty) return;
+
+  // Step 2: open storage if not already open
+  if (!s_prefs_open) {
+    s_prefs_open = s_prefs.begin("viatext", false);
+    if (!s_prefs_open) return;  // bail out if open fails
+  }
+
+  // Step 3: consistent snapshot
+  uint8_t img[kBlobBytes];
+  portENTER_CRITICAL(&s_cfg_mux);
+  blob_pack(img);
+  const uint16_t taken = s_dirty;
+  s_dirty = 0;
+  portEXIT_CRITICAL(&s_cfg_mux);
+
+  // Step 4: single write, retry later on failure
+  const uint32_t crc = crc32(img, kBlobBytes - 4);
+  memcpy(img + kBlobBytes - 4, &crc, sizeof(crc));
+  if (s_prefs.putBytes("cfg", img, sizeof(img)) != sizeof(img)) {
+    mark_dirty(taken);
+    node_log(LVL_ERROR, EV_NVS_FAIL, taken);
+    return;
   }
-  return nullptr;                              // not found (or bailed on malformed structure)
+  node_log(LVL_INFO, EV_NVS_COMMIT, taken);
+  s_nvs_free = s_prefs.freeEntries() * 32;
 }
 
+// Set by the transport task for the duration of a BATCH; commits wait for it.
+static volatile bool s_in_batch = false;
+
+// commit_if_due() — worker-side commit once the coalescing window has closed.
+static void commit_if_due() {
+  if (!s_dirty || s_in_batch) return;             // never write mid-batch
+  const uint32_t now = millis();
+  if ((now - s_dirty_last_ms) >= kCommitQuietMs || (now - s_dirty_first_ms) >= kCommitMaxAgeMs)
+    save_to_nvs();
+}
+
+// flush_on_shutdown() — esp_restart() hook so a reboot never loses a pending commit.
+static void flush_on_shutdown() {
+  save_to_nvs();
+}
+
+
+// ============================================================================
+// TLV helpers
+// ============================================================================
+//
+// Header form for frames built right now (see FLAG_LEN16 in node_protocol.hpp).
+// node_interface_on_packet() sets s_len16 to mirror each request; between
+// requests it falls back to s_host_len16, which latches once the host has
+// shown it understands the extended header. Transport task only.
+
+static bool s_len16      = false;
+static bool s_host_len16 = false;
+
+// frame_cap() — largest frame the current header form may produce.
+static inline size_t frame_cap() { return s_len16 ? kFrameMax : kFrameHdr + 255; }
+
+// Outbound frames are built with FrameWriter (node_frame.hpp): pooled buffer,
+// capacity checks, one-pass SLIP encode. Request bodies are read through
+// TlvView (node_tlv.hpp), which dispatch() validates once per frame.
+
 
 // tlv_read_le<T>() — decode a little-endian integer from raw bytes into `out`.
 // Purpose: read `len` bytes at `p` as a little-endian value of type T.
@@ -331,195 +663,267 @@ static bool tlv_read_le(const uint8_t* p, uint8_t len, T& out) {
 
 
 // ============================================================================
-// RESP helpers
+// Reply routing (BATCH aggregation)
 // ============================================================================
-
-// send_resp_err() — minimal RESP_ERR builder/sender.
-// Purpose: emit an empty error response tied to `seq`.
-// Assumptions: caller decided this operation failed; no TLVs are attached.
-// Invariants: header is 4 bytes; TLV length is zero; buffer is stack-local.
-// Flow: allocate small buffer -> write header -> finalize length -> send.
-
-static void send_resp_err(uint8_t seq) {
-  uint8_t b[8]; size_t i;                  // tiny scratch buffer + cursor
-  frame_begin(Verb::RESP_ERR, seq, b, i);  // header: verb=ERR, seq=caller
-  frame_end(b, i);                          // TLV length = i-4 (here: 0)
-  protocol_send(b, i);                      // hand off to transport
+//
+// Responders call reply() rather than protocol_send(). Outside a batch the
+// two are identical. Inside one, each sub-response is appended to
+// s_batch_out; the aggregate is sent when the next sub-response would not
+// fit (with FLAG_MORE) and once more when the batch ends. Unsolicited frames
+// (hello, radio RX) bypass this and go straight to protocol_send().
+
+static uint8_t s_batch_out[kFrameMax]; // aggregate under construction (header + sub-responses)
+static size_t  s_batch_i     = 0;     // write cursor into s_batch_out
+static size_t  s_batch_hdr   = 4;     // aggregate header size (mirrors the BATCH request)
+static size_t  s_batch_cap   = 0;     // aggregate size limit for that header form
+static bool    s_batch_radio = false; // a sub-frame changed modem params; apply once at the end
+
+// batch_flush() — send the aggregate built so far and reset for the next one.
+static void batch_flush(uint8_t flags) {
+  const size_t n = s_batch_i - s_batch_hdr;
+  s_batch_out[1] = flags | node_msgq_flags() | (s_batch_hdr == kFrameHdr16 ? FLAG_LEN16 : 0);
+  s_batch_out[3] = static_cast<uint8_t>(n);
+  if (s_batch_hdr == kFrameHdr16) s_batch_out[4] = static_cast<uint8_t>(n >> 8);
+  node_replay_record(s_batch_out, s_batch_i);
+  protocol_send(s_batch_out, s_batch_i);
+  s_batch_i = s_batch_hdr;
 }
 
+// reply() — deliver one finished response directly or into the current batch.
+// A writer that ran out of room is never shipped short: it becomes RESP_ERR.
+static void reply(FrameWriter& w) {
+  if (!w.valid()) return;
+  if (w.truncated()) {
+    node_log(LVL_WARN, EV_TX_TRUNC, w.finish()[0], w.seq());
+    node_stats_error(ERR_REPLY_FULL);
+    w.restart(Verb::RESP_ERR);
+  }
+  w.set_flags(node_msgq_flags());                           // outbound backpressure on every reply
+  if (!s_in_batch) { node_replay_record(w.finish(), w.size()); w.send(); return; }
+  const uint8_t* b = w.finish();
+  size_t n = w.size();
+  if (n > s_batch_cap - s_batch_hdr) {                      // can never fit: degrade to an error
+    node_stats_error(ERR_REPLY_FULL);
+    w.restart(Verb::RESP_ERR);
+    w.set_flags(node_msgq_flags());
+    b = w.finish(); n = w.size();
+  }
+  if (s_batch_i + n > s_batch_cap) batch_flush(FLAG_MORE);
+  memcpy(s_batch_out + s_batch_i, b, n);
+  s_batch_i += n;
+}
 
-// send_tag_value() — append one TLV for `tag` using current in-memory state.
-// Purpose: serialize a single tag into buf at cursor `i` (TLV: tag,len,value).
-// Assumptions: caller began a frame (header already written) and `buf` has room.
-// Invariants: numeric values encoded little-endian via tlv_put_le<>; strings are raw bytes.
-// Tradeoffs: silently ignore unknown tags (forward-compatible on the wire).
-// Flow: switch(tag) -> compute/copy source value -> tlv_put/tlv_put_le -> advance `i`.
-
-static void send_tag_value(uint8_t* buf, size_t& i, uint8_t tag) {
-  // switch: one branch per protocol tag to keep it grep-friendly and explicit.
-  switch (tag) {
-
-    // Identity/System: Node ID string (no NUL inside the TLV).
-    case TAG_ID: {
-      uint8_t L = (uint8_t)strnlen(s_id, sizeof(s_id));
-      tlv_put(buf, i, TAG_ID, s_id, L);
-      break;
-    }
-
-    // Identity/System: human-friendly alias (len may be 0).
-    case TAG_ALIAS: {
-      uint8_t L = (uint8_t)strnlen(s_alias, sizeof(s_alias));
-      tlv_put(buf, i, TAG_ALIAS, s_alias, L);
-      break;
-    }
-
-    // Identity/System: firmware version string (tie to build macro later).
-    case TAG_FW_VERSION: {
-      const char* ver = "1.0.0"; // TODO: tie to build version macro if available
-      tlv_put(buf, i, tag, ver, (uint8_t)strlen(ver));
-      break;
-    }
 
-    // Identity/System: uptime in seconds (derived from millis()).
-    case TAG_UPTIME_S: {
-      uint32_t uptime = millis() / 1000;
-      tlv_put_le<uint32_t>(buf, i, tag, uptime);
-      break;
-    }
+// ============================================================================
+// RESP helpers
+// ============================================================================
 
-    // Identity/System: boot epoch if available (stubbed to 0 for now).
-    case TAG_BOOT_TIME: {
-      uint32_t boot_time = 0; // TODO: real epoch from RTC if available
-      tlv_put_le<uint32_t>(buf, i, tag, boot_time);
-      break;
-    }
+// send_resp_err() — minimal RESP_ERR builder/sender.
+// Purpose: emit an empty error response tied to `seq`, counted under `why`.
+// Assumptions: caller decided this operation failed; no TLVs are attached.
+// Invariants: header mirrors the request form; TLV length is zero; buffer is pooled.
+// Flow: count reason -> borrow writer -> header only -> reply().
 
-    // Radio: RF center frequency in Hz (LE u32).
-    case TAG_FREQ_HZ: {
-      tlv_put_le<uint32_t>(buf, i, tag, s_freq_hz);
-      break;
-    }
+static void send_resp_err(uint8_t seq, ErrReason why) {
+  node_stats_error(why);
+  FrameWriter w(Verb::RESP_ERR, seq, s_len16);  // header: verb=ERR, seq=caller
+  reply(w);                                     // direct, or into the current batch
+}
 
-    // Radio: LoRa spreading factor (7..12).
-    case TAG_SF: {
-      tlv_put_le<uint8_t>(buf, i, tag, s_sf);
-      break;
-    }
 
-    // Radio: RF bandwidth in Hz (LE u32).
-    case TAG_BW_HZ: {
-      tlv_put_le<uint32_t>(buf, i, tag, s_bw_hz);
-      break;
-    }
+// tag_put() — append one row's current value as a TLV.
+// Purpose: the single encoder behind GET_PARAM, GET_ALL, SET_PARAM echoes and hellos.
+// Assumptions: caller holds an open writer; overflow is tracked by the writer.
+// Invariants: numbers are `width` bytes little-endian; strings are raw bytes, no NUL.
+// Flow: string -> bounded length + copy; number -> tag_read() -> LE bytes -> w.tlv().
 
-    // Radio: LoRa coding rate code (5..8 -> 4/5..4/8).
-    case TAG_CR: {
-      tlv_put_le<uint8_t>(buf, i, tag, s_cr);
-      break;
-    }
+static void tag_put(FrameWriter& w, const TagDesc& d) {
+  if (d.kind == TK_STR) {
+    const char* s = static_cast<const char*>(d.ptr);
+    w.tlv(d.tag, s, strnlen(s, d.width));
+    return;
+  }
+  const uint32_t v = tag_read(d);
+  uint8_t tmp[4];
+  for (size_t j = 0; j < d.width; ++j) tmp[j] = static_cast<uint8_t>(v >> (8 * j));
+  w.tlv(d.tag, tmp, d.width);
+}
 
-    // Radio: TX power in dBm (signed 8-bit).
-    case TAG_TX_PWR_DBM: {
-      tlv_put_le<int8_t>(buf, i, tag, s_tx_pwr);
-      break;
-    }
+// send_tag_value() — append one TLV for `tag` using current in-memory state.
+// Purpose: serialize a single tag into the writer (TLV: tag,len,value).
+// Assumptions: caller holds an open writer.
+// Tradeoffs: silently ignore unknown tags (forward-compatible on the wire).
+// Flow: O(1) descriptor lookup -> tag_put().
 
-    // Radio: logical channel index.
-    case TAG_CHAN: {
-      tlv_put_le<uint8_t>(buf, i, tag, s_chan);
-      break;
-    }
+static void send_tag_value(FrameWriter& w, uint8_t tag) {
+  if (const TagDesc* d = find_tag(tag)) tag_put(w, *d);
+}
 
-    // Behavior/Routing: node mode (implementation-defined).
-    case TAG_MODE: {
-      tlv_put_le<uint8_t>(buf, i, tag, s_mode);
-      break;
-    }
+// tag_check() — would SET_PARAM accept this TLV? No side effects.
+// Unknown and read-only tags are accepted and later ignored (forward-compatible).
+
+static bool tag_check(uint8_t tag, const uint8_t* p, uint8_t L) {
+  const TagDesc* d = find_tag(tag);
+  if (!d || !(d->flags & TF_RW)) return true;
+  if (d->kind == TK_STR) return true;                       // clamped on write
+  if (L != d->width) return false;                          // exact width required
+  uint32_t v = 0;
+  for (size_t j = 0; j < L; ++j) v |= static_cast<uint32_t>(p[j]) << (8 * j);
+  return !d->valid || d->valid(v);
+}
 
-    // Behavior/Routing: maximum hop count permitted.
-    case TAG_HOPS: {
-      tlv_put_le<uint8_t>(buf, i, tag, s_hops);
-      break;
-    }
 
-    // Behavior/Routing: beacon interval in seconds (0 disables).
-    case TAG_BEACON_SEC: {
-      tlv_put_le<uint32_t>(buf, i, tag, s_beacon_s);
-      break;
-    }
 
-    // Behavior/Routing: TX buffer/queue size.
-    case TAG_BUF_SIZE: {
-      tlv_put_le<uint16_t>(buf, i, tag, s_buf_size);
-      break;
-    }
+// node_interface_begin() — bring in persisted settings at boot.
+// Purpose: hydrate in-memory state from NVS (or keep defaults if NVS fails).
+// Assumptions: NVS namespace/key names match load_from_nvs() expectations.
+// Invariants: safe to call once at boot; leaves globals consistent on failure.
+// Flow: log boot -> index tags -> call loader -> register reboot flush -> start radio.
 
-    // Behavior/Routing: ACK mode (0 or 1).
-    case TAG_ACK_MODE: {
-      tlv_put_le<uint8_t>(buf, i, tag, s_ack_mode);
-      break;
-    }
+void node_interface_begin() {
+  node_log(LVL_INFO, EV_BOOT, static_cast<uint32_t>(esp_reset_reason()));
+  build_tag_index();
+  load_from_nvs();
+  for (size_t k = 0; k < kTagCount; ++k) s_tag_gen[k] = s_cfg_gen;   // per-row history starts here
+  node_msgq_set_capacity(s_buf_size);                             // legacy out-of-range values clamp
+  node_link_set_addr(s_id);                                       // air address follows the ID
+  node_link_set_route(s_mode == 0, s_hops);                       // TAG_MODE 0 = relay
+  esp_register_shutdown_handler(&flush_on_shutdown);              // esp_restart() commits first
+  node_radio_begin(radio_config());
+  node_link_configure(radio_config());
+  node_adr_configure(s_sf);
+  node_sense_begin();
+  node_store_begin();
+  node_link_on_fail(&store_failed);
+  beacon_apply();
+  node_power_set_mode(s_sleep);
+  node_link_set_pack(s_compress == 1);
+}
 
-    // Diagnostics: placeholder RSSI dBm (wire up real metric later).
-    case TAG_RSSI_DBM: {
-      tlv_put_le<int16_t>(buf, i, tag, -42);
-      break;
-    }
+// node_interface_flush() — force any pending config commit now.
+// Purpose: callers about to reset or cut power must not lose a deferred write.
+// Invariants: no NVS traffic when nothing is dirty.
 
-    // Diagnostics: placeholder SNR dB (wire up real metric later).
-    case TAG_SNR_DB: {
-      tlv_put_le<int8_t>(buf, i, tag, 7);
-      break;
-    }
+void node_interface_flush() {
+  save_to_nvs();
+}
 
-    // Diagnostics: placeholder battery millivolts (ADC later).
-    case TAG_VBAT_MV: {
-      tlv_put_le<uint16_t>(buf, i, tag, 3700);
-      break;
-    }
+// node_interface_service() — slow upkeep on the worker task.
+// Purpose: commit coalesced config writes without stalling the transport task.
+// Invariants: no NVS traffic unless something is dirty and its window has closed.
 
-    // Diagnostics: placeholder temperature in deci-deg C.
-    case TAG_TEMP_C10: {
-      tlv_put_le<int16_t>(buf, i, tag, 215);
-      break;
-    }
+void node_interface_service() {
+  commit_if_due();
+}
 
-    // Diagnostics: placeholder free heap bytes.
-    case TAG_FREE_MEM: {
-      tlv_put_le<uint32_t>(buf, i, tag, 123456);
-      break;
-    }
+bool node_interface_idle() {
+  return s_dirty == 0;
+}
 
-    // Diagnostics: placeholder free flash/storage bytes.
-    case TAG_FREE_FLASH: {
-      tlv_put_le<uint32_t>(buf, i, tag, 654321);
-      break;
-    }
+// pump_outbound() — hand queued outbound messages to the link layer while it can take them.
+// A sent slot belongs to node_link from then on: unqueue it, do not free it. One that can
+// never be sent is unqueued first and then freed, so the queue never sees a freed slot.
+static void pump_outbound() {
+  while (Msg* m = node_msgq_peek(MQ_OUT)) {
+    const LinkSend r = node_link_send(*m,s_ack_mode==1);
+    if (r==SEND_BUSY) break;                                     // TX ring / retx table full: next pass
+    Msg* const own = node_msgq_detach(MQ_OUT);
+    if (r==SEND_DROP) node_msgq_free(own);
+  }
+}
 
-    // Diagnostics: placeholder log entry count.
-    case TAG_LOG_COUNT: {
-      tlv_put_le<uint16_t>(buf, i, tag, 0);
-      break;
-    }
+// Slots out of both queues at once: RX loans, unreliable sends the radio still reads,
+// reliable ones awaiting an ACK, plus one MSG and one store replay being filled.
+static_assert(kRadioRxSlots + kRadioTxSlots + kRetxSlots + 2 <= kMsgLoanMax, "node_msgq pool too small for its loans");
 
-    // Unknown tag: emit nothing; safe no-op for forward compatibility.
-    default: {
-      // Unknown tag — ignore silently
-      break;
-    }
+// lend_rx() — keep the radio supplied with empty pool slots to burst RX packets into.
+static void lend_rx() {
+  while (node_radio_wants_rx()) {
+    Msg* m = node_msgq_alloc();
+    if (!m) return;                                              // pool dry: the radio drops and counts
+    node_radio_lend_rx(m->buf,m);
   }
 }
 
+// send_in_place() — MSG to the host straight from its slot: the frame header goes into
+// the headroom in front of the payload, so nothing is copied before the SLIP encoder.
+static void send_in_place(Msg& m) {
+  const size_t hdr = s_len16 ? kFrameHdr16 : kFrameHdr;
+  static_assert(kFrameHdr16 <= kMsgHeadroom, "a host header must fit the headroom");
+  uint8_t* f = m.data() - hdr;
+  f[0] = Verb::MSG;
+  f[1] = node_msgq_flags() | (s_len16 ? FLAG_LEN16 : 0);
+  f[2] = 0;                                                      // unsolicited
+  f[3] = m.len;
+  if (s_len16) f[4] = 0;
+  protocol_send(f, hdr + m.len);
+}
 
+// send_link_events() — report reliable-send outcomes as unsolicited MSG_STATUS frames.
+static void send_link_events() {
+  LinkEvent ev;
+  while (node_link_poll(ev)) {
+    FrameWriter w(Verb::MSG_STATUS,0,s_len16);
+    w.tlv_le<uint16_t>(TAG_MSG_ID,ev.id);
+    w.tlv_le<uint8_t>(TAG_MSG_STATUS,ev.status);
+    w.tlv_le<uint8_t>(TAG_MSG_TRIES,ev.tries);
+    w.set_flags(node_msgq_flags());
+    w.send();
+  }
+}
 
-// node_interface_begin() — bring in persisted settings at boot.
-// Purpose: hydrate in-memory state from NVS (or keep defaults if NVS fails).
-// Assumptions: NVS namespace/key names match load_from_nvs() expectations.
-// Invariants: safe to call once at boot; leaves globals consistent on failure.
-// Flow: call loader -> return (no I/O side effects here).
+// send_stored_inbound() — forward the oldest air message kept while the host was away.
+static bool send_stored_inbound() {
+  static Msg m;                                                  // static: off the task stack
+  if (!node_store_peek(STORE_IN,m)) return false;
+  FrameWriter w(Verb::MSG,0,s_len16);
+  w.raw(m.data(),m.len);
+  w.set_flags(node_msgq_flags());
+  w.send();
+  node_store_pop(STORE_IN);
+  return true;
+}
 
-void node_interface_begin() {
-  load_from_nvs();
+// node_interface_update() — move queued traffic between host, queues, and radio.
+// Purpose: forward radio RX from the transport task; UI pushes happen on the worker.
+// Assumptions: single consumer of node_radio_receive(); called every transport pass.
+// Invariants: at most one message to the host per call so the SLIP pump keeps its share
+//             of time; the radio RX ring is always emptied into the inbound queue.
+// Flow: retransmit timers -> outbound queue -> link/TX ring; RX ring -> link (ACKs,
+//       duplicates) -> inbound queue; delivery outcomes -> host; stored MSGs -> outbound
+//       queue once the air answers; stored inbound first, else oldest inbound ->
+//       stash as last text -> request display -> forward as MSG (seq=0), or to the
+//       store while the host is away.
+// Buffers: RX packets arrive in pool slots lent to the radio and stay in them, queue
+//          and all, until the SLIP encoder has read them (node_msgq.hpp, Ownership).
+
+void node_interface_update() {
+  RadioPacket pkt;
+  node_link_service();
+  pump_outbound();
+  lend_rx();
+  while (node_radio_receive(pkt)) {
+    node_log(LVL_INFO, EV_RADIO_RX, pkt.len,
+             static_cast<uint16_t>(pkt.rssi_dbm) | (static_cast<uint32_t>(static_cast<uint8_t>(pkt.snr_db)) << 16));
+    Msg* in = static_cast<Msg*>(pkt.owner);
+    if (node_link_receive(pkt,*in)) node_msgq_commit(MQ_IN,in); // full: evicts oldest chat (counted)
+    else node_msgq_free(in);                                     // ACK, beacon, duplicate, relay-only
+  }
+  lend_rx();
+  send_link_events();
+  replay_outbound();
+
+  const bool away = node_protocol_idle_ms() >= kHostAwayMs;
+  if (!away && send_stored_inbound()) return;                    // older than anything queued
+  Msg* m = node_msgq_detach(MQ_IN);
+  if (!m) return;
+  size_t copy=(m->len>=sizeof(s_last_text))?(sizeof(s_last_text)-1):m->len;
+  memcpy(s_last_text,m->data(),copy); s_last_text[copy]='\0';     // UI stash (display is another task)
+  if (node_display_available())
+    node_display_draw_message("< ", s_last_text);                  // scrollback; worker pushes
+  if (!(away && s_store==1 && node_store_put(STORE_IN,*m)))      // host gone: keep it in flash
+    send_in_place(*m);                                           // unsolicited MSG (seq=0), raw payload
+  node_msgq_free(m);
 }
 
 // node_interface_id() — expose current node ID buffer.
@@ -536,10 +940,10 @@ const char* node_interface_id() { return s_id; }
 // Flow: begin frame -> add TAG_ID -> finalize length -> send.
 
 void node_interface_send_hello() { 
-  uint8_t b[64]; size_t i; frame_begin(Verb::RESP_OK,0,b,i);  // fresh header, seq=0 marks unsolicited
-  send_tag_value(b,i,TAG_ID);                                 // include current ID as TLV payload
-  frame_end(b,i);                                             // patch TLV length (i - 4)
-  protocol_send(b,i);                                         // hand off to transport layer
+  FrameWriter w(Verb::RESP_OK,0,s_len16);                     // fresh header, seq=0 marks unsolicited
+  send_tag_value(w,TAG_ID);                                   // include current ID as TLV payload
+  w.set_flags(node_msgq_flags());                             // queue state, as on every frame
+  w.send();                                                   // patch length, SLIP-encode, write
 }
 
 // Return the most recent text payload seen by this node.
@@ -551,20 +955,201 @@ const char* node_interface_last_text() {
 }
 
 
-// node_interface_on_packet() — central verb/TLV dispatcher for one complete frame.
-// Purpose: decode the inner frame (verb + TLV area), mutate local state, and emit a response.
-// Assumptions: transport already delivered a full inner frame (not SLIP bytes). Header is 4 bytes.
-// Invariants: never read past `len`; unknown/invalid inputs yield RESP_ERR but never crash.
-// Tradeoffs: fast, linear parsing with minimal copying; unknown tags ignored for forward-compat.
-// Flow: guard -> extract verb/seq -> switch(verb) -> per-verb handling -> RESP_OK/RESP_ERR.
+// ============================================================================
+// Subscriptions (SUBSCRIBE)
+// ============================================================================
+//
+// The host names up to kSubTagsMax tags. A transport-task timer compares the
+// watched ones with the values last reported every kSubCheckMs and sends a
+// report (unsolicited RESP_OK, TAG_SUB_SEQ first) when one has moved by its
+// threshold or the period has run out. Each report restarts the period and
+// becomes the new baseline. Kept in RAM only: a reboot cancels it.
+
+static constexpr size_t   kSubTagsMax = 16;       // longest report (ID, alias, FW + 13 u32) fits 255 bytes
+static constexpr uint32_t kSubCheckMs = 1000;     // change check cadence = fastest report rate
+
+struct SubTag {
+  uint8_t  row;                                   // kTags index
+  bool     watch;                                 // report when |value - last| reaches delta
+  uint32_t delta;                                 // 0 = any change
+  uint32_t last;                                  // value in the last report (wire form)
+};
+
+static SubTag   s_sub[kSubTagsMax];
+static size_t   s_sub_n         = 0;
+static uint32_t s_sub_period_ms = 0;              // 0 = changes only
+static uint32_t s_sub_last_ms   = 0;              // millis() of the last report (or the SUBSCRIBE)
+static uint16_t s_sub_seq       = 0;              // reports sent since SUBSCRIBE
+static SchedId  s_sub_timer     = -1;             // SCHED_XPORT; stopped while nothing is subscribed
+
+// tag_signed() — wire value `v` of numeric row `d`, sign-extended for TK_SINT rows.
+static int64_t tag_signed(const TagDesc& d, uint32_t v) {
+  if (d.kind != TK_SINT) return v;
+  const unsigned shift = 32 - 8 * d.width;
+  return static_cast<int32_t>(v << shift) >> shift;             // arithmetic shift on GCC
+}
+
+// sub_put() — append every subscribed tag and take the values as the new baseline.
+static void sub_put(FrameWriter& w) {
+  for (size_t k = 0; k < s_sub_n; ++k) {
+    const TagDesc& d = kTags[s_sub[k].row];
+    tag_put(w, d);
+    if (d.kind != TK_STR) s_sub[k].last = tag_read(d);
+  }
+}
+
+// sub_check() — timer callback: report when a watched tag moved or the period ran out.
+static void sub_check() {
+  const uint32_t now = millis();
+  bool due = s_sub_period_ms && now - s_sub_last_ms >= s_sub_period_ms;
+  for (size_t k = 0; k < s_sub_n && !due; ++k) {
+    const SubTag& t = s_sub[k];
+    if (!t.watch) continue;
+    const TagDesc& d = kTags[t.row];
+    int64_t diff = tag_signed(d, tag_read(d)) - tag_signed(d, t.last);
+    if (diff < 0) diff = -diff;
+    due = diff != 0 && diff >= t.delta;
+  }
+  if (!due) return;
+  FrameWriter w(Verb::RESP_OK,0,s_len16);                     // seq=0: unsolicited
+  w.tlv_le<uint16_t>(TAG_SUB_SEQ,++s_sub_seq);
+  sub_put(w);
+  w.set_flags(node_msgq_flags());
+  w.send();
+  s_sub_last_ms = now;
+}
+
+// sub_apply() — run the check timer while anything is subscribed.
+static void sub_apply() {
+  if (s_sub_timer < 0) s_sub_timer = node_sched_add(SCHED_XPORT, sub_check);
+  if (s_sub_n == 0) node_sched_stop(s_sub_timer);
+  else node_sched_start(s_sub_timer, kSubCheckMs, kSubCheckMs);
+}
+
+
+// handle_batch() — run the sub-frames of a BATCH in order, replies aggregated.
+// Purpose: amortize SLIP framing and USB turnaround over many small requests.
+// Assumptions: called from node_interface_on_packet() on the transport task.
+// Invariants: a structurally malformed batch executes nothing; no NVS commit or
+//             modem reconfigure happens until the last sub-frame has run.
+// Flow: validate sub-frame bounds -> open aggregate -> dispatch each -> close,
+//       restart the commit quiet window, apply radio changes once.
+
+static void handle_batch(const uint8_t* frame, size_t len, uint8_t seq) {
+  const size_t start = frame_hdr_len(frame);
+  const size_t end   = start + frame_body_len(frame);
+
+  // Phase 1: structure check (body within the frame, every header present,
+  // every sub-body in bounds). The dispatcher already refuses end > len;
+  // this keeps the walk below safe on its own.
+  if (end > len) { send_resp_err(seq, ERR_TRUNCATED); return; }
+  for (size_t off = start; off < end; ) {
+    if (off + kFrameHdr > end || off + frame_hdr_len(frame + off) > end) { send_resp_err(seq, ERR_BATCH); return; }
+    const size_t sub = frame_hdr_len(frame + off) + frame_body_len(frame + off);
+    if (off + sub > end) { send_resp_err(seq, ERR_BATCH); return; }
+    off += sub;
+  }
+
+  // Phase 2: execute in order, replies collected by reply()
+  s_batch_hdr    = start;                                  // aggregate mirrors the request's form
+  s_batch_cap    = frame_cap();
+  s_batch_out[0] = Verb::BATCH; s_batch_out[2] = seq; s_batch_i = s_batch_hdr;
+  s_batch_radio  = false;
+  s_in_batch     = true;
+  for (size_t off = start; off < end; ) {
+    const uint8_t* sub = frame + off;
+    const size_t   n   = frame_hdr_len(sub) + frame_body_len(sub);
+    off += n;
+    if (sub[0] == Verb::BATCH) { send_resp_err(sub[2], ERR_BATCH); continue; }   // no nesting
+    node_interface_on_packet(sub, n);
+  }
+  s_in_batch = false;
+
+  // Phase 3: final aggregate, then the deferred side effects
+  batch_flush(0);
+  const uint32_t now = millis();
+  portENTER_CRITICAL(&s_cfg_mux);
+  if (s_dirty) s_dirty_last_ms = now;                                 // quiet window starts now
+  portEXIT_CRITICAL(&s_cfg_mux);
+  if (s_batch_radio) radio_apply();
+}
+
+
+// changes_state() — verbs whose repeat is not harmless; their replies go to node_replay.
+// Reads are cheap and idempotent, and a retry should see current values, so they always run.
+
+static bool changes_state(uint8_t verb) {
+  return verb == Verb::SET_ID || verb == Verb::SET_PARAM || verb == Verb::MSG ||
+         verb == Verb::BATCH  || verb == Verb::SET_BAUD  || verb == Verb::SUBSCRIBE;
+}
+
+
+// node_interface_on_packet() — public entry for one complete inner frame.
+// Purpose: validate the header, pick the reply header form, then dispatch.
+// Assumptions: transport already delivered a full inner frame (not SLIP bytes).
+// Invariants: replies mirror the request's header form; the unsolicited form
+//             only becomes extended once the host has used it (s_host_len16);
+//             a retransmitted request is answered, never executed twice.
+// Flow: guard -> replay check -> select header form -> dispatch() (timed for
+//       node_stats, reply recorded) -> restore form.
+
+static void dispatch(const uint8_t* frame, size_t len);
 
 void node_interface_on_packet(const uint8_t* frame, size_t len) {
-  // Guard: require a non-null buffer and at least header bytes.
-  if (!frame || len < 4) return;
+  // Guard: require a non-null buffer and a complete header.
+  if (!frame || len < kFrameHdr || len < frame_hdr_len(frame)) return;
+
+  // Retries: only whole requests are recorded; BATCH sub-frames ride on their batch.
+  const bool record = !s_in_batch && changes_state(frame[0]);
+  if (record && node_replay_find(node_protocol_link(), frame, len, node_msgq_flags())) return;
+  if (record) node_replay_begin(node_protocol_link(), frame, len);
+
+  const bool outer = s_len16;                                  // nested under a BATCH?
+  s_len16 = (frame[1] & FLAG_LEN16) != 0;
+  if (s_len16) s_host_len16 = true;
+  const uint32_t c0 = ESP.getCycleCount();                     // per-core; handlers stay on vt_xport
+  if (frame_hdr_len(frame) + frame_body_len(frame) > len) send_resp_err(frame[2], ERR_TRUNCATED);  // body truncated
+  else dispatch(frame, len);
+  node_stats_handled(frame[0], ESP.getCycleCount() - c0);
+  s_len16 = s_in_batch ? outer : s_host_len16;
+  if (record) node_replay_end();
+}
+
 
-  // Extract verb and sequence early; used by all responder branches.
+// dispatch() — central verb/TLV dispatcher for one complete frame.
+// Purpose: decode the inner frame (verb + TLV area), mutate local state, and emit a response.
+// Assumptions: header and declared body are both within `len` (checked by the caller).
+// Invariants: never read past `len`; unknown/invalid inputs yield RESP_ERR but never crash;
+//             a TLV verb with a malformed body is refused before any handler runs.
+// Tradeoffs: one validating pass per frame (TlvView), then O(1) lookups; unknown tags
+//            ignored for forward-compat.
+// Flow: extract verb/seq/body window -> validate TLVs -> switch(verb) -> per-verb
+//       handling -> RESP_OK/RESP_ERR.
+
+// has_tlv_body() — verbs whose body is a TLV list (MSG carries raw text, BATCH sub-frames,
+// GET_ID/PING ignore theirs).
+
+static bool has_tlv_body(uint8_t verb) {
+  return verb == Verb::SET_ID  || verb == Verb::GET_PARAM || verb == Verb::SET_PARAM ||
+         verb == Verb::GET_LOG || verb == Verb::GET_STATS || verb == Verb::BENCH     ||
+         verb == Verb::SET_BAUD || verb == Verb::SUBSCRIBE || verb == Verb::GET_ALL;
+}
+
+static void dispatch(const uint8_t* frame, size_t len) {
+  // Extract verb, sequence and body window early; used by all responder branches.
   const uint8_t verb = frame[0];
   const uint8_t seq  = frame[2];
+  const size_t  body = frame_hdr_len(frame);                  // first body byte
+  const size_t  blen = frame_body_len(frame);                 // declared body bytes
+
+  // One walk validates and indexes the body; handlers below read it without bounds math.
+  const bool    tlv_body = has_tlv_body(verb);
+  const TlvView tlv(frame, tlv_body ? len : 0);
+  if (tlv_body && !tlv.ok()) {
+    node_log(LVL_WARN, EV_SET_REJECT, verb, 0);
+    send_resp_err(seq, ERR_INVALID);
+    return;
+  }
 
   // Dispatch by verb. Keep branches short and explicit for debuggability.
   switch (verb) {
@@ -572,24 +1157,28 @@ void node_interface_on_packet(const uint8_t* frame, size_t len) {
     // Simple query path: echo ID for presence/health checks.
     case Verb::GET_ID:
     case Verb::PING:
-      { uint8_t b[64]; size_t i; frame_begin(Verb::RESP_OK,seq,b,i);  // start RESP_OK
-        send_tag_value(b,i,TAG_ID);                                   // add ID TLV
-        frame_end(b,i); protocol_send(b,i);                           // finalize + send
+      { FrameWriter w(Verb::RESP_OK,seq,s_len16);                     // start RESP_OK
+        send_tag_value(w,TAG_ID);                                     // add ID TLV
+        reply(w);                                                     // finalize + send
       }
       break;
 
     // Mutate identity: validate incoming TAG_ID, persist, update display, ack, then announce.
     case Verb::SET_ID: {
-      uint8_t L=0; const uint8_t* p = tlv_find(frame,len,TAG_ID,L);   // locate TAG_ID TLV
-      if (!p||L==0) { send_resp_err(seq); break; }                    // must have a non-empty value
+      uint8_t L=0; const uint8_t* p = tlv.find(TAG_ID,L);             // locate TAG_ID TLV
+      if (!p||L==0) { send_resp_err(seq,ERR_INVALID); break; }        // must have a non-empty value
       char tmp[sizeof(s_id)]; size_t copy = (L>=sizeof(tmp))?(sizeof(tmp)-1):L;  // clamp length
       memcpy(tmp,p,copy); tmp[copy]='\0';                              // make a safe C-string
-      if (!is_valid_id(tmp)) { send_resp_err(seq); break; }            // enforce charset/length policy
-      strncpy(s_id,tmp,sizeof(s_id)); save_to_nvs();                   // commit new ID to RAM+NVS
-      node_display_draw_id(s_id);                                      // nudge UI if present
-      { uint8_t b[64]; size_t i; frame_begin(Verb::RESP_OK,seq,b,i);   // ack with the new ID
-        send_tag_value(b,i,TAG_ID);
-        frame_end(b,i); protocol_send(b,i);
+      if (!is_valid_id(tmp)) { send_resp_err(seq,ERR_INVALID); break; } // enforce charset/length policy
+      bool opened=false;
+      if (set_string_field(s_id,sizeof(s_id),tmp,strlen(tmp),DIRTY_ID)) // RAM now, NVS on the idle commit
+        cfg_stamp(*find_tag(TAG_ID),opened);
+      node_log(LVL_INFO, EV_SET_ID, strlen(s_id));
+      node_link_set_addr(s_id);
+      node_display_draw_id(s_id);                                      // nudge UI if present (async)
+      { FrameWriter w(Verb::RESP_OK,seq,s_len16);                      // ack with the new ID
+        send_tag_value(w,TAG_ID);
+        reply(w);
       }
       node_interface_send_hello();                                     // unsolicited announce (seq=0)
       break;
@@ -597,170 +1186,257 @@ void node_interface_on_packet(const uint8_t* frame, size_t len) {
 
     // Parameter read: for each TLV with len==0, populate that tag in the response.
     case Verb::GET_PARAM: {
-      uint8_t b[128]; size_t i; frame_begin(Verb::RESP_OK,seq,b,i);    // start RESP_OK
-      size_t off=4,end=4+frame[3];                                     // TLV scan window
-      while (off+2<=end) {                                             // need tag+len available
-        uint8_t t=frame[off++]; uint8_t L=frame[off++];                // read tag, len
-        off+=L; // skip value                                            // skip any provided value
-        if (L==0) send_tag_value(b,i,t);                                // tag-only means "please return"
-      }
-      frame_end(b,i); protocol_send(b,i);                              // finalize + send
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);                        // start RESP_OK
+      for (const TlvView::Item t : tlv)
+        if (t.len==0) send_tag_value(w,t.tag);                          // tag-only means "please return"
+      reply(w);                                                        // finalize + send (RESP_ERR if it overflowed)
       break;
     }
 
-    // Parameter write: validate and apply each provided TLV; NVS save only if all OK.
+    // Parameter write: validate every TLV first, then apply them all; changed fields are
+    // marked dirty and committed together once the link goes quiet (see commit_if_due()).
     case Verb::SET_PARAM: {
       bool ok=true;                                                     // optimistic parse
-      size_t off=4,end=4+frame[3];                                     // TLV scan window
-      while (off+2<=end) {
-        uint8_t t=frame[off++]; uint8_t L=frame[off++];                // read tag, len
-        const uint8_t* p = frame+off; off+=L;                           // grab value then advance
-        
-        // Dispatch on the incoming command kind: select the appropriate handler
-        // (e.g., ID, ALIAS, MESSAGE) and execute its logic. Each case translates
-        // the abstract command enum into a concrete action for this node.
-        switch (t) {
-
-          // Alias: copy string into s_alias with length clamp and NUL termination.
-          case TAG_ALIAS: {
-            strncpy(s_alias, (const char*)p, std::min((size_t)L, sizeof(s_alias) - 1));
-            break;
-          }
-
-          // Frequency: expect a 4-byte LE value -> s_freq_hz.
-          case TAG_FREQ_HZ: {
-            ok &= tlv_read_le<uint32_t>(p, L, s_freq_hz);
-            break;
-          }
-
-          // Spreading Factor: must be valid SF (7..12); otherwise fail.
-          case TAG_SF: {
-            uint8_t v;
-            if (tlv_read_le<uint8_t>(p, L, v) && is_valid_sf(v)) {
-              s_sf = v;
-            } else {
-              ok = false;
-            }
-            break;
-          }
-
-          // Bandwidth: expect a 4-byte LE value -> s_bw_hz.
-          case TAG_BW_HZ: {
-            ok &= tlv_read_le<uint32_t>(p, L, s_bw_hz);
-            break;
-          }
-
-          // Coding Rate: must pass validation; otherwise fail.
-          case TAG_CR: {
-            uint8_t v;
-            if (tlv_read_le<uint8_t>(p, L, v) && is_valid_cr(v)) {
-              s_cr = v;
-            } else {
-              ok = false;
-            }
-            break;
-          }
-
-          // TX Power: signed 8-bit dBm value.
-          case TAG_TX_PWR_DBM: {
-            ok &= tlv_read_le<int8_t>(p, L, s_tx_pwr);
-            break;
-          }
-
-          // Channel index: 8-bit integer.
-          case TAG_CHAN: {
-            ok &= tlv_read_le<uint8_t>(p, L, s_chan);
-            break;
-          }
-
-          // Mode: 8-bit integer representing current node mode.
-          case TAG_MODE: {
-            ok &= tlv_read_le<uint8_t>(p, L, s_mode);
-            break;
-          }
-
-          // Hop count: 8-bit integer for routing depth.
-          case TAG_HOPS: {
-            ok &= tlv_read_le<uint8_t>(p, L, s_hops);
-            break;
-          }
-
-          // Beacon interval: 4-byte LE seconds.
-          case TAG_BEACON_SEC: {
-            ok &= tlv_read_le<uint32_t>(p, L, s_beacon_s);
-            break;
-          }
-
-          // Buffer size: 2-byte LE value.
-          case TAG_BUF_SIZE: {
-            ok &= tlv_read_le<uint16_t>(p, L, s_buf_size);
-            break;
-          }
-
-          // ACK Mode: must be validated (0/1); otherwise fail.
-          case TAG_ACK_MODE: {
-            uint8_t v;
-            if (tlv_read_le<uint8_t>(p, L, v) && is_valid_ack(v)) {
-              s_ack_mode = v;
-            } else {
-              ok = false;
-            }
-            break;
-          }
-        }
+      uint8_t bad_tag=0;                                                // first offender, for the log
+      bool radio_changed=false;                                         // any modem tag touched?
+      bool beacon_changed=false;                                        // restart the beacon phase?
+      bool opened=false;                                                // TAG_CFG_GEN bumped yet?
+
+      // Pass 1: width + range checks (structure was checked up front), no side effects.
+      for (const TlvView::Item t : tlv)
+        if (!tag_check(t.tag,t.value,t.len)) { ok=false; bad_tag=t.tag; break; }
+      if (!ok) {                                                        // all-or-nothing semantics
+        node_log(LVL_WARN, EV_SET_REJECT, verb, bad_tag);
+        send_resp_err(seq,ERR_INVALID); break;
+      }
 
+      // Pass 2: apply. Unknown and read-only tags are skipped.
+      for (const TlvView::Item t : tlv) {
+        const TagDesc* d=find_tag(t.tag);
+        if (d && (d->flags & TF_RW)) {
+          if (tag_write(*d,t.value,t.len)) cfg_stamp(*d,opened);
+          radio_changed |= (d->flags & TF_RADIO) != 0;
+          beacon_changed |= (t.tag == TAG_BEACON_SEC);
+        }
+      }
+      node_msgq_set_capacity(s_buf_size);                               // TAG_BUF_SIZE is live
+      node_link_set_route(s_mode == 0, s_hops);                         // TAG_MODE / TAG_HOPS too
+      if (beacon_changed) beacon_apply();                               // TAG_BEACON_SEC too
+      node_power_set_mode(s_sleep);                                     // TAG_SLEEP too
+      node_link_set_pack(s_compress == 1);                              // TAG_COMPRESS too
+      if (radio_changed) {                                              // apply to the modem live
+        if (s_in_batch) s_batch_radio = true;                           //   once, after the batch
+        else radio_apply();
       }
-      if (!ok) { send_resp_err(seq); break; }                           // all-or-nothing semantics
-      save_to_nvs();                                                    // persist applied settings
-      uint8_t b[128]; size_t i; frame_begin(Verb::RESP_OK,seq,b,i);     // echo back current values
-      // echo back all settable tags
-      send_tag_value(b,i,TAG_ALIAS);
-      send_tag_value(b,i,TAG_FREQ_HZ);
-      send_tag_value(b,i,TAG_SF);
-      send_tag_value(b,i,TAG_BW_HZ);
-      send_tag_value(b,i,TAG_CR);
-      send_tag_value(b,i,TAG_TX_PWR_DBM);
-      send_tag_value(b,i,TAG_CHAN);
-      send_tag_value(b,i,TAG_MODE);
-      send_tag_value(b,i,TAG_HOPS);
-      send_tag_value(b,i,TAG_BEACON_SEC);
-      send_tag_value(b,i,TAG_BUF_SIZE);
-      send_tag_value(b,i,TAG_ACK_MODE);
-      frame_end(b,i); protocol_send(b,i);                               // finalize + send
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);                         // echo back current values
+      for (size_t k=0;k<kTagCount;++k)                                  // every settable tag
+        if (kTags[k].flags & TF_RW) tag_put(w,kTags[k]);
+      send_tag_value(w,TAG_CFG_GEN);                                    // host's new delta point
+      reply(w);                                                         // finalize + send
       break;
     }
 
     // Bulk read: return identity, radio, behavior, and diagnostic tags in one shot.
+    // With TAG_CFG_SINCE (a generation the host holds): TAG_CFG_GEN plus only the
+    // persisted rows changed after it; a generation ahead of ours gets everything.
     case Verb::GET_ALL: {
-      uint8_t b[192]; size_t i; frame_begin(Verb::RESP_OK,seq,b,i);
-      for (uint8_t t : {
-        TAG_ID,TAG_ALIAS,TAG_FREQ_HZ,TAG_SF,TAG_BW_HZ,TAG_CR,TAG_TX_PWR_DBM,
-        TAG_CHAN,TAG_MODE,TAG_HOPS,TAG_BEACON_SEC,TAG_BUF_SIZE,TAG_ACK_MODE,
-        TAG_RSSI_DBM,TAG_SNR_DB,TAG_VBAT_MV,TAG_TEMP_C10,TAG_FREE_MEM,TAG_FREE_FLASH,TAG_LOG_COUNT
-      }) send_tag_value(b,i,t);                                          // emit each tag’s TLV
-      frame_end(b,i); protocol_send(b,i);
+      uint32_t since=0;
+      uint8_t L=0; const uint8_t* p = tlv.find(TAG_CFG_SINCE,L);
+      if (p && !tlv_read_le<uint32_t>(p,L,since)) { send_resp_err(seq,ERR_INVALID); break; }
+      const bool delta = p && since <= s_cfg_gen;
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);
+      for (size_t k=0;k<kTagCount;++k) {                                // rows flagged TF_ALL
+        const TagDesc& d=kTags[k];
+        if (!(d.flags & TF_ALL)) continue;
+        if (delta && d.tag!=TAG_CFG_GEN && (!(d.flags & TF_NVS) || s_tag_gen[k]<=since)) continue;
+        tag_put(w,d);
+      }
+      reply(w);
       break;
     }
 
-    // Text message: copy payload for UI/debug, optionally draw, ack with ID.
+    // Text message: copy payload for UI/debug, queue it for LoRa TX, optionally draw, ack with ID
+    // (+TAG_MSG_ID when queued). FLAG_CTRL puts it on the control lane; the reply's flags
+    // report queue depth/XOFF. With TAG_ACK_MODE=1 the outcome follows as MSG_STATUS.
     case Verb::MSG: {
-      if (len<4) { send_resp_err(seq); break; }                          // header must exist
-      uint8_t L=frame[3]; if (len<4+L) { send_resp_err(seq); break; }    // ensure declared bytes exist
+      const size_t L=blen;                                               // dispatcher checked bounds
+      if (L>kAirMaxPayload) { send_resp_err(seq,ERR_TOO_LARGE); break; }        // one air packet max
+      uint16_t id=0;
+      if (node_radio_available() && L>0) {                               // queue for the air
+        Msg* out=node_msgq_alloc();                                      // the payload's only buffer until the FIFO
+        if (out) {
+          id=node_link_next_id();
+          out->len=static_cast<uint8_t>(L); out->hops=s_hops; out->id=id; out->dst=s_dst; out->rssi_dbm=0; out->snr_db=0;
+          out->lane=(frame[1] & FLAG_CTRL) ? LANE_CTRL : LANE_CHAT;
+          memcpy(out->data(),frame+body,L);                              // the one copy: SLIP buffer -> slot
+        }
+        if (!out || !node_msgq_commit(MQ_OUT,out)) {
+          node_log(LVL_WARN, EV_RADIO_TX_FULL, L);
+          send_resp_err(seq,ERR_BUSY); break;                            // queue full: host should back off
+        }
+        pump_outbound();                                                 // straight to the TX ring if idle
+      }
       size_t copy=(L>=sizeof(s_last_text))?(sizeof(s_last_text)-1):L;    // clamp to buffer-1 for NUL
-      memcpy(s_last_text,frame+4,copy); s_last_text[copy]='\0';          // stash and terminate
+      memcpy(s_last_text,frame+body,copy); s_last_text[copy]='\0';       // stash and terminate
+      node_log(LVL_INFO, EV_HOST_MSG, L, seq);                           // binary trace; never text on the SLIP port
       if (node_display_available())
-        node_display_draw_two_lines("RX Msg:", s_last_text);             // non-fatal UI side-effect
-      Serial.printf("[RX] %s\n", s_last_text);                           // debug trace to serial
-      { uint8_t b[64]; size_t i; frame_begin(Verb::RESP_OK,seq,b,i);     // minimal ack with ID
-        send_tag_value(b,i,TAG_ID);
-        frame_end(b,i); protocol_send(b,i);
+        node_display_draw_message("> ", s_last_text);                    // scrollback; worker pushes
+      { FrameWriter w(Verb::RESP_OK,seq,s_len16);                        // minimal ack with ID
+        send_tag_value(w,TAG_ID);
+        if (id) w.tlv_le<uint16_t>(TAG_MSG_ID,id);                       // correlates later MSG_STATUS
+        reply(w);
+      }
+      break;
+    }
+
+    // Log pull: oldest-first entries from TAG_LOG_SINCE (default: everything retained).
+    // Reply carries TAG_LOG_COUNT, as many TAG_LOG_ENTRY TLVs as fit one frame, and
+    // TAG_LOG_SINCE = id to ask for next. Host repeats until no entries come back.
+    case Verb::GET_LOG: {
+      uint16_t since=0;
+      uint8_t L=0; const uint8_t* p = tlv.find(TAG_LOG_SINCE,L);
+      if (p && !tlv_read_le<uint16_t>(p,L,since)) { send_resp_err(seq,ERR_INVALID); break; }
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);
+      send_tag_value(w,TAG_LOG_COUNT);
+      const size_t per = (w.room() - 4) / (2 + kLogEntryWire);           // 13 classic, 55 LEN16; 4 = SINCE TLV
+      uint16_t next = since;
+      LogEntry e[8];                                                     // copy out in small chunks
+      for (size_t done = 0; done < per; ) {
+        const size_t want = (per - done < 8) ? (per - done) : 8;
+        const size_t n = node_log_read(next,e,want);
+        for (size_t k=0;k<n;++k) {
+          uint8_t v[kLogEntryWire]; node_log_encode(e[k],v);
+          w.tlv(TAG_LOG_ENTRY,v,sizeof(v));
+        }
+        if (n) next = static_cast<uint16_t>(e[n-1].id + 1);
+        done += n;
+        if (n < want) break;                                             // caught up with the ring
+      }
+      w.tlv_le<uint16_t>(TAG_LOG_SINCE,next);                            // id to ask for next
+      reply(w);
+      break;
+    }
+
+    // Counter snapshot: link + error records, then one row per active verb while they fit.
+    // Optional TAG_STAT_RESET=1 starts a fresh measurement interval after this reply.
+    case Verb::GET_STATS: {
+      uint8_t rst=0;
+      uint8_t L=0; const uint8_t* p = tlv.find(TAG_STAT_RESET,L);
+      if (p && !tlv_read_le<uint8_t>(p,L,rst)) { send_resp_err(seq,ERR_INVALID); break; }
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);
+      { uint8_t v[kStatLinkWire]; node_stats_encode_link(v); w.tlv(TAG_STAT_LINK,v,sizeof(v)); }
+      { uint8_t v[kStatErrWire];  node_stats_encode_err(v);  w.tlv(TAG_STAT_ERR,v,sizeof(v)); }
+      { uint8_t v[kPowerStatWire]; node_power_encode(v);     w.tlv(TAG_STAT_POWER,v,sizeof(v)); }
+      { uint8_t v[kStatPackWire]; node_stats_encode_pack(v); w.tlv(TAG_STAT_PACK,v,sizeof(v)); }
+      { uint8_t v[kRadioStatWire]; node_radio_encode(v);     w.tlv(TAG_STAT_RADIO,v,sizeof(v)); }
+      for (size_t r=0; r<node_stats_verb_rows() && w.room()>=2+kStatVerbWire; ++r) {
+        uint8_t v[kStatVerbWire];
+        if (node_stats_encode_verb(r,v)) w.tlv(TAG_STAT_VERB,v,sizeof(v));
+      }
+      for (size_t r=0; r<node_adr_rows() && w.room()>=2+kAdrWire; ++r) {
+        uint8_t v[kAdrWire];
+        if (node_adr_encode(r,v)) w.tlv(TAG_STAT_NBR,v,sizeof(v));
+      }
+      reply(w);
+      if (rst==1) { node_stats_reset(); node_power_reset_stats(); node_radio_reset_stats(); }
+      break;
+    }
+
+    // Push instead of poll: replace the subscription (empty body cancels it), answer with the
+    // period and the current values as baseline; sub_check() sends the reports.
+    case Verb::SUBSCRIBE: {
+      SubTag next[kSubTagsMax];
+      size_t n=0;
+      uint16_t period=0;
+      bool ok=true, watch=false;
+      uint8_t bad_tag=0;
+      for (const TlvView::Item t : tlv) {
+        if (t.tag==TAG_SUB_PERIOD_S) {
+          if (!tlv_read_le<uint16_t>(t.value,t.len,period)) { ok=false; bad_tag=t.tag; break; }
+          continue;
+        }
+        const TagDesc* d=find_tag(t.tag);                               // unknown: could never be reported
+        bool dup=false;
+        for (size_t k=0;d && k<n;++k) dup |= (&kTags[next[k].row]==d);
+        if (!d || dup || n==kSubTagsMax || (t.len && (d->kind==TK_STR || t.len!=d->width))) {
+          ok=false; bad_tag=t.tag; break;
+        }
+        uint32_t delta=0;
+        for (size_t j=0;j<t.len;++j) delta |= static_cast<uint32_t>(t.value[j]) << (8*j);
+        next[n++] = SubTag{static_cast<uint8_t>(d-kTags), t.len!=0, delta, 0};
+        watch |= t.len!=0;
+      }
+      if (ok && n && !period && !watch) ok=false;                       // nothing would ever report
+      if (!ok) {
+        node_log(LVL_WARN, EV_SET_REJECT, verb, bad_tag);
+        send_resp_err(seq,ERR_INVALID); break;
+      }
+      memcpy(s_sub,next,n*sizeof(SubTag));
+      s_sub_n=n;
+      s_sub_period_ms = n ? period*1000u : 0;
+      s_sub_seq=0;
+      s_sub_last_ms=millis();
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);
+      w.tlv_le<uint16_t>(TAG_SUB_PERIOD_S,static_cast<uint16_t>(s_sub_period_ms/1000u));
+      sub_put(w);                                                       // baseline for the watch
+      reply(w);
+      sub_apply();
+      break;
+    }
+
+    // Several sub-frames in one packet; one aggregated reply (see handle_batch()).
+    case Verb::BATCH:
+      handle_batch(frame,len,seq);
+      break;
+
+    // Benchmark echo: timestamp, reflect TAG_BENCH_DATA, add TAG_BENCH_FILL pattern bytes,
+    // then report node-side handling time. Fill is clamped to what fits the reply form.
+    case Verb::BENCH: {
+      const uint32_t t0 = static_cast<uint32_t>(esp_timer_get_time());
+      static uint8_t pat[255];                                          // 0,1,2,... pattern, built once
+      if (!pat[1]) for (size_t k=0;k<sizeof(pat);++k) pat[k]=static_cast<uint8_t>(k);
+      FrameWriter w(Verb::RESP_OK,seq,s_len16);
+      w.tlv_le<uint32_t>(TAG_BENCH_T_US,t0);
+      uint16_t fill=0;
+      for (const TlvView::Item t : tlv) {                               // echo every DATA TLV in order
+        if (t.tag==TAG_BENCH_DATA) w.tlv(TAG_BENCH_DATA,t.value,t.len);
+        else if (t.tag==TAG_BENCH_FILL) tlv_read_le<uint16_t>(t.value,t.len,fill);
+      }
+      while (fill && w.room() > 2 + 6) {                                // keep 6 bytes for DT_US
+        size_t n = w.room() - 2 - 6;
+        if (n > sizeof(pat)) n = sizeof(pat);
+        if (n > fill) n = fill;
+        w.tlv(TAG_BENCH_DATA,pat,n);
+        fill = static_cast<uint16_t>(fill - n);
+      }
+      w.tlv_le<uint32_t>(TAG_BENCH_DT_US,static_cast<uint32_t>(esp_timer_get_time()) - t0);
+      reply(w);
+      break;
+    }
+
+    // Link rate change: validate, ack at the current rate, then let the transport
+    // switch after this reply has drained (it reverts unless the host confirms).
+    // Only the UART has a rate; over UDP/BLE the request is refused.
+    case Verb::SET_BAUD: {
+      uint32_t baud=0;
+      uint8_t L=0; const uint8_t* p = tlv.find(TAG_BAUD,L);
+      if (node_protocol_link() != LINK_USB ||
+          !p || !tlv_read_le<uint32_t>(p,L,baud) || !node_protocol_baud_supported(baud)) {
+        node_log(LVL_WARN, EV_SET_REJECT, verb, TAG_BAUD);
+        send_resp_err(seq,ERR_INVALID); break;
+      }
+      { FrameWriter w(Verb::RESP_OK,seq,s_len16);
+        w.tlv_le<uint32_t>(TAG_BAUD,baud);
+        reply(w);
       }
+      node_protocol_set_baud(baud);                                     // applied by node_protocol_update()
       break;
     }
 
     // Fallback: unknown verb -> RESP_ERR (don’t crash; caller gets an error frame).
     default:
-      send_resp_err(seq);
+      node_log(LVL_WARN, EV_BAD_VERB, verb);
+      send_resp_err(seq,ERR_BAD_VERB);
       break;
   }
 }
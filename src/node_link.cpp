@@ -0,0 +1,451 @@
+// -----------------------------------------------------------------------------
+// node_link.cpp
+// Implementation of the air header and ACK/retry layer declared in node_link.hpp.
+//
+// Notes:
+//  * See node_link.hpp for the header layout and the reliability contract.
+//  * Everything runs on the transport task, so the tables need no locks.
+//  * A sent message stays framed in its node_msgq slot; the retransmit table
+//    points at it, so a retry is one node_radio_send_ref() with no encoding
+//    and no copy. Msg::refs counts the table and the radio; the last one
+//    out frees the slot.
+//  * The relay table keeps whole air packets (header included), so a
+//    rebroadcast is one node_radio_send() with no re-encoding.
+//  * The seen-cache is a small open-addressed hash table: a fixed 4-slot probe
+//    window per key, so lookups cost the same however busy the channel is.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_link.hpp"
+#include "node_ring.hpp"        // SpscRing for delivery events
+#include "node_log.hpp"         // EV_LINK_FAIL / EV_LINK_DUP
+#include "node_smaz.hpp"        // AIR_F_PACKED payloads
+#include "node_stats.hpp"       // packing ratio counters
+#include "node_adr.hpp"         // beacon link quality
+
+#include <Arduino.h>            // millis(), esp_random()
+#include <cmath>                // ceilf (time-on-air)
+#include <cstring>              // memcpy
+
+namespace {
+
+constexpr size_t   kSeenSlots   = 64;     // power of two; (src, id, tag) entries
+constexpr size_t   kSeenProbe   = 4;      // slots examined per lookup
+constexpr uint32_t kTurnaroundMs = 40;    // RX->TX switch, SPI, task latency on both ends
+constexpr uint32_t kBackoffCapShift = 4;  // random spread grows to ack_wait << 4, no further
+
+constexpr uint8_t  kSeenRelay   = AIR_F_ACKREQ;   // tag bit "relayed this try"; ACKREQ itself is never tagged
+
+static_assert((kSeenSlots & (kSeenSlots - 1)) == 0, "kSeenSlots must be a power of two");
+static_assert(kAirHdr == kMsgHeadroom, "the air header is written into a slot's headroom");
+
+struct RetxSlot {
+  bool     used;
+  uint8_t  tries;                         // transmissions so far
+  uint16_t id;
+  uint16_t dst;                           // the only node whose ACK closes this slot
+  uint32_t due_ms;                        // millis() of the next retransmit
+  uint32_t wait_ms;                       // ACK wait for this packet's size
+  Msg*     m;                             // the framed slot: m->buf holds header + payload
+};
+
+struct Seen {
+  uint32_t key;                           // src << 16 | id
+  uint32_t t_ms;                          // millis() when last heard
+  uint8_t  tag;                           // AirKind [| try bits | kSeenRelay]; 0 = empty
+};
+
+struct RelaySlot {
+  bool     used;
+  uint8_t  tag;
+  uint32_t key;
+  uint32_t due_ms;                        // millis() of the rebroadcast
+  uint8_t  len;
+  uint8_t  pkt[kRadioMaxPayload];         // as received, hop byte already decremented
+};
+
+uint16_t g_addr    = 1;
+uint16_t g_next_id = 0;
+RadioConfig g_cfg  = {915000000, 9, 125000, 5, 17, 0};
+
+bool     g_relay    = true;               // TAG_MODE 0 = relay (node_link_set_route)
+uint8_t  g_max_hops = 1;                  // TAG_HOPS: budget for our own ACKs
+bool     g_pack     = false;              // TAG_COMPRESS
+uint32_t g_heard    = 0;                  // valid packets from other nodes
+void   (*g_on_fail)(const Msg& m) = nullptr;
+
+RetxSlot  g_retx[kRetxSlots];
+RelaySlot g_relays[kRelaySlots];
+Seen      g_seen[kSeenSlots];
+
+SpscRing<LinkEvent, 8> g_events;
+
+void put16(uint8_t* p, uint16_t v) { p[0] = static_cast<uint8_t>(v); p[1] = static_cast<uint8_t>(v >> 8); }
+uint16_t get16(const uint8_t* p)   { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+void write_hdr(uint8_t* p, uint8_t kind, uint16_t dst, uint16_t id, uint8_t hops) {
+  p[0] = kAirMagic;
+  p[1] = kind;
+  put16(p + 2, g_addr);
+  put16(p + 4, dst);
+  put16(p + 6, id);
+  p[8] = hops;
+}
+
+// LoRa time-on-air (Semtech AN1200.13): explicit header, CRC on, the radio's preamble
+// (8 symbols, longer when hopping).
+uint32_t airtime_ms(size_t len) {
+  const float tsym = static_cast<float>(1u << g_cfg.sf) / static_cast<float>(g_cfg.bw_hz) * 1000.0f;
+  const int   de   = (tsym > 16.0f) ? 1 : 0;                 // low data rate optimize
+  const float num  = 8.0f * len - 4.0f * g_cfg.sf + 28 + 16;
+  const float den  = 4.0f * (g_cfg.sf - 2 * de);
+  float nsym = ceilf(num / den) * g_cfg.cr;
+  if (nsym < 0) nsym = 0;
+  return static_cast<uint32_t>((node_radio_preamble(g_cfg) + 4.25f + 8 + nsym) * tsym) + 1;
+}
+
+uint32_t ack_wait_ms(size_t len) {
+  return airtime_ms(len) + airtime_ms(kAirHdr) + kTurnaroundMs;
+}
+
+// Retry k (k >= 1 sends already made): ack_wait + random(0, ack_wait << k).
+uint32_t backoff_ms(const RetxSlot& s) {
+  const uint32_t shift  = s.tries < kBackoffCapShift ? s.tries : kBackoffCapShift;
+  const uint32_t spread = s.wait_ms << shift;
+  return s.wait_ms + (spread ? esp_random() % spread : 0);
+}
+
+// Seen-cache: true if (key, tag) was heard within kSeenTtlMs; otherwise
+// remember it in the first free/expired slot of its probe window, or over
+// the window's oldest entry.
+bool seen_check_and_add(uint32_t key, uint8_t tag, uint32_t now) {
+  const size_t home = ((key ^ tag) * 2654435761u) >> 26;   // Fibonacci hash, top 6 bits
+  Seen*    victim = nullptr;
+  uint32_t oldest = 0;
+  bool     free   = false;
+  for (size_t p = 0; p < kSeenProbe; ++p) {
+    Seen& s = g_seen[(home + p) & (kSeenSlots - 1)];
+    const uint32_t age = now - s.t_ms;
+    const bool live = s.tag && age < kSeenTtlMs;
+    if (live && s.key == key && s.tag == tag) return true;
+    if (free) continue;
+    if (!live) { victim = &s; free = true; }
+    else if (!victim || age > oldest) { victim = &s; oldest = age; }
+  }
+  *victim = Seen{key, now, tag};
+  return false;
+}
+
+// Polite flooding: park a copy with one hop spent, rebroadcast after a random
+// delay of up to two packet airtimes.
+void relay_schedule(const RadioPacket& pkt, uint32_t key, uint8_t tag, uint32_t now) {
+  RelaySlot* slot = nullptr;
+  for (auto& r : g_relays) if (!r.used) { slot = &r; break; }
+  if (!slot) { node_log(LVL_DEBUG, EV_RELAY_DROP, key >> 16, key & 0xFFFF); return; }
+  slot->used   = true;
+  slot->tag    = tag;
+  slot->key    = key;
+  slot->len    = pkt.len;
+  memcpy(slot->pkt, pkt.data, pkt.len);
+  slot->pkt[8] = static_cast<uint8_t>(pkt.data[8] - 1);
+  slot->due_ms = now + kTurnaroundMs + esp_random() % (2 * airtime_ms(pkt.len));
+}
+
+// Someone else already rebroadcast this packet at (or beyond) our hop level:
+// our copy would add nothing but airtime. A repeat from closer to the origin
+// (more hops left: a relay behind us) does not cancel.
+void relay_cancel_if_covered(uint32_t key, uint8_t tag, uint8_t heard_hops) {
+  for (auto& r : g_relays) {
+    if (r.used && r.key == key && r.tag == tag && heard_hops <= r.pkt[8]) r.used = false;
+  }
+}
+
+void report(uint16_t id, LinkStatus status, uint8_t tries) {
+  if (LinkEvent* e = g_events.write_slot()) {
+    *e = LinkEvent{id, status, tries};
+    g_events.commit();
+  }
+}
+
+// The ACK echoes the try bits of the copy it answers, so relays treat the
+// answer to each retry as new traffic.
+void send_ack(uint16_t to, uint16_t id, uint8_t try_bits) {
+  uint8_t ack[kAirHdr];
+  write_hdr(ack, AIR_ACK | try_bits, to, id, g_max_hops);
+  node_radio_send(ack, sizeof(ack));          // TX ring full: the sender simply retries
+}
+
+// The radio dropped a try unsent: a reliable message need not wait out an ACK
+// that cannot come. The try still counts, so a radio that never transmits
+// still ends in LINK_FAILED.
+void retry_now(const Msg& m) {
+  for (auto& s : g_retx) if (s.used && s.m == &m) s.due_ms = millis();
+}
+
+// A holder of a sent slot lets go; the last one returns it to the pool.
+void unref(Msg* m) {
+  if (--m->refs == 0) node_msgq_free(m);
+}
+
+// hand_back() — give a failed message's plain payload to the node_link_on_fail() hook.
+// Unpacked messages go as they are, straight from their slot.
+void hand_back(Msg& s) {
+  s.lane = LANE_CHAT;
+  if (!(s.buf[1] & AIR_F_PACKED)) { g_on_fail(s); return; }
+  static Msg m;                                         // static: 280 B off the task stack
+  size_t plain = 0;
+  if (!node_smaz_unpack(s.data(), s.len, m.data(), kRadioMaxPayload, plain)) return;
+  m.len      = static_cast<uint8_t>(plain);
+  m.lane     = LANE_CHAT;
+  m.hops     = s.hops;
+  m.id       = s.id;
+  m.dst      = s.dst;
+  m.rssi_dbm = 0;
+  m.snr_db   = 0;
+  g_on_fail(m);
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Identity and timing
+// -----------------------------------------------------------------------------
+void node_link_set_addr(const char* id) {
+  uint32_t h = 2166136261u;                   // FNV-1a, folded to 16 bits
+  for (const char* p = id; p && *p; ++p) h = (h ^ static_cast<uint8_t>(*p)) * 16777619u;
+  uint16_t a = static_cast<uint16_t>((h >> 16) ^ h);
+  if (a == 0 || a == kAirBroadcast) a = 1;    // reserved values
+  g_addr = a;
+}
+
+uint16_t node_link_addr() {
+  return g_addr;
+}
+
+void node_link_set_route(bool relay, uint8_t max_hops) {
+  g_relay    = relay;
+  g_max_hops = max_hops;
+  if (!relay) for (auto& r : g_relays) r.used = false;
+}
+
+void node_link_set_pack(bool on) {
+  g_pack = on;
+}
+
+void node_link_on_fail(void (*fn)(const Msg& m)) {
+  g_on_fail = fn;
+}
+
+uint32_t node_link_heard() {
+  return g_heard;
+}
+
+void node_link_configure(const RadioConfig& cfg) {
+  g_cfg = cfg;
+}
+
+uint16_t node_link_next_id() {
+  if (++g_next_id == 0) ++g_next_id;
+  return g_next_id;
+}
+
+// -----------------------------------------------------------------------------
+// Send
+// - Unreliable: header into the headroom, slot to the radio, fire and forget
+// - Reliable: the retransmit slot also holds on to it; only an addressed
+//   message can be reliable (a broadcast would draw an ACK from every node)
+// - Packing on: the payload is replaced by its packed form only if shorter;
+//   that is a transform, so it needs one bounce through a scratch buffer
+// -----------------------------------------------------------------------------
+LinkSend node_link_send(Msg& m, bool reliable) {
+  if (m.len > kAirMaxPayload) return SEND_DROP;   // cannot be framed (MSG already rejects these)
+  reliable = reliable && m.dst != kAirBroadcast;
+  RetxSlot* slot = nullptr;
+  if (reliable) {
+    for (auto& s : g_retx) if (!s.used) { slot = &s; break; }
+    if (!slot) return SEND_BUSY;              // table full: leave it queued
+  }
+  if (!node_radio_tx_ready()) return SEND_BUSY;   // TX ring full: retry next pass, slot untouched
+
+  size_t packed = 0;
+  if (g_pack && m.len > 1) {
+    uint8_t tmp[kAirMaxPayload];
+    packed = node_smaz_pack(m.data(), m.len, tmp, m.len - 1);
+    if (packed) memcpy(m.data(), tmp, packed);
+  }
+  const size_t plain = m.len;
+  if (packed) m.len = static_cast<uint8_t>(packed);
+  write_hdr(m.buf, AIR_DATA | (reliable ? AIR_F_ACKREQ : 0) | (packed ? AIR_F_PACKED : 0), m.dst, m.id, m.hops);
+  const size_t n = kAirHdr + m.len;
+  m.refs = slot ? 2 : 1;                      // radio (+ retransmit table)
+  node_radio_send_ref(m.buf, n, &m);          // cannot refuse after tx_ready()
+  node_stats_pack_tx(plain, m.len);
+
+  if (slot) {
+    slot->used    = true;
+    slot->tries   = 1;
+    slot->id      = m.id;
+    slot->dst     = m.dst;
+    slot->m       = &m;
+    slot->wait_ms = ack_wait_ms(n);
+    slot->due_ms  = millis() + backoff_ms(*slot);
+  }
+  return SEND_OK;
+}
+
+bool node_link_beacon(const char* id) {
+  uint8_t pkt[kRadioMaxPayload];
+  size_t n = id ? strnlen(id, kAirMaxPayload) : 0;
+  write_hdr(pkt, AIR_BEACON, kAirBroadcast, 0, 1);
+  memcpy(pkt + kAirHdr, id, n);
+  return node_radio_send(pkt, kAirHdr + n);
+}
+
+// -----------------------------------------------------------------------------
+// Receive
+// - Legacy (no magic): deliver raw
+// - Our own packet echoed by a relay: ignore
+// - Beacon: log the neighbour, nothing else
+// - DATA for us with ACKREQ: ACK (even repeats); a broadcast is never ACKed
+// - Relay mode, not addressed only to us: rebroadcast each (src, id, try)
+//   once if hops are left; a repeat instead cancels our pending copy when
+//   someone at our hop level already sent it
+// - ACK for us: close the slot waiting on that (src, id), report delivered
+// - DATA for us/broadcast: deliver once per (src, id)
+// -----------------------------------------------------------------------------
+bool node_link_receive(const RadioPacket& pkt, Msg& out) {
+  out.rssi_dbm = pkt.rssi_dbm;
+  out.snr_db   = pkt.snr_db;
+  out.lane     = LANE_CHAT;
+  out.hops     = 0;
+  out.id       = 0;
+  out.dst      = kAirBroadcast;
+
+  if (pkt.len < kAirHdr || pkt.data[0] != kAirMagic) {
+    out.len = pkt.len;
+    memmove(out.data(), pkt.data, pkt.len);   // headerless: shift the payload past the headroom
+    return true;
+  }
+
+  const uint8_t  kind = pkt.data[1] & AIR_KIND_MASK;
+  const uint8_t  tbit = pkt.data[1] & AIR_TRY_MASK;
+  const uint16_t src  = get16(pkt.data + 2);
+  const uint16_t dst  = get16(pkt.data + 4);
+  const uint16_t id   = get16(pkt.data + 6);
+  const uint8_t  hops = pkt.data[8];
+  const uint32_t key  = static_cast<uint32_t>(src) << 16 | id;
+  const uint32_t now  = millis();
+  const bool     mine = (dst == g_addr || dst == kAirBroadcast);
+  if (src == g_addr) return false;            // our own, echoed by a relay
+  ++g_heard;
+  if (kind == AIR_BEACON) {
+    node_log(LVL_DEBUG, EV_BEACON_RX, src, static_cast<uint16_t>(pkt.rssi_dbm) | (static_cast<uint8_t>(pkt.snr_db) << 16));
+    node_adr_observe(src, pkt.rssi_dbm, pkt.snr_db);
+    return false;
+  }
+  if (kind != AIR_DATA && kind != AIR_ACK) return false;   // newer firmware
+
+  if (kind == AIR_DATA && dst == g_addr && (pkt.data[1] & AIR_F_ACKREQ)) send_ack(src, id, tbit);
+  if (g_relay && dst != g_addr) {
+    const uint8_t tag = kSeenRelay | tbit | kind;
+    if (seen_check_and_add(key, tag, now)) relay_cancel_if_covered(key, tag, hops);
+    else if (hops > 1) relay_schedule(pkt, key, tag, now);
+  }
+  if (!mine) return false;
+
+  if (kind == AIR_ACK) {
+    if (dst != g_addr) return false;          // broadcast ACKs are meaningless
+    for (auto& s : g_retx) {                  // repeats find no slot: harmless
+      if (s.used && s.id == id && s.dst == src) {
+        s.used = false;
+        report(id, LINK_DELIVERED, s.tries);
+        unref(s.m);
+        break;
+      }
+    }
+    return false;
+  }
+  if (seen_check_and_add(key, AIR_DATA, now)) {
+    node_log(LVL_DEBUG, EV_LINK_DUP, src, id);
+    return false;
+  }
+
+  out.hops = hops;
+  out.id   = id;
+  out.dst  = dst;
+  if (pkt.data[1] & AIR_F_PACKED) {          // unpack is a transform: bounce through scratch
+    static uint8_t plain[kRadioMaxPayload];
+    size_t n = 0;
+    if (!node_smaz_unpack(pkt.data + kAirHdr, pkt.len - kAirHdr, plain, sizeof(plain), n)) {
+      node_stats_pack_bad();
+      node_log(LVL_WARN, EV_UNPACK_FAIL, src, id);
+      return false;
+    }
+    node_stats_pack_rx(pkt.len - kAirHdr, n);
+    memcpy(out.data(), plain, n);
+    out.len = static_cast<uint8_t>(n);
+    return true;
+  }
+  out.len = static_cast<uint8_t>(pkt.len - kAirHdr);  // already at out.data(): the FIFO put it there
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Timers: slots the radio has finished reading first, then due rebroadcasts
+// (they are already late by design), then retries. A retry waits while the
+// radio still holds the previous try: its header byte is about to change.
+// A try the radio dropped unsent makes its retry due at once.
+// -----------------------------------------------------------------------------
+void node_link_service() {
+  void* done;
+  bool  aired;
+  while (node_radio_sent(done, aired)) {
+    Msg* const m = static_cast<Msg*>(done);
+    if (!aired) retry_now(*m);
+    unref(m);
+  }
+
+  const uint32_t now = millis();
+  for (auto& r : g_relays) {
+    if (!r.used || static_cast<int32_t>(now - r.due_ms) < 0) continue;
+    if (!node_radio_send(r.pkt, r.len)) break;      // TX ring full: rest wait too
+    r.used = false;
+  }
+  for (auto& s : g_retx) {
+    if (!s.used || static_cast<int32_t>(now - s.due_ms) < 0) continue;
+    if (s.tries >= kRetxTries) {
+      s.used = false;
+      node_log(LVL_WARN, EV_LINK_FAIL, s.id, s.tries);
+      report(s.id, LINK_FAILED, s.tries);
+      if (g_on_fail) hand_back(*s.m);
+      unref(s.m);
+      continue;
+    }
+    if (s.m->refs > 1 || !node_radio_tx_ready()) continue;   // still on loan / TX ring full: next pass
+    uint8_t* pkt = s.m->buf;
+    pkt[1] = static_cast<uint8_t>((pkt[1] & ~AIR_TRY_MASK) | (s.tries << kAirTryShift & AIR_TRY_MASK));
+    ++s.m->refs;
+    node_radio_send_ref(pkt, kAirHdr + s.m->len, s.m);
+    ++s.tries;
+    s.due_ms = now + backoff_ms(s);
+  }
+}
+
+bool node_link_poll(LinkEvent& out) {
+  const LinkEvent* e = g_events.read_slot();
+  if (!e) return false;
+  out = *e;
+  g_events.release();
+  return true;
+}
+
+size_t node_link_pending() {
+  size_t n = 0;
+  for (const auto& s : g_retx) n += s.used ? 1 : 0;
+  return n;
+}
+
+bool node_link_idle() {
+  for (const auto& r : g_relays) if (r.used) return false;
+  return node_link_pending() == 0;
+}
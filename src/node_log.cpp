@@ -0,0 +1,73 @@
+// -----------------------------------------------------------------------------
+// node_log.cpp
+// Implementation of the binary event ring declared in node_log.hpp.
+//
+// Notes:
+//  * See node_log.hpp for the entry format and the host contract.
+//  * Producers live on every task (transport, worker, radio), so the ring
+//    is guarded by one short critical section rather than being lock-free.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_log.hpp"
+
+#include <Arduino.h>            // millis(), portMUX critical sections
+
+static LogEntry     s_ring[kLogEntries];
+static uint16_t     s_next_id = 0;       // id the next entry will get
+static uint16_t     s_count   = 0;       // retained entries (saturates at kLogEntries)
+static portMUX_TYPE s_mux     = portMUX_INITIALIZER_UNLOCKED;
+
+// -----------------------------------------------------------------------------
+// Record an event
+// - Slot is derived from the id, so the ring needs no separate head index
+// -----------------------------------------------------------------------------
+void node_log(LogLevel level, LogEvent event, uint32_t a, uint32_t b) {
+    const uint32_t now = millis();
+    portENTER_CRITICAL(&s_mux);
+    LogEntry& e = s_ring[s_next_id % kLogEntries];
+    e.t_ms  = now;
+    e.id    = s_next_id++;
+    e.level = level;
+    e.event = event;
+    e.a     = a;
+    e.b     = b;
+    if (s_count < kLogEntries) ++s_count;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+uint16_t node_log_count() {
+    return s_count;
+}
+
+// -----------------------------------------------------------------------------
+// Copy out entries with id >= since (oldest first)
+// - Wrap-safe: compare ids by signed 16-bit distance
+// - Requests older than the oldest retained entry start at the oldest
+// -----------------------------------------------------------------------------
+size_t node_log_read(uint16_t since, LogEntry* out, size_t max) {
+    if (!out || max == 0) return 0;
+    size_t n = 0;
+    portENTER_CRITICAL(&s_mux);
+    const uint16_t oldest = static_cast<uint16_t>(s_next_id - s_count);
+    uint16_t id = (static_cast<int16_t>(since - oldest) > 0) ? since : oldest;
+    while (n < max && static_cast<int16_t>(s_next_id - id) > 0) {
+        out[n++] = s_ring[id % kLogEntries];
+        ++id;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return n;
+}
+
+// -----------------------------------------------------------------------------
+// Serialize one entry (explicit little-endian; independent of struct layout)
+// -----------------------------------------------------------------------------
+void node_log_encode(const LogEntry& e, uint8_t (&out)[kLogEntryWire]) {
+    for (int j = 0; j < 4; ++j) out[0 + j]  = static_cast<uint8_t>(e.t_ms >> (8 * j));
+    out[4] = static_cast<uint8_t>(e.id);
+    out[5] = static_cast<uint8_t>(e.id >> 8);
+    out[6] = e.level;
+    out[7] = e.event;
+    for (int j = 0; j < 4; ++j) out[8 + j]  = static_cast<uint8_t>(e.a >> (8 * j));
+    for (int j = 0; j < 4; ++j) out[12 + j] = static_cast<uint8_t>(e.b >> (8 * j));
+}
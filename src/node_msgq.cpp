@@ -0,0 +1,169 @@
+// -----------------------------------------------------------------------------
+// node_msgq.cpp
+// Implementation of the two-lane message queues declared in node_msgq.hpp.
+//
+// Notes:
+//  * See node_msgq.hpp for lanes, drop policy, and the flag bits.
+//  * One pool serves both directions. Slots are linked by 8-bit indices into
+//    four FIFOs ([dir][lane]) plus a free list; nothing is ever allocated.
+//  * The pool holds kMsgQueueMax per direction plus kMsgLoanMax, so a
+//    direction that respects its own limit can always find a free slot
+//    while the radio and node_link hold theirs.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_msgq.hpp"
+#include "node_protocol.hpp"    // FLAG_XOFF / FLAG_QLVL
+
+namespace {
+
+constexpr size_t  kPoolSlots = 2 * kMsgQueueMax + kMsgLoanMax;
+constexpr uint8_t kNone      = 0xFF;
+
+static_assert(kPoolSlots < kNone, "slot indices are 8-bit with 0xFF as end-of-list");
+static_assert(kMsgCtrlReserve < kMsgQueueMin, "chat lane needs at least one slot");
+
+struct Fifo {
+  uint8_t head;
+  uint8_t tail;
+  uint8_t count;
+};
+
+Msg     g_pool[kPoolSlots];
+uint8_t g_next[kPoolSlots];                   // link to the next slot in the same list
+uint8_t g_free = kNone;
+Fifo    g_q[2][2];                            // [MsgDir][MsgLane]
+bool    g_init = false;
+
+volatile uint32_t g_cap   = 32;               // per direction; matches the TAG_BUF_SIZE default
+volatile uint32_t g_drops = 0;
+
+void init_once() {
+  if (g_init) return;
+  for (size_t k = 0; k < kPoolSlots; ++k) g_next[k] = static_cast<uint8_t>(k + 1 < kPoolSlots ? k + 1 : kNone);
+  g_free = 0;
+  for (auto& dir : g_q) for (auto& q : dir) q = Fifo{kNone, kNone, 0};
+  g_init = true;
+}
+
+uint8_t take(Fifo& q) {
+  const uint8_t k = q.head;
+  q.head = g_next[k];
+  if (q.head == kNone) q.tail = kNone;
+  --q.count;
+  return k;
+}
+
+void append(Fifo& q, uint8_t k) {
+  g_next[k] = kNone;
+  if (q.tail == kNone) q.head = k;
+  else g_next[q.tail] = k;
+  q.tail = k;
+  ++q.count;
+}
+
+void release(uint8_t k) {
+  g_next[k] = g_free;
+  g_free = k;
+}
+
+size_t depth_of(MsgDir dir) {
+  return g_q[dir][LANE_CTRL].count + g_q[dir][LANE_CHAT].count;
+}
+
+}  // namespace
+
+void node_msgq_set_capacity(size_t per_dir) {
+  if (per_dir < kMsgQueueMin) per_dir = kMsgQueueMin;
+  if (per_dir > kMsgQueueMax) per_dir = kMsgQueueMax;
+  g_cap = static_cast<uint32_t>(per_dir);
+}
+
+// -----------------------------------------------------------------------------
+// Ownership
+// -----------------------------------------------------------------------------
+Msg* node_msgq_alloc() {
+  init_once();
+  if (g_free == kNone) return nullptr;
+  const uint8_t k = g_free;
+  g_free = g_next[k];
+  return &g_pool[k];
+}
+
+void node_msgq_free(Msg* m) {
+  if (m) release(static_cast<uint8_t>(m - g_pool));
+}
+
+// -----------------------------------------------------------------------------
+// Enqueue
+// - Chat may use capacity minus the control reserve; control may use it all
+// - Inbound makes room by evicting its oldest chat message; outbound refuses
+// -----------------------------------------------------------------------------
+bool node_msgq_commit(MsgDir dir, Msg* m) {
+  init_once();
+  const uint8_t k = static_cast<uint8_t>(m - g_pool);
+  const MsgLane lane  = (m->lane == LANE_CTRL) ? LANE_CTRL : LANE_CHAT;
+  const size_t  limit = (lane == LANE_CTRL) ? g_cap : g_cap - kMsgCtrlReserve;
+  Fifo&         chat  = g_q[dir][LANE_CHAT];
+
+  while (depth_of(dir) >= limit) {
+    if (dir != MQ_IN || chat.count == 0) { g_drops = g_drops + 1; release(k); return false; }
+    release(take(chat));                      // freshest wins on the inbound side
+    g_drops = g_drops + 1;
+  }
+  m->lane = lane;
+  append(g_q[dir][lane], k);
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Dequeue: control lane first, FIFO within a lane
+// -----------------------------------------------------------------------------
+Msg* node_msgq_peek(MsgDir dir) {
+  if (!g_init) return nullptr;
+  const Fifo& ctrl = g_q[dir][LANE_CTRL];
+  if (ctrl.count) return &g_pool[ctrl.head];
+  const Fifo& chat = g_q[dir][LANE_CHAT];
+  return chat.count ? &g_pool[chat.head] : nullptr;
+}
+
+Msg* node_msgq_detach(MsgDir dir) {
+  if (!g_init) return nullptr;
+  Fifo& ctrl = g_q[dir][LANE_CTRL];
+  Fifo& chat = g_q[dir][LANE_CHAT];
+  if (ctrl.count) return &g_pool[take(ctrl)];
+  if (chat.count) return &g_pool[take(chat)];
+  return nullptr;
+}
+
+void node_msgq_pop(MsgDir dir) {
+  node_msgq_free(node_msgq_detach(dir));
+}
+
+size_t node_msgq_depth(MsgDir dir) {
+  return depth_of(dir);
+}
+
+size_t node_msgq_capacity() {
+  return g_cap;
+}
+
+uint32_t node_msgq_drops() {
+  return g_drops;
+}
+
+// -----------------------------------------------------------------------------
+// Host backpressure bits
+// - XOFF at 3/4 of the chat lane's room, so the host pauses before a refusal
+// - Level is outbound depth in quarters of capacity, saturating at 3
+// -----------------------------------------------------------------------------
+uint8_t node_msgq_flags() {
+  const size_t depth = depth_of(MQ_OUT);
+  const size_t cap   = g_cap;
+  const size_t chat  = cap - kMsgCtrlReserve;
+  size_t lvl = depth * 4 / cap;
+  if (lvl > 3) lvl = 3;
+  uint8_t f = static_cast<uint8_t>(lvl << kFlagQlvlShift) & FLAG_QLVL;
+  if (depth * 4 >= chat * 3) f |= FLAG_XOFF;
+  return f;
+}
@@ -0,0 +1,122 @@
+// -----------------------------------------------------------------------------
+// node_power.cpp
+// Implementation of the idle light sleep declared in node_power.hpp.
+//
+// Notes:
+//  * See node_power.hpp for the idle rule, wake sources, and host preamble.
+//  * The idle checks are all flag and counter reads; a pass that decides not
+//    to sleep costs a few microseconds.
+//  * UART TX is drained before sleeping: the UART clock stops in light sleep
+//    and a half-sent reply would reach the host corrupted.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_power.hpp"
+#include "node_protocol.hpp"    // node_protocol_idle_ms
+#include "node_radio.hpp"       // node_radio_idle, DIO0 wake arm/disarm
+#include "node_link.hpp"        // node_link_idle
+#include "node_msgq.hpp"        // node_msgq_depth
+#include "node_display.hpp"     // node_display_idle
+#include "node_interface.hpp"   // node_interface_idle
+#include "node_tasks.hpp"       // node_tasks_worker_idle
+#include "node_transport.hpp"   // kTransportWireless
+
+#include <Arduino.h>            // millis(), FreeRTOS notify
+#include <driver/uart.h>        // UART0 wake threshold, TX drain
+#include <esp_sleep.h>          // light sleep + wake sources
+#include <esp_timer.h>          // esp_timer_get_time (latency)
+
+static constexpr int kUartWakeEdges = 3;    // ESP32 minimum; three END bytes
+
+struct PowerStat {
+    uint32_t sleeps;
+    uint32_t slept_ms;
+    uint32_t wake_uart;
+    uint32_t wake_radio;
+    uint32_t wake_timer;
+    uint32_t lat_last_us;
+    uint32_t lat_max_us;
+};
+
+static uint8_t   s_mode        = PWR_AWAKE;
+static uint32_t  s_hold_until  = 0;         // millis(); no sleep before this
+static PowerStat s_stat;
+
+static void put_le32(uint8_t* out, uint32_t v) {
+    for (int j = 0; j < 4; ++j) out[j] = static_cast<uint8_t>(v >> (8 * j));
+}
+
+static bool node_idle() {
+    return node_protocol_idle_ms() >= kSleepQuietMs
+        && node_msgq_depth(MQ_OUT) == 0 && node_msgq_depth(MQ_IN) == 0
+        && node_link_idle()
+        && node_interface_idle() && node_display_idle()   // worker inputs before its flag
+        && node_tasks_worker_idle()
+        && node_radio_idle();
+}
+
+void node_power_set_mode(uint8_t mode) {
+    s_mode = (mode == PWR_LIGHT) ? PWR_LIGHT : PWR_AWAKE;
+}
+
+// -----------------------------------------------------------------------------
+// Sleep
+// - Bail out on anything pending, including a wake notification that raced
+//   the idle checks
+// - Arm wake sources, sleep, then classify the wake and measure the exit
+// -----------------------------------------------------------------------------
+bool node_power_try_sleep(uint32_t max_ms) {
+    if (kTransportWireless) return false;                 // Wi-Fi/BLE link: no wake source, drops the association
+    if (s_mode != PWR_LIGHT || max_ms < kSleepMinMs) return false;
+    if (static_cast<int32_t>(millis() - s_hold_until) < 0) return false;
+    if (!node_idle()) return false;
+    if (ulTaskNotifyTake(pdTRUE, 0) > 0) return true;    // UART/radio just notified us: go serve it
+
+    if (max_ms > kSleepMaxMs) max_ms = kSleepMaxMs;
+    uart_wait_tx_idle_polling(UART_NUM_0);
+    uart_set_wakeup_threshold(UART_NUM_0, kUartWakeEdges);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(max_ms) * 1000u);
+    node_radio_sleep_arm();
+
+    const int64_t t0  = esp_timer_get_time();
+    const int64_t due = t0 + static_cast<int64_t>(max_ms) * 1000;
+    esp_light_sleep_start();
+    const int64_t t1  = esp_timer_get_time();
+
+    node_radio_sleep_disarm();
+    const esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
+    ++s_stat.sleeps;
+    s_stat.slept_ms += static_cast<uint32_t>((t1 - t0) / 1000);
+    if (cause == ESP_SLEEP_WAKEUP_TIMER) {
+        ++s_stat.wake_timer;
+        const uint32_t lat = t1 > due ? static_cast<uint32_t>(t1 - due) : 0;
+        s_stat.lat_last_us = lat;
+        if (lat > s_stat.lat_max_us) s_stat.lat_max_us = lat;
+    } else {
+        if (cause == ESP_SLEEP_WAKEUP_UART) ++s_stat.wake_uart;
+        else ++s_stat.wake_radio;
+        s_hold_until = millis() + kSleepQuietMs;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Readout (transport task only, like the sleeps themselves)
+// -----------------------------------------------------------------------------
+void node_power_encode(uint8_t (&out)[kPowerStatWire]) {
+    put_le32(out + 0,  s_stat.sleeps);
+    put_le32(out + 4,  s_stat.slept_ms);
+    put_le32(out + 8,  s_stat.wake_uart);
+    put_le32(out + 12, s_stat.wake_radio);
+    put_le32(out + 16, s_stat.wake_timer);
+    put_le32(out + 20, s_stat.lat_last_us);
+    put_le32(out + 24, s_stat.lat_max_us);
+}
+
+void node_power_reset_stats() {
+    s_stat = PowerStat();
+}
@@ -5,34 +5,99 @@
 // Notes:
 //  * See node_protocol.hpp for API contract, design overview, and usage.
 //  * See tests/ (or examples/) for how frames are built and consumed.
-//  * This file is about mechanics: wiring SLIP/Serial, handler dispatch,
-//    and buffer details.
+//  * This file is about mechanics: serving the host links (node_transport),
+//    handler dispatch, reply routing, and buffer details.
 //
 // ----------------------------------------------------------------------------- 
 
 
 #include "node_protocol.hpp"     // ViaText protocol core (packet handling, send/receive, update loop)
 #include "node_interface.hpp"    // Node-specific interface layer (default RX callback: node_interface_on_packet)
+#include "node_frame.hpp"        // Pooled TX buffers (FrameWriter) for outbound frames
+#include "node_log.hpp"          // EV_BAUD_SWITCH / EV_BAUD_REVERT
+#include "node_stats.hpp"        // link counters (frames, bytes, malformed, overflow)
+#include "node_transport.hpp"    // SlipLink, UdpLink, BleUartPort, LinkId
 
 #include <Arduino.h>             // Arduino framework core (pin control, Serial, timing, etc.)
-#include <PacketSerial.h>        // Lightweight SLIP/packet framing library over serial
 #include <cstring>               // C string utilities (memcpy, memset, strlen, etc.)
 
 
-// Global SLIP transport (single shared PacketSerial instance for SLIP framing)
-static SLIPPacketSerial g_ps;  
+// Host links. Each has its own receive buffer sized for the largest inner
+// frame, FLAG_LEN16 included. Called by concrete type: no virtual dispatch.
+static SlipLink<HardwareSerial, Serial> g_usb;
+#if VT_TRANSPORT_UDP
+static UdpLink g_udp;
+#endif
+#if VT_TRANSPORT_BLE
+// Unnamed namespace, not `static`: same internal linkage, but GCC only takes a static
+// object as a reference template argument from -std=gnu++17 on; the core may use gnu++11.
+namespace { BleUartPort g_ble_port; }
+static SlipLink<BleUartPort, g_ble_port> g_ble;
+#endif
+
+// Link of the frame being dispatched, and the task dispatching it. A send
+// from that task while the handler runs is a reply and goes back there;
+// anything else (other tasks, unsolicited frames) goes to every link.
+static uint8_t      g_rx_link = LINK_NONE;
+static TaskHandle_t g_rx_task = nullptr;
 
 // Current handler (optional). If null, use node_interface_on_packet().
 static void (*g_handler)(const uint8_t* frame, size_t len) = nullptr;
 
-// PacketSerial callback: invoked whenever a full SLIP frame is received.
+// Serializes protocol_send() across tasks: two frames must never interleave
+// on the wire.
+static StaticSemaphore_t g_tx_lock_buf;
+static SemaphoreHandle_t g_tx_lock = nullptr;
+
+// Link rate (SET_BAUD). Written by the handler (pending) and by
+// node_protocol_update() (everything else); both run on the transport task.
+static const uint32_t kBaudRates[] = {
+    115200, 230400, 460800, 921600, 1000000, 1500000, 2000000,
+};
+static uint32_t g_baud          = kBaudDefault;
+static uint32_t g_baud_pending  = 0;      // 0 = no switch scheduled
+static bool     g_baud_trial    = false;  // current rate awaits a confirming frame
+static uint32_t g_baud_deadline = 0;      // millis() when an unconfirmed rate reverts
+static uint32_t g_last_rx_ms    = 0;      // millis() of the last non-empty frame (node_power)
+
+// Header present and declared body within the decoded bytes.
+static bool frame_well_formed(const uint8_t* f, size_t n) {
+    return n >= kFrameHdr && n >= frame_hdr_len(f) && frame_hdr_len(f) + frame_body_len(f) <= n;
+}
+
+// Drain TX at the old rate, then retune the UART. Holding the TX lock keeps
+// other tasks from starting a frame that would straddle the change.
+static void baud_apply(uint32_t baud) {
+    if (g_tx_lock) xSemaphoreTake(g_tx_lock, portMAX_DELAY);
+    Serial.flush();
+    Serial.updateBaudRate(baud);
+    if (g_tx_lock) xSemaphoreGive(g_tx_lock);
+    g_baud = baud;
+}
+
+// Link callback: invoked whenever a link has a complete inner frame.
 // This function routes the decoded packet to either a user-specified
-// handler (if installed) or falls back to the default ViaText handler.
+// handler (if installed) or falls back to the default ViaText handler,
+// with the source link recorded so replies find their way back.
 //
 // Parameters:
-//   buffer : pointer to the received SLIP frame payload
-//   size   : number of bytes in the payload
-static void on_slip_packet(const uint8_t* buffer, size_t size) {
+//   link   : LinkId the frame arrived on
+//   buffer : pointer to the decoded inner frame
+//   size   : number of bytes in the frame
+static void on_frame(uint8_t link, const uint8_t* buffer, size_t size) {
+    if (size == 0) return;              // nothing between two delimiters / empty datagram
+    node_stats_rx_frame(size);
+    g_last_rx_ms = millis();
+
+    // A well-formed frame proves the host talks at the trial rate. Garbage
+    // decoded at the wrong rate almost never passes this length check.
+    // Only the UART has a rate; other links must not confirm it.
+    const bool ok = frame_well_formed(buffer, size);
+    if (ok && link == LINK_USB) g_baud_trial = false;
+    if (!ok) node_stats_rx_malformed(); // still delivered: the handler answers RESP_ERR if it can
+
+    g_rx_link = link;
+    g_rx_task = xTaskGetCurrentTaskHandle();
     // If a custom handler is registered, forward the packet there
     if (g_handler) {
         g_handler(buffer, size);
@@ -40,27 +105,116 @@ static void on_slip_packet(const uint8_t* buffer, size_t size) {
         // Otherwise, pass the packet into the default node interface handler
         node_interface_on_packet(buffer, size);
     }
+    g_rx_task = nullptr;
+    g_rx_link = LINK_NONE;
+}
+
+// Fold a link's oversized-frame count into node_stats.
+template <typename Link>
+static void count_overflows(Link& link) {
+    for (uint32_t n = link.take_overflows(); n; --n) node_stats_rx_overflow();
 }
 
 // -----------------------------------------------------------------------------
 // Initialize the protocol transport
 // - Start the hardware serial port at the given baud rate
-// - Bind it to our PacketSerial instance
-// - Register the packet handler callback
+// - Bring up whichever wireless links the build selected
+// - Create the TX lock and the frame pool
 // -----------------------------------------------------------------------------
 void node_protocol_begin(unsigned long baud) {
+    Serial.setRxBufferSize(2 * kFrameMax); // 0) Room for a full frame at megabit rates (before begin)
     Serial.begin(baud);                   // 1) Open Serial at requested speed
-    g_ps.setStream(&Serial);              // 2) Attach Serial stream to PacketSerial
-    g_ps.setPacketHandler(&on_slip_packet); // 3) Tell PacketSerial what to do on full packet
+    g_baud = static_cast<uint32_t>(baud);
+#if VT_TRANSPORT_UDP
+    g_udp.begin();                        // 2) Wi-Fi association runs in the background
+#endif
+#if VT_TRANSPORT_BLE
+    g_ble_port.begin(VT_BLE_NAME);        // 3) GATT service + advertising
+#endif
+    if (!g_tx_lock) g_tx_lock = xSemaphoreCreateMutexStatic(&g_tx_lock_buf); // 4) TX serialization
+    node_frame_begin();                   // 5) TX buffer pool for FrameWriter
+}
+
+// -----------------------------------------------------------------------------
+// Register a "bytes arrived" notifier
+// - Runs from the UART driver's event task when RX data lands in the FIFO,
+//   and from the BLE host task on each GATT write
+// - Lets a sleeping transport task wake instead of polling (UDP is polled)
+// -----------------------------------------------------------------------------
+void node_protocol_on_rx(void (*notify)()) {
+    if (!notify) return;
+    Serial.onReceive(notify);
+#if VT_TRANSPORT_BLE
+    g_ble_port.on_rx(notify);
+#endif
 }
 
 // -----------------------------------------------------------------------------
 // Service routine for the protocol transport
 // - Should be called often (e.g., each loop() tick)
-// - Pulls in any new serial bytes and fires callbacks if a full frame arrives
+// - Pulls in whatever each link holds and fires the handler per full frame
+// - Then applies a SET_BAUD switch the handlers scheduled, or reverts an
+//   unconfirmed one whose window has run out
 // -----------------------------------------------------------------------------
 void node_protocol_update() {
-    g_ps.update();  // Non-blocking pump of the PacketSerial state machine
+    g_usb.update([](const uint8_t* f, size_t n) { on_frame(LINK_USB, f, n); });
+    count_overflows(g_usb);
+#if VT_TRANSPORT_UDP
+    g_udp.update([](const uint8_t* f, size_t n) { on_frame(LINK_UDP, f, n); });
+    count_overflows(g_udp);
+#endif
+#if VT_TRANSPORT_BLE
+    g_ble.update([](const uint8_t* f, size_t n) { on_frame(LINK_BLE, f, n); });
+    count_overflows(g_ble);
+#endif
+
+    if (g_baud_pending) {
+        const uint32_t from = g_baud;
+        baud_apply(g_baud_pending);
+        g_baud_pending  = 0;
+        g_baud_trial    = (g_baud != kBaudDefault);
+        g_baud_deadline = millis() + kBaudConfirmMs;
+        node_log(LVL_INFO, EV_BAUD_SWITCH, g_baud, from);
+    } else if (g_baud_trial && static_cast<int32_t>(millis() - g_baud_deadline) >= 0) {
+        const uint32_t from = g_baud;
+        g_baud_trial = false;
+        baud_apply(kBaudDefault);
+        node_log(LVL_WARN, EV_BAUD_REVERT, from);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Link rate (SET_BAUD)
+// - Handlers only schedule; node_protocol_update() switches once the reply
+//   that accepted the request has been written
+// -----------------------------------------------------------------------------
+bool node_protocol_baud_supported(uint32_t baud) {
+    for (size_t k = 0; k < sizeof(kBaudRates) / sizeof(kBaudRates[0]); ++k) {
+        if (kBaudRates[k] == baud) return true;
+    }
+    return false;
+}
+
+bool node_protocol_set_baud(uint32_t baud) {
+    if (!node_protocol_baud_supported(baud)) return false;
+    g_baud_pending = baud;
+    return true;
+}
+
+uint32_t node_protocol_baud() {
+    return g_baud;
+}
+
+uint32_t node_protocol_idle_ms() {
+    if (g_usb.pending() || g_baud_pending || g_baud_trial) return 0;
+#if VT_TRANSPORT_BLE
+    if (g_ble.pending()) return 0;
+#endif
+    return millis() - g_last_rx_ms;
+}
+
+uint8_t node_protocol_link() {
+    return (g_rx_task && g_rx_task == xTaskGetCurrentTaskHandle()) ? g_rx_link : static_cast<uint8_t>(LINK_NONE);
 }
 
 // -----------------------------------------------------------------------------
@@ -75,10 +229,25 @@ void node_protocol_set_handler(void (*handler)(const uint8_t* frame, size_t len)
 // -----------------------------------------------------------------------------
 // Send a complete inner frame
 // - Caller provides an already-built frame (verb/flags/seq/tlv_len + body)
-// - We hand it to PacketSerial, which SLIP-encodes and pushes it to Serial
+// - A reply (sent by the dispatching task inside its handler) goes to the
+//   link the request came from; anything else goes to every link with a
+//   host. The UART always counts as having one.
+// - Each link encodes straight from the caller's buffer (SLIP through a
+//   small staging chunk, or one datagram)
 // -----------------------------------------------------------------------------
 void protocol_send(const uint8_t* frame, size_t len) {
-    g_ps.send(frame, len);  // SLIP-encode + write out on Serial
+    size_t wire = 0;                    // link bytes written, for node_stats
+    if (g_tx_lock) xSemaphoreTake(g_tx_lock, portMAX_DELAY);
+    const uint8_t to = node_protocol_link();
+    if (to == LINK_NONE || to == LINK_USB) wire += g_usb.send(frame, len);
+#if VT_TRANSPORT_UDP
+    if (to == LINK_UDP || (to == LINK_NONE && g_udp)) wire += g_udp.send(frame, len);
+#endif
+#if VT_TRANSPORT_BLE
+    if (to == LINK_BLE || (to == LINK_NONE && g_ble)) wire += g_ble.send(frame, len);
+#endif
+    if (g_tx_lock) xSemaphoreGive(g_tx_lock);
+    if (len) node_stats_tx_frame(frame[0], wire);
 }
 
 // -----------------------------------------------------------------------------
@@ -88,23 +257,8 @@ void protocol_send(const uint8_t* frame, size_t len) {
 // -----------------------------------------------------------------------------
 void node_protocol_send_text(const char* s) {
     if (!s) return;                     // Guard against null pointers
-    size_t n = strnlen(s, 255);         // Clamp length to 255 bytes max
-    uint8_t b[4 + 255];                 // Header (4) + payload (up to 255)
-    size_t  i = 0;
-
-    // ---- Frame header ----
-    b[i++] = Verb::MSG;                 // verb = MSG
-    b[i++] = 0;                         // flags = 0
-    b[i++] = 0;                         // seq = 0 (unused for unsolicited MSG)
-    b[i++] = static_cast<uint8_t>(n);   // TLV_LEN = length of payload
-
-    // ---- Copy payload ----
-    if (n) {
-        memcpy(b + i, s, n);            // copy string into frame buffer
-        i += n;                         // advance index
-    }
-
-    // ---- Transmit ----
-    protocol_send(b, i);                // send complete frame via SLIP
+    size_t n = strnlen(s, kFrameMax - kFrameHdr16); // Clamp to one frame
+    FrameWriter w(Verb::MSG, 0, n > 255);           // classic header whenever it fits; seq = 0
+    w.raw(s, n);                        // MSG payload is raw bytes, not TLV
+    w.send();                           // SLIP-encode straight from the pool slot
 }
-
@@ -0,0 +1,628 @@
+/**
+ * @file node_radio.cpp
+ * @brief Implementation for node_radio.hpp (SX127x driver, rings, radio task).
+ *
+ * Notes:
+ * - API/overview lives in node_radio.hpp. Keep this file focused on "how".
+ * - The radio task is the only code that touches SPI after begin(). Everyone
+ *   else talks to it through the rings and the pending-config mailbox.
+ * - The task is a small phase machine (Phase below): RX on a fixed channel,
+ *   or scan/dwell when hopping, with an LBT CAD in front of every TX.
+ * - Rings carry buffer pointers both ways: g_rx_free (lent, empty) and g_rx
+ *   (filled) for RX, g_tx (packet or reference) and g_tx_done (references
+ *   the radio is finished with) for TX.
+ * - Style: block-by-block reasoning; only line comments where maintainers trip.
+ */
+
+#include "node_radio.hpp"       // Public API surface; keep LoRa/SPI types out of the header.
+#include "node_ring.hpp"        // SpscRing<T,N> for RX/TX handoff
+#include "node_log.hpp"         // binary event log (RX overflow)
+
+/* Arduino core (ESP32). Repo: https://github.com/espressif/arduino-esp32 */
+#include <Arduino.h>            // pins, interrupts, FreeRTOS task API, esp_random()
+#include <SPI.h>                // SX127x register access
+
+/* SX127x driver. Repo: https://github.com/sandeepmistry/arduino-LoRa */
+#include <LoRa.h>               // begin, modem setters, packet framing
+#include <driver/gpio.h>        // DIO0 as a light-sleep wake source
+
+#include <cstring>              // memcpy
+
+/*------------------------------------------------------------------------------
+  Internal state
+  --------------
+  Pins are the TTGO LoRa32 V2.1 (T3 1.6.x) wiring. Register numbers and IRQ
+  masks are from the SX1276/77/78/79 datasheet; the LoRa library keeps its own
+  copies private, so the few we need for IRQ handling are restated here.
+------------------------------------------------------------------------------*/
+namespace {
+constexpr int kPinSck  = 5;
+constexpr int kPinMiso = 19;
+constexpr int kPinMosi = 27;
+constexpr int kPinSs   = 18;
+constexpr int kPinRst  = 23;     // Some early V2.1 boards route reset to GPIO 14
+constexpr int kPinDio0 = 26;
+
+constexpr uint8_t REG_FIFO                 = 0x00;
+constexpr uint8_t REG_OP_MODE              = 0x01;
+constexpr uint8_t REG_FIFO_ADDR_PTR        = 0x0D;
+constexpr uint8_t REG_FIFO_RX_CURRENT_ADDR = 0x10;
+constexpr uint8_t REG_IRQ_FLAGS            = 0x12;
+constexpr uint8_t REG_RX_NB_BYTES          = 0x13;
+constexpr uint8_t REG_MODEM_STAT           = 0x18;
+constexpr uint8_t REG_DIO_MAPPING_1        = 0x40;
+
+constexpr uint8_t IRQ_CAD_DETECTED = 0x01;
+constexpr uint8_t IRQ_CAD_DONE    = 0x04;
+constexpr uint8_t IRQ_TX_DONE     = 0x08;
+constexpr uint8_t IRQ_CRC_ERROR   = 0x20;
+constexpr uint8_t IRQ_RX_DONE     = 0x40;
+
+constexpr uint8_t DIO0_TX_DONE    = 0x40;   // RegDioMapping1 bits 7..6 = 01
+constexpr uint8_t DIO0_CAD_DONE   = 0x80;   // RegDioMapping1 bits 7..6 = 10
+
+constexpr uint8_t MODE_LONG_RANGE = 0x80;   // RegOpMode: LoRa
+constexpr uint8_t MODE_CAD        = 0x07;
+
+constexpr uint8_t STAT_SIGNAL     = 0x01;   // RegModemStat: preamble energy seen
+constexpr uint8_t STAT_HEADER     = 0x08;   // RegModemStat: a header arrived, payload follows
+
+constexpr uint32_t kTaskStack     = 3072;
+constexpr UBaseType_t kTaskPrio   = 5;      // above vt_work (2); radio must not wait on slow work
+constexpr BaseType_t  kTaskCore   = 0;
+constexpr uint32_t kIdleWakeMs    = 100;    // safety poll in case an edge was missed
+constexpr uint32_t kTxTimeoutMs   = 10000;  // > worst-case SF12 airtime for 255 bytes
+
+constexpr uint16_t kPreambleSyms    = 8;    // LoRa default, fixed-channel mode
+constexpr uint16_t kScanSymsPerChan = 3;    // one CAD (~2 symbols) + retune + task latency
+constexpr uint32_t kDwellSyms       = 12;   // after the preamble: sync word + header
+constexpr uint32_t kLbtSlotSyms     = 16;   // one backoff slot
+constexpr uint32_t kLbtCapShift     = 4;    // backoff spread stops doubling at 16 slots
+constexpr uint32_t kCadTimeoutSyms  = 8;    // CadDone overdue (plus kCadSlackMs): start over
+constexpr uint32_t kCadSlackMs      = 20;
+
+// What the modem is doing. Radio task only.
+enum Phase : uint8_t {
+  PH_RX,      // continuous RX on the fixed channel
+  PH_SCAN,    // hop mode: CAD on g_scan_ch
+  PH_DWELL,   // hop mode: continuous RX where a scan CAD saw a preamble
+  PH_LBT,     // CAD on the TX channel, g_tx head waiting on the result
+  PH_TX       // packet on air (g_tx_busy)
+};
+
+struct TxSlot {
+  uint8_t        len;
+  const uint8_t* ref;                       // node_radio_send_ref(): read from here, not data[]
+  void*          owner;
+  uint8_t        data[kRadioMaxPayload];
+};
+
+struct TxDone {
+  void* owner;
+  bool  aired;                              // false: dropped after kRadioTxStarts refused starts
+};
+
+struct RxLoan {
+  uint8_t* buf;
+  void*    owner;
+};
+
+// kRadioRxSlots buffers absorb bursts while SLIP is busy; a lent buffer is
+// in g_rx_free or g_rx, never both, so g_rx cannot overflow.
+SpscRing<RxLoan, kRadioRxSlots>      g_rx_free;   // producer: transport task, consumer: radio task
+SpscRing<RadioPacket, kRadioRxSlots> g_rx;        // producer: radio task,     consumer: transport task
+SpscRing<TxSlot, kRadioTxSlots>      g_tx;        // producer: transport task, consumer: radio task
+SpscRing<TxDone, kRadioTxSlots>      g_tx_done;   // producer: radio task,     consumer: transport task
+size_t g_tx_refs = 0;                             // transport task only: references not yet returned
+
+TaskHandle_t g_task = nullptr;
+bool         g_ok   = false;
+void       (*g_rx_notify)() = nullptr;        // consumer wakeup, set once at boot
+
+// Radio-task-only modem state (g_tx_busy is also polled by node_radio_idle()).
+volatile bool g_tx_busy = false;
+volatile bool g_task_busy = false;            // radio task is between wakeups (SPI may be live)
+RadioConfig g_live       = {};                // what the chip is set to
+Phase    g_phase         = PH_RX;
+uint32_t g_phase_ms      = 0;                 // millis() the phase began (watchdogs)
+uint32_t g_dwell_ms      = 0;                 // PH_DWELL: give up after this long
+uint8_t  g_scan_ch       = 0;
+uint8_t  g_lbt_tries     = 0;                 // busy checks for the head of g_tx
+uint8_t  g_tx_starts     = 0;                 // refused TX starts for the head of g_tx
+uint32_t g_backoff_until = 0;                 // millis() the next LBT may start
+
+// Pending configuration mailbox (writer: caller, reader: radio task).
+portMUX_TYPE g_cfg_mux     = portMUX_INITIALIZER_UNLOCKED;
+RadioConfig  g_cfg_pending = {};
+bool         g_cfg_dirty   = false;
+
+// Latched metrics; single writer (radio task), word-sized reads elsewhere.
+volatile int16_t  g_last_rssi  = 0;
+volatile int8_t   g_last_snr   = 0;
+volatile uint32_t g_rx_dropped = 0;
+
+// Channel access counters (TAG_STAT_RADIO); written by the radio task only.
+struct RadioStat {
+  uint32_t lbt_checks;                        // CADs before a transmit
+  uint32_t lbt_busy;                          // ...that deferred it
+  uint32_t lbt_forced;                        // sent busy after kLbtMaxTries
+  uint32_t backoff_ms;                        // total deferral
+  uint32_t scan_cads;                         // hop-mode receive CADs
+  uint32_t scan_hits;                         // ...that found a preamble
+  uint32_t tx_refused;                        // beginPacket() said no (TX still in progress)
+  uint32_t tx_dropped;                        // ...kRadioTxStarts times for one packet
+};
+RadioStat g_stat = {};
+
+const SPISettings kSpi(8000000, MSBFIRST, SPI_MODE0);   // Same settings the LoRa library uses
+
+inline void wake_task() {
+  if (g_task) xTaskNotifyGive(g_task);
+}
+
+inline bool hopping() { return g_live.chan == kRadioChanHop; }
+
+// Length of n symbols at the live SF/BW, rounded up to whole ms.
+uint32_t syms_ms(uint32_t n) {
+  const uint32_t bw     = g_live.bw_hz < 7800 ? 7800 : g_live.bw_hz;
+  const uint32_t sym_us = (1u << g_live.sf) * 1000000u / bw;
+  return (n * sym_us + 999) / 1000;
+}
+
+void put_le32(uint8_t* out, uint32_t v) {
+  out[0] = static_cast<uint8_t>(v);
+  out[1] = static_cast<uint8_t>(v >> 8);
+  out[2] = static_cast<uint8_t>(v >> 16);
+  out[3] = static_cast<uint8_t>(v >> 24);
+}
+} // namespace
+
+/*------------------------------------------------------------------------------
+  Register access
+  ---------------
+  Minimal SX127x SPI helpers for the IRQ/FIFO registers the library hides.
+  Only the radio task calls these, so the bus never sees interleaved users.
+------------------------------------------------------------------------------*/
+static uint8_t sx_read(uint8_t reg) {
+  SPI.beginTransaction(kSpi);
+  digitalWrite(kPinSs, LOW);
+  SPI.transfer(reg & 0x7F);                   // MSB clear = read
+  uint8_t v = SPI.transfer(0x00);
+  digitalWrite(kPinSs, HIGH);
+  SPI.endTransaction();
+  return v;
+}
+
+static void sx_write(uint8_t reg, uint8_t v) {
+  SPI.beginTransaction(kSpi);
+  digitalWrite(kPinSs, LOW);
+  SPI.transfer(reg | 0x80);                   // MSB set = write
+  SPI.transfer(v);
+  digitalWrite(kPinSs, HIGH);
+  SPI.endTransaction();
+}
+
+// Burst-read n bytes from the FIFO at the current FIFO pointer (one CS window).
+static void sx_read_fifo(uint8_t* dst, uint8_t n) {
+  SPI.beginTransaction(kSpi);
+  digitalWrite(kPinSs, LOW);
+  SPI.transfer(REG_FIFO & 0x7F);
+  for (uint8_t i = 0; i < n; ++i) dst[i] = SPI.transfer(0x00);
+  digitalWrite(kPinSs, HIGH);
+  SPI.endTransaction();
+}
+
+/*------------------------------------------------------------------------------
+  start_cad / listen
+  ------------------
+  A CAD takes about two symbols and raises CadDone (and CadDetected if it saw
+  a preamble) on DIO0; the chip then drops back to standby by itself. Only
+  hop mode retunes per CAD. Stale CAD flags are cleared first: a CAD cut
+  short by the next one must not answer for it.
+  listen() is where every phase ends: continuous RX, or the scan when hopping.
+------------------------------------------------------------------------------*/
+static void start_cad(Phase ph, uint8_t ch) {
+  LoRa.idle();
+  if (hopping()) LoRa.setFrequency(node_radio_chan_freq(g_live, ch));
+  sx_write(REG_IRQ_FLAGS, IRQ_CAD_DONE | IRQ_CAD_DETECTED);
+  sx_write(REG_DIO_MAPPING_1, DIO0_CAD_DONE);
+  sx_write(REG_OP_MODE, MODE_LONG_RANGE | MODE_CAD);
+  ++(ph == PH_LBT ? g_stat.lbt_checks : g_stat.scan_cads);
+  g_phase    = ph;
+  g_phase_ms = millis();
+}
+
+static void listen() {
+  if (hopping()) { start_cad(PH_SCAN, g_scan_ch); return; }
+  LoRa.receive();                             // DIO0 = RxDone again
+  g_phase = PH_RX;
+}
+
+/*------------------------------------------------------------------------------
+  apply_config
+  ------------
+  Push a full parameter set into the modem. Standby first so the writes land
+  cleanly, then back to listening. The preamble follows the mode: a hopping
+  node's packets must outlast a scan round.
+------------------------------------------------------------------------------*/
+static void apply_config(const RadioConfig& cfg) {
+  g_live = cfg;
+  LoRa.idle();
+  LoRa.setFrequency(node_radio_chan_freq(cfg, cfg.chan));
+  LoRa.setSpreadingFactor(cfg.sf);            // Library also updates the LDRO flag
+  LoRa.setSignalBandwidth(cfg.bw_hz);
+  LoRa.setCodingRate4(cfg.cr);
+  LoRa.setTxPower(cfg.tx_pwr);
+  LoRa.setPreambleLength(node_radio_preamble(cfg));
+  listen();
+}
+
+/*------------------------------------------------------------------------------
+  drain_rx
+  --------
+  RxDone handler: burst the packet straight from the FIFO into the next lent
+  buffer and pass it on through the RX ring. With no buffer lent we still
+  latch metrics and count the drop; the FIFO pointer simply moves on with the
+  next packet.
+------------------------------------------------------------------------------*/
+static void drain_rx() {
+  const uint8_t n     = sx_read(REG_RX_NB_BYTES);
+  const int16_t rssi  = static_cast<int16_t>(LoRa.packetRssi());
+  const float   snr_f = LoRa.packetSnr();
+  const int8_t  snr   = static_cast<int8_t>(snr_f < 0 ? snr_f - 0.5f : snr_f + 0.5f);
+  g_last_rssi = rssi;
+  g_last_snr  = snr;
+
+  const RxLoan* loan = g_rx_free.read_slot();
+  RadioPacket*  slot = g_rx.write_slot();     // never null while a loan exists (see g_rx_free)
+  if (!loan || !slot) {
+    g_rx_dropped = g_rx_dropped + 1;
+    node_log(LVL_WARN, EV_RADIO_RX_DROP, g_rx_dropped);
+    return;
+  }
+
+  sx_write(REG_FIFO_ADDR_PTR, sx_read(REG_FIFO_RX_CURRENT_ADDR));
+  sx_read_fifo(loan->buf, n);
+  slot->len      = n;
+  slot->rssi_dbm = rssi;
+  slot->snr_db   = snr;
+  slot->data     = loan->buf;
+  slot->owner    = loan->owner;
+  g_rx.commit();                              // before the release: never counted in neither ring
+  g_rx_free.release();
+  if (g_rx_notify) g_rx_notify();
+}
+
+/*------------------------------------------------------------------------------
+  start_tx
+  --------
+  Load the oldest TX slot into the FIFO and start an async transmit on the
+  channel LBT just checked. DIO0 is remapped to TxDone so the same ISR wakes
+  us when the packet has left. A referenced buffer is returned as soon as
+  the FIFO holds its bytes: the packet on air no longer needs it. g_tx_done
+  has room for every reference the producer may have out.
+  A refused start (the chip still reports a transmit) keeps the slot and
+  backs off one LBT slot; only kRadioTxStarts refusals in a row drop it,
+  and then the owner hears it was not sent.
+------------------------------------------------------------------------------*/
+static void start_tx() {
+  const TxSlot* s = g_tx.read_slot();
+  if (!s) return;
+  const bool aired = LoRa.beginPacket() == 1; // standby + FIFO ptr -> TX base
+  if (aired) {
+    LoRa.write(s->ref ? s->ref : s->data, s->len);
+    sx_write(REG_DIO_MAPPING_1, DIO0_TX_DONE);
+    LoRa.endPacket(/*async=*/true);
+    g_tx_busy  = true;
+    g_phase    = PH_TX;
+    g_phase_ms = millis();
+  } else {
+    ++g_stat.tx_refused;
+    if (++g_tx_starts < kRadioTxStarts) {
+      g_backoff_until = millis() + syms_ms(kLbtSlotSyms);
+      return;                                 // head stays; LBT runs again after the slot
+    }
+    ++g_stat.tx_dropped;
+    node_log(LVL_WARN, EV_RADIO_TX_DROP, s->len, g_tx_starts);
+  }
+  g_tx_starts = 0;
+  if (s->ref) {
+    *g_tx_done.write_slot() = TxDone{s->owner, aired};
+    g_tx_done.commit();
+  }
+  g_tx.release();
+}
+
+/*------------------------------------------------------------------------------
+  Listen before talk
+  ------------------
+  begin_lbt() checks the channel the head of g_tx will use: hop mode draws a
+  random plan channel per attempt. A packet already coming in counts as busy
+  without a CAD. defer() is the randomized exponential backoff; the radio
+  listens meanwhile, since the traffic may well be for us.
+------------------------------------------------------------------------------*/
+static void defer(uint32_t now) {
+  ++g_lbt_tries;
+  ++g_stat.lbt_busy;
+  const uint32_t shift = g_lbt_tries < kLbtCapShift ? g_lbt_tries : kLbtCapShift;
+  const uint32_t wait  = (1 + esp_random() % (1u << shift)) * syms_ms(kLbtSlotSyms);
+  g_backoff_until = now + wait;
+  g_stat.backoff_ms += wait;
+}
+
+static void begin_lbt(uint32_t now) {
+  if (g_phase == PH_RX && g_lbt_tries < kLbtMaxTries &&
+      (sx_read(REG_MODEM_STAT) & (STAT_SIGNAL | STAT_HEADER))) {
+    defer(now);
+    return;
+  }
+  start_cad(PH_LBT, hopping() ? static_cast<uint8_t>(esp_random() % kRadioChanCount) : g_live.chan);
+}
+
+/*------------------------------------------------------------------------------
+  cad_done
+  --------
+  LBT: clear -> transmit; busy -> back off, or transmit anyway once the
+  tries are used up. Scan: a preamble -> dwell in RX on that channel until
+  RxDone (or the dwell watchdog); nothing -> CAD on the next channel.
+------------------------------------------------------------------------------*/
+static void cad_done(bool detected, uint32_t now) {
+  if (g_phase == PH_LBT) {
+    if (detected && g_lbt_tries < kLbtMaxTries) { defer(now); listen(); return; }
+    if (detected) ++g_stat.lbt_forced;
+    g_lbt_tries = 0;
+    start_tx();
+    if (!g_tx_busy) listen();
+    return;
+  }
+  if (g_phase != PH_SCAN) return;
+  if (detected) {
+    ++g_stat.scan_hits;
+    LoRa.receive();                           // still tuned to g_scan_ch
+    g_phase    = PH_DWELL;
+    g_phase_ms = now;
+    g_dwell_ms = syms_ms(node_radio_preamble(g_live) + kDwellSyms);
+    return;
+  }
+  g_scan_ch = static_cast<uint8_t>((g_scan_ch + 1) % kRadioChanCount);
+  start_cad(PH_SCAN, g_scan_ch);
+}
+
+// Sleep no longer than the next deadline the task must act on by itself.
+static uint32_t next_wake_ms(uint32_t now) {
+  uint32_t ms = kIdleWakeMs;
+  const int32_t dwell   = static_cast<int32_t>(g_phase_ms + g_dwell_ms - now);
+  const int32_t backoff = static_cast<int32_t>(g_backoff_until - now);
+  if (g_phase == PH_DWELL && dwell > 0 && static_cast<uint32_t>(dwell) < ms) ms = dwell;
+  if (!g_tx.empty() && backoff > 0 && static_cast<uint32_t>(backoff) < ms) ms = backoff;
+  return ms;
+}
+
+/*------------------------------------------------------------------------------
+  radio_task
+  ----------
+  Sleeps until DIO0, a new TX, a config change, or its next deadline wakes
+  it. Each pass:
+  1) Read and clear IRQ flags; finish TX, drain RX, act on a CAD result.
+  2) Watchdogs: a TX or CAD that never reports done, or a dwell that never
+     turned into a packet, goes back to listening.
+  3) While only listening: apply pending config, then start LBT for the
+     next TX once its backoff is over.
+------------------------------------------------------------------------------*/
+static void radio_task(void*) {
+  for (;;) {
+    g_task_busy = false;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(next_wake_ms(millis())));
+    g_task_busy = true;
+    const uint32_t now = millis();
+
+    // Phase 1: IRQ service
+    const uint8_t flags = sx_read(REG_IRQ_FLAGS);
+    if (flags) {
+      sx_write(REG_IRQ_FLAGS, flags);         // write-1-to-clear what we saw
+      if (flags & IRQ_TX_DONE) { g_tx_busy = false; listen(); }
+      if (flags & IRQ_RX_DONE) {
+        if (!(flags & IRQ_CRC_ERROR)) drain_rx();
+        if (g_phase == PH_DWELL) listen();    // packet over: back to the scan
+      }
+      if (flags & IRQ_CAD_DONE) cad_done(flags & IRQ_CAD_DETECTED, now);
+    }
+
+    // Phase 2: watchdogs
+    const uint32_t age = now - g_phase_ms;
+    if (g_phase == PH_TX && age > kTxTimeoutMs) {
+      g_tx_busy = false;
+      listen();
+    } else if ((g_phase == PH_SCAN || g_phase == PH_LBT) && age > syms_ms(kCadTimeoutSyms) + kCadSlackMs) {
+      listen();                               // lost CadDone; LBT simply runs again
+    } else if (g_phase == PH_DWELL && age > g_dwell_ms) {
+      if (sx_read(REG_MODEM_STAT) & STAT_HEADER) { g_phase_ms = now; g_dwell_ms = kTxTimeoutMs; }
+      else listen();                          // false alarm, or it was not LoRa
+    }
+
+    // Phase 3: config + next TX, only while listening
+    if (g_phase == PH_RX || g_phase == PH_SCAN) {
+      RadioConfig cfg;
+      bool dirty;
+      portENTER_CRITICAL(&g_cfg_mux);
+      dirty = g_cfg_dirty;
+      cfg   = g_cfg_pending;
+      g_cfg_dirty = false;
+      portEXIT_CRITICAL(&g_cfg_mux);
+      if (dirty) apply_config(cfg);
+      if (!g_tx.empty() && static_cast<int32_t>(now - g_backoff_until) >= 0) begin_lbt(now);
+    }
+  }
+}
+
+// DIO0 rising edge: defer everything to the radio task.
+static void IRAM_ATTR on_dio0() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(g_task, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+/*------------------------------------------------------------------------------
+  node_radio_begin
+  ----------------
+  Phases:
+  1) Route SPI to the LoRa pins and probe the chip (LoRa.begin checks the
+     silicon version register).
+  2) Enable CRC so corrupted packets are flagged instead of delivered.
+  3) Apply the full config, start the radio task, then attach DIO0.
+------------------------------------------------------------------------------*/
+bool node_radio_begin(const RadioConfig& cfg) {
+  // Phase 1: bus + probe
+  SPI.begin(kPinSck, kPinMiso, kPinMosi, kPinSs);
+  LoRa.setPins(kPinSs, kPinRst, kPinDio0);
+  g_ok = LoRa.begin(cfg.freq_hz) == 1;
+  if (!g_ok) return false;
+
+  // Phase 2: integrity
+  LoRa.enableCrc();
+
+  // Phase 3: config, task, interrupt (task first so the ISR has a target)
+  apply_config(cfg);
+  xTaskCreatePinnedToCore(radio_task, "vt_radio", kTaskStack, nullptr, kTaskPrio, &g_task, kTaskCore);
+  pinMode(kPinDio0, INPUT);
+  attachInterrupt(digitalPinToInterrupt(kPinDio0), on_dio0, RISING);
+  return true;
+}
+
+bool node_radio_available() {
+  return g_ok;
+}
+
+bool node_radio_idle() {
+  if (!g_ok) return true;
+  // Task flag last: if the task ran during the other reads, it is still
+  // running now or it has already notified the consumer.
+  return digitalRead(kPinDio0) == LOW && !g_tx_busy && g_tx.empty() && g_tx_done.empty() && g_rx.empty()
+      && !g_task_busy;
+}
+
+/*------------------------------------------------------------------------------
+  Light-sleep hooks (node_power)
+  ------------------------------
+  GPIO wakeup needs a level trigger, which would storm the edge ISR once the
+  CPU runs again. So the pin's interrupt is masked for the sleep, armed as a
+  high-level wake source, and restored to RISING afterwards. The radio task
+  is kicked on the way out: an RxDone that woke us never produced an edge.
+------------------------------------------------------------------------------*/
+void node_radio_sleep_arm() {
+  if (!g_ok) return;
+  const gpio_num_t pin = static_cast<gpio_num_t>(kPinDio0);
+  gpio_intr_disable(pin);
+  gpio_wakeup_enable(pin, GPIO_INTR_HIGH_LEVEL);
+}
+
+void node_radio_sleep_disarm() {
+  if (!g_ok) return;
+  const gpio_num_t pin = static_cast<gpio_num_t>(kPinDio0);
+  gpio_wakeup_disable(pin);
+  gpio_set_intr_type(pin, GPIO_INTR_POSEDGE);
+  gpio_intr_enable(pin);
+  wake_task();
+}
+
+void node_radio_configure(const RadioConfig& cfg) {
+  if (!g_ok) return;
+  portENTER_CRITICAL(&g_cfg_mux);
+  g_cfg_pending = cfg;                        // latest wins
+  g_cfg_dirty   = true;
+  portEXIT_CRITICAL(&g_cfg_mux);
+  wake_task();
+}
+
+bool node_radio_send(const uint8_t* data, size_t len) {
+  if (!g_ok || !data || len == 0 || len > kRadioMaxPayload) return false;
+  TxSlot* s = g_tx.write_slot();
+  if (!s) return false;                       // backpressure: TX ring full
+  memcpy(s->data, data, len);
+  s->len = static_cast<uint8_t>(len);
+  s->ref = nullptr;
+  g_tx.commit();
+  wake_task();
+  return true;
+}
+
+bool node_radio_tx_ready() {
+  return g_ok && !g_tx.full() && g_tx_refs < kRadioTxSlots;
+}
+
+bool node_radio_send_ref(const uint8_t* data, size_t len, void* owner) {
+  if (!data || len == 0 || len > kRadioMaxPayload || !node_radio_tx_ready()) return false;
+  TxSlot* s = g_tx.write_slot();
+  s->len   = static_cast<uint8_t>(len);
+  s->ref   = data;                            // no copy: start_tx() reads the caller's bytes
+  s->owner = owner;
+  ++g_tx_refs;
+  g_tx.commit();
+  wake_task();
+  return true;
+}
+
+bool node_radio_sent(void*& owner, bool& aired) {
+  const TxDone* p = g_tx_done.read_slot();
+  if (!p) return false;
+  owner = p->owner;
+  aired = p->aired;
+  g_tx_done.release();
+  --g_tx_refs;
+  return true;
+}
+
+bool node_radio_wants_rx() {
+  return g_ok && g_rx_free.size() + g_rx.size() < kRadioRxSlots;
+}
+
+bool node_radio_lend_rx(uint8_t* buf, void* owner) {
+  if (!buf || !node_radio_wants_rx()) return false;
+  *g_rx_free.write_slot() = RxLoan{buf, owner};
+  g_rx_free.commit();
+  return true;
+}
+
+bool node_radio_receive(RadioPacket& out) {
+  const RadioPacket* p = g_rx.read_slot();
+  if (!p) return false;
+  out = *p;                                   // metadata only: the bytes are where the FIFO put them
+  g_rx.release();
+  return true;
+}
+
+void node_radio_on_rx(void (*notify)()) {
+  g_rx_notify = notify;
+}
+
+int16_t  node_radio_last_rssi()  { return g_last_rssi; }
+int8_t   node_radio_last_snr()   { return g_last_snr; }
+uint32_t node_radio_rx_dropped() { return g_rx_dropped; }
+
+uint32_t node_radio_chan_step(uint32_t bw_hz) {
+  return bw_hz / 5 * 8;
+}
+
+uint32_t node_radio_chan_freq(const RadioConfig& cfg, uint8_t chan) {
+  const uint32_t k = chan == kRadioChanHop ? 0 : chan % kRadioChanCount;
+  return cfg.freq_hz + k * node_radio_chan_step(cfg.bw_hz);
+}
+
+uint16_t node_radio_preamble(const RadioConfig& cfg) {
+  return cfg.chan == kRadioChanHop ? kPreambleSyms + kScanSymsPerChan * kRadioChanCount : kPreambleSyms;
+}
+
+void node_radio_encode(uint8_t (&out)[kRadioStatWire]) {
+  put_le32(out + 0,  g_stat.lbt_checks);
+  put_le32(out + 4,  g_stat.lbt_busy);
+  put_le32(out + 8,  g_stat.lbt_forced);
+  put_le32(out + 12, g_stat.backoff_ms);
+  put_le32(out + 16, g_stat.scan_cads);
+  put_le32(out + 20, g_stat.scan_hits);
+  put_le32(out + 24, g_stat.tx_refused);
+  put_le32(out + 28, g_stat.tx_dropped);
+}
+
+void node_radio_reset_stats() {
+  g_stat = RadioStat();
+}
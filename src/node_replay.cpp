@@ -0,0 +1,104 @@
+// -----------------------------------------------------------------------------
+// node_replay.cpp
+// Implementation of the replay cache declared in node_replay.hpp.
+//
+// Notes:
+//  * See node_replay.hpp for what is cached and how a retry is recognised.
+//  * A lookup is a linear scan over kReplaySlots entries, seq compared
+//    first; the hash only runs for frames that could match or be recorded.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_replay.hpp"
+#include "node_log.hpp"         // EV_REPLAY
+
+#include <Arduino.h>            // millis()
+#include <cstring>              // memcpy
+
+namespace {
+
+enum State : uint8_t {
+  ENTRY_FREE = 0,
+  ENTRY_OPEN,                             // request running, reply not closed yet
+  ENTRY_LIVE,                             // one reply recorded: replayable
+  ENTRY_SKIP,                             // reply did not fit or came in parts
+};
+
+struct Entry {
+  uint8_t  state;
+  uint8_t  link;
+  uint8_t  seq;
+  uint16_t req_len;
+  uint16_t rep_len;
+  uint32_t req_hash;                      // FNV-1a over the whole request frame
+  uint32_t at_ms;                         // millis() when the request ran
+  uint8_t  rep[kReplayFrameMax];
+};
+
+Entry  g_ent[kReplaySlots];
+size_t g_next = 0;                        // ring cursor: oldest entry
+Entry* g_open = nullptr;                  // entry recording right now
+
+constexpr uint8_t kBackpressure = FLAG_XOFF | FLAG_QLVL;
+
+uint32_t fnv1a(const uint8_t* p, size_t n) {
+  uint32_t h = 2166136261u;
+  for (size_t k = 0; k < n; ++k) { h ^= p[k]; h *= 16777619u; }
+  return h;
+}
+
+}  // namespace
+
+bool node_replay_find(uint8_t link, const uint8_t* frame, size_t len, uint8_t flags) {
+  const uint8_t seq = frame[2];
+  if (seq == 0) return false;
+  const uint32_t now = millis();
+  uint32_t h = 0;
+  bool hashed = false;
+  for (Entry& e : g_ent) {
+    if (e.state != ENTRY_LIVE || e.seq != seq || e.link != link || e.req_len != len) continue;
+    if (now - e.at_ms >= kReplayTtlMs) { e.state = ENTRY_FREE; continue; }
+    if (!hashed) { h = fnv1a(frame, len); hashed = true; }
+    if (e.req_hash != h) continue;
+    e.rep[1] = static_cast<uint8_t>((e.rep[1] & ~kBackpressure) | (flags & kBackpressure));
+    protocol_send(e.rep, e.rep_len);
+    node_log(LVL_DEBUG, EV_REPLAY, frame[0], seq);
+    return true;
+  }
+  return false;
+}
+
+void node_replay_begin(uint8_t link, const uint8_t* frame, size_t len) {
+  g_open = nullptr;
+  const uint8_t seq = frame[2];
+  if (seq == 0) return;
+  for (Entry& e : g_ent)                              // the seq now names this request
+    if (e.state != ENTRY_FREE && e.seq == seq && e.link == link) e.state = ENTRY_FREE;
+
+  Entry& e = g_ent[g_next];
+  g_next = (g_next + 1) % kReplaySlots;
+  e.state    = ENTRY_OPEN;
+  e.link     = link;
+  e.seq      = seq;
+  e.req_len  = static_cast<uint16_t>(len);
+  e.rep_len  = 0;
+  e.req_hash = fnv1a(frame, len);
+  e.at_ms    = millis();
+  g_open = &e;
+}
+
+void node_replay_record(const uint8_t* reply, size_t len) {
+  if (!g_open || g_open->state != ENTRY_OPEN) return;
+  if (g_open->rep_len || len > sizeof(g_open->rep) || reply[0] == Verb::RESP_ERR) {
+    g_open->state = ENTRY_SKIP;                       // a refusal changed nothing: let the retry run
+    return;
+  }
+  memcpy(g_open->rep, reply, len);
+  g_open->rep_len = static_cast<uint16_t>(len);
+}
+
+void node_replay_end() {
+  if (!g_open) return;
+  g_open->state = (g_open->state == ENTRY_OPEN && g_open->rep_len) ? ENTRY_LIVE : ENTRY_FREE;
+  g_open = nullptr;
+}
@@ -0,0 +1,180 @@
+// -----------------------------------------------------------------------------
+// node_sched.cpp
+// Implementation of the per-task timer wheels declared in node_sched.hpp.
+//
+// Notes:
+//  * See node_sched.hpp for the wheel layout, the budget, and context rules.
+//  * Timers live in one static pool and are chained by 8-bit indices, either
+//    into a wheel bucket or into their wheel's ready FIFO, never both.
+//  * Due times are absolute ticks; a bucket visit fires only the entries
+//    whose tick has passed, so timers further out than one rotation need no
+//    round counters.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_sched.hpp"
+
+#include <Arduino.h>            // millis()
+
+static constexpr uint8_t kNil = 0xFF;
+
+static_assert((kSchedSlots & (kSchedSlots - 1)) == 0, "kSchedSlots must be a power of two");
+static_assert(kSchedTimers < kNil, "timer indices are 8-bit with 0xFF as end-of-list");
+
+enum TimerState : uint8_t { T_FREE, T_IDLE, T_WHEEL, T_READY };
+
+struct Timer {
+    SchedFn  fn;
+    uint32_t due;                // absolute tick
+    uint32_t period;             // ticks; 0 = one-shot
+    uint8_t  next;
+    uint8_t  ctx;
+    uint8_t  state;
+};
+
+struct Wheel {
+    uint8_t  bucket[kSchedSlots];
+    uint8_t  ready_head;
+    uint8_t  ready_tail;
+    uint32_t tick;               // last tick processed
+    bool     init;
+};
+
+static Timer s_timers[kSchedTimers];
+static Wheel s_wheels[2];
+
+static uint32_t now_tick() {
+    return millis() / kSchedTickMs;
+}
+
+static uint32_t ms_to_ticks(uint32_t ms) {
+    const uint32_t t = (ms + kSchedTickMs - 1) / kSchedTickMs;
+    return t ? t : 1;
+}
+
+static Wheel& wheel_of(SchedCtx ctx) {
+    Wheel& w = s_wheels[ctx];
+    if (!w.init) {
+        for (auto& b : w.bucket) b = kNil;
+        w.ready_head = w.ready_tail = kNil;
+        w.tick = now_tick();
+        w.init = true;
+    }
+    return w;
+}
+
+static void bucket_insert(Wheel& w, uint8_t k) {
+    uint8_t& head = w.bucket[s_timers[k].due & (kSchedSlots - 1)];
+    s_timers[k].next  = head;
+    s_timers[k].state = T_WHEEL;
+    head = k;
+}
+
+static void ready_append(Wheel& w, uint8_t k) {
+    s_timers[k].next  = kNil;
+    s_timers[k].state = T_READY;
+    if (w.ready_tail == kNil) w.ready_head = k;
+    else s_timers[w.ready_tail].next = k;
+    w.ready_tail = k;
+}
+
+// Unlink k from whichever list holds it (bucket lists are a few entries long).
+static void unlink(Wheel& w, uint8_t k) {
+    Timer& t = s_timers[k];
+    uint8_t* link = nullptr;
+    uint8_t  prev = kNil;
+    if (t.state == T_WHEEL) link = &w.bucket[t.due & (kSchedSlots - 1)];
+    else if (t.state == T_READY) link = &w.ready_head;
+    else return;
+    while (*link != kNil && *link != k) { prev = *link; link = &s_timers[*link].next; }
+    if (*link == k) *link = t.next;
+    if (t.state == T_READY && w.ready_tail == k) w.ready_tail = prev;
+    t.state = T_IDLE;
+}
+
+// -----------------------------------------------------------------------------
+// Registration and arming
+// -----------------------------------------------------------------------------
+SchedId node_sched_add(SchedCtx ctx, SchedFn fn) {
+    for (size_t k = 0; k < kSchedTimers; ++k) {
+        if (s_timers[k].state != T_FREE) continue;
+        wheel_of(ctx);
+        s_timers[k] = Timer{fn, 0, 0, kNil, ctx, T_IDLE};
+        return static_cast<SchedId>(k);
+    }
+    return -1;
+}
+
+void node_sched_start(SchedId id, uint32_t first_ms, uint32_t period_ms) {
+    if (id < 0 || static_cast<size_t>(id) >= kSchedTimers) return;
+    const uint8_t k = static_cast<uint8_t>(id);
+    Timer& t = s_timers[k];
+    if (t.state == T_FREE) return;
+    Wheel& w = wheel_of(static_cast<SchedCtx>(t.ctx));
+    unlink(w, k);
+    t.due    = now_tick() + ms_to_ticks(first_ms);
+    t.period = period_ms ? ms_to_ticks(period_ms) : 0;
+    bucket_insert(w, k);
+}
+
+void node_sched_stop(SchedId id) {
+    if (id < 0 || static_cast<size_t>(id) >= kSchedTimers) return;
+    const uint8_t k = static_cast<uint8_t>(id);
+    if (s_timers[k].state == T_FREE) return;
+    unlink(wheel_of(static_cast<SchedCtx>(s_timers[k].ctx)), k);
+}
+
+// -----------------------------------------------------------------------------
+// Run
+// - Visit each bucket whose tick has passed (one rotation at most) and move
+//   due entries to the ready FIFO
+// - Fire up to kSchedBudget ready callbacks; periodic ones re-arm first so a
+//   callback may stop or restart its own timer
+// -----------------------------------------------------------------------------
+void node_sched_run(SchedCtx ctx) {
+    Wheel& w = wheel_of(ctx);
+    const uint32_t now     = now_tick();
+    const uint32_t elapsed = now - w.tick;
+    const uint32_t steps   = elapsed < kSchedSlots ? elapsed : kSchedSlots;
+    for (uint32_t s = 1; s <= steps; ++s) {
+        uint8_t* link = &w.bucket[(w.tick + s) & (kSchedSlots - 1)];
+        while (*link != kNil) {
+            const uint8_t k = *link;
+            if (static_cast<int32_t>(now - s_timers[k].due) >= 0) {
+                *link = s_timers[k].next;
+                ready_append(w, k);
+            } else {
+                link = &s_timers[k].next;
+            }
+        }
+    }
+    w.tick = now;
+
+    for (size_t fired = 0; fired < kSchedBudget && w.ready_head != kNil; ++fired) {
+        const uint8_t k = w.ready_head;
+        Timer& t = s_timers[k];
+        w.ready_head = t.next;
+        if (w.ready_head == kNil) w.ready_tail = kNil;
+        t.state = T_IDLE;
+        if (t.period) {
+            t.due += t.period;
+            if (static_cast<int32_t>(t.due - now) <= 0) t.due = now + t.period;   // skip missed runs
+            bucket_insert(w, k);
+        }
+        if (t.fn) t.fn();
+    }
+}
+
+uint32_t node_sched_idle_ms(SchedCtx ctx, uint32_t cap_ms) {
+    const Wheel& w = wheel_of(ctx);
+    if (w.ready_head != kNil) return 0;
+    const uint32_t now = now_tick();
+    uint32_t best = cap_ms;
+    for (const auto& t : s_timers) {
+        if (t.state != T_WHEEL || t.ctx != ctx) continue;
+        const int32_t ticks = static_cast<int32_t>(t.due - now);
+        const uint32_t ms = ticks > 0 ? static_cast<uint32_t>(ticks) * kSchedTickMs : 0;
+        if (ms < best) best = ms;
+    }
+    return best;
+}
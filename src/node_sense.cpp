@@ -0,0 +1,68 @@
+// -----------------------------------------------------------------------------
+// node_sense.cpp
+// Implementation of the telemetry sampler declared in node_sense.hpp.
+//
+// Notes:
+//  * See node_sense.hpp for the hardware, the averaging, and context rules.
+//  * Only the sampler writes the rings and sums; readers see the published
+//    16-bit averages and nothing else.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_sense.hpp"
+#include "node_sched.hpp"       // SCHED_WORK sampler timer
+
+#include <Arduino.h>            // analogReadMilliVolts, temperatureRead
+
+struct Average {
+    int32_t ring[kSenseAvg];
+    int32_t sum;
+    size_t  head;
+    size_t  fill;
+};
+
+static Average s_vbat;
+static Average s_temp;
+
+static volatile uint16_t s_vbat_mv  = 0;
+static volatile int16_t  s_temp_c10 = 0;
+
+static int32_t average_push(Average& a, int32_t v) {
+    if (a.fill == kSenseAvg) a.sum -= a.ring[a.head];
+    else ++a.fill;
+    a.ring[a.head] = v;
+    a.sum += v;
+    a.head = (a.head + 1) % kSenseAvg;
+    return a.sum / static_cast<int32_t>(a.fill);
+}
+
+static int32_t read_vbat_mv() {
+    uint32_t mv = 0;
+    for (size_t k = 0; k < kSenseBurst; ++k) mv += analogReadMilliVolts(kVbatPin);
+    return static_cast<int32_t>(mv * kVbatDivider / kSenseBurst);
+}
+
+static int32_t read_temp_c10() {
+    const float c = temperatureRead();
+    return static_cast<int32_t>(c * 10.0f + (c < 0 ? -0.5f : 0.5f));
+}
+
+// sample() — timer callback: one reading of each into its average.
+static void sample() {
+    s_vbat_mv  = static_cast<uint16_t>(average_push(s_vbat, read_vbat_mv()));
+    s_temp_c10 = static_cast<int16_t>(average_push(s_temp, read_temp_c10()));
+}
+
+void node_sense_begin() {
+    analogSetPinAttenuation(kVbatPin, ADC_11db);    // 0..~3.1 V at the pin
+    sample();
+    node_sched_start(node_sched_add(SCHED_WORK, sample), kSensePeriodMs, kSensePeriodMs);
+}
+
+uint16_t node_sense_vbat_mv() {
+    return s_vbat_mv;
+}
+
+int16_t node_sense_temp_c10() {
+    return s_temp_c10;
+}
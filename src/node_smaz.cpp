@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------------
+// node_smaz.cpp
+// Implementation of the static-dictionary packer declared in node_smaz.hpp.
+//
+// Notes:
+//  * See node_smaz.hpp for the code stream and the host-side twin.
+//  * The entry index by first byte is built once on first use; after that
+//    packing touches only the entries that can match at each position.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_smaz.hpp"
+
+#include <cstring>              // strlen, memcmp, memcpy
+
+namespace {
+
+constexpr uint8_t kCodeDict = 0x80;
+constexpr uint8_t kCodeByte = 0x01;
+constexpr uint8_t kCodeRun  = 0x02;
+
+// Frozen: bin/vt_smaz.py holds the same list in the same order.
+const char* const kBook[] = {
+  " the ", " and ", " you ", "tion ", " for ", " that", " with", " have",
+  " this", " will", " from", " are ", " not ", " was ", " can ", " all ",
+  " out ", " is ", " to ", " of ", " in ", " on ", " at ", " be ", " we ",
+  " it ", " my ", " me ", " no ", " so ", " a ", "ing ", "ent ", "ion ", "ed ",
+  "er ", "es ", "ly ", "ng ", "e ", "s ", "t ", "d ", "n ", "y ", "r ", "o ",
+  "the", "ing", "and", "ion", "ent", "ver", "ter", "for", "her", "ere", "all",
+  "tha", "ate", "ous", "ight", "ould", "ment", "ness", "here", "th", "he",
+  "in", "er", "an", "re", "on", "at", "en", "nd", "ti", "es", "or", "te", "of",
+  "ed", "is", "it", "al", "ar", "st", "to", "nt", "ng", "se", "ha", "as", "ou",
+  "io", "le", "ve", "co", "me", "de", "hi", "ri", "ro", "ic", "ne", "ea", "ra",
+  "ce", "li", "ch", "ll", "be", "ma", "si", "om", "ur", "ow", "wh", "so", "wa",
+  "ok", ". ", ", ", "? ", "! ", ": ", "OK", "  "
+};
+static_assert(sizeof(kBook) / sizeof(kBook[0]) == kSmazEntries, "dictionary must fill codes 0x80..0xFF");
+
+uint8_t g_len[kSmazEntries];
+uint8_t g_order[kSmazEntries];              // entry indices grouped by first byte
+uint8_t g_start[257];                       // g_order[g_start[c] .. g_start[c + 1]) start with c
+bool    g_init = false;
+
+void init_once() {
+  if (g_init) return;
+  for (size_t k = 0; k < kSmazEntries; ++k) {
+    g_len[k] = static_cast<uint8_t>(strlen(kBook[k]));
+    ++g_start[static_cast<uint8_t>(kBook[k][0]) + 1];
+  }
+  for (size_t c = 1; c < 257; ++c) g_start[c] = static_cast<uint8_t>(g_start[c] + g_start[c - 1]);
+  uint8_t fill[256];
+  memcpy(fill, g_start, sizeof(fill));
+  for (size_t k = 0; k < kSmazEntries; ++k) g_order[fill[static_cast<uint8_t>(kBook[k][0])]++] = static_cast<uint8_t>(k);
+  g_init = true;
+}
+
+bool is_literal(uint8_t c) {
+  return (c >= 0x20 && c <= 0x7E) || c == 0x09 || c == 0x0A || c == 0x0D;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Pack: longest dictionary match, else the byte itself, else a verbatim run
+// -----------------------------------------------------------------------------
+size_t node_smaz_pack(const uint8_t* in, size_t n, uint8_t* out, size_t cap) {
+  init_once();
+  size_t i = 0, o = 0;
+  while (i < n) {
+    const uint8_t c = in[i];
+    int best = -1;
+    uint8_t best_len = 1;
+    for (size_t j = g_start[c]; j < g_start[c + 1]; ++j) {
+      const uint8_t k = g_order[j];
+      if (g_len[k] > best_len && i + g_len[k] <= n && memcmp(in + i, kBook[k], g_len[k]) == 0) {
+        best = k;
+        best_len = g_len[k];
+      }
+    }
+    if (best >= 0) {
+      if (o + 1 > cap) return 0;
+      out[o++] = static_cast<uint8_t>(kCodeDict + best);
+      i += best_len;
+    } else if (is_literal(c)) {
+      if (o + 1 > cap) return 0;
+      out[o++] = c;
+      ++i;
+    } else {
+      size_t run = 1;                       // dictionary entries are all literal text
+      while (i + run < n && run < 255 && !is_literal(in[i + run])) ++run;
+      const size_t need = (run == 1) ? 2 : 2 + run;
+      if (o + need > cap) return 0;
+      if (run == 1) { out[o++] = kCodeByte; out[o++] = c; }
+      else { out[o++] = kCodeRun; out[o++] = static_cast<uint8_t>(run); memcpy(out + o, in + i, run); o += run; }
+      i += run;
+    }
+  }
+  return o;
+}
+
+// -----------------------------------------------------------------------------
+// Unpack (every bound checked: the input came off the air)
+// -----------------------------------------------------------------------------
+bool node_smaz_unpack(const uint8_t* in, size_t n, uint8_t* out, size_t cap, size_t& out_len) {
+  init_once();
+  size_t i = 0, o = 0;
+  while (i < n) {
+    const uint8_t c = in[i++];
+    if (c >= kCodeDict) {
+      const uint8_t k = static_cast<uint8_t>(c - kCodeDict);
+      if (o + g_len[k] > cap) return false;
+      memcpy(out + o, kBook[k], g_len[k]);
+      o += g_len[k];
+    } else if (is_literal(c)) {
+      if (o + 1 > cap) return false;
+      out[o++] = c;
+    } else if (c == kCodeByte) {
+      if (i >= n || o + 1 > cap) return false;
+      out[o++] = in[i++];
+    } else if (c == kCodeRun) {
+      if (i >= n) return false;
+      const size_t run = in[i++];
+      if (run == 0 || i + run > n || o + run > cap) return false;
+      memcpy(out + o, in + i, run);
+      i += run;
+      o += run;
+    } else {
+      return false;
+    }
+  }
+  out_len = o;
+  return true;
+}
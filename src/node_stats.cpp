@@ -0,0 +1,211 @@
+// -----------------------------------------------------------------------------
+// node_stats.cpp
+// Implementation of the always-on counters declared in node_stats.hpp.
+//
+// Notes:
+//  * See node_stats.hpp for what is counted and the wire records.
+//  * Producers run on several tasks (TX from any sender), so updates take
+//    one short critical section. Times are kept in cycles and converted to
+//    microseconds only when encoded.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_stats.hpp"
+#include "node_protocol.hpp"    // Verb codes for the per-verb rows
+
+#include <Arduino.h>            // ESP (heap, CPU clock), portMUX critical sections
+
+// Verbs with their own row; anything else lands in the trailing "other" row (verb 0).
+static const uint8_t kStatVerbs[] = {
+    Verb::GET_ID, Verb::SET_ID, Verb::PING,
+    Verb::GET_PARAM, Verb::SET_PARAM, Verb::GET_ALL, Verb::GET_LOG, Verb::GET_STATS, Verb::SUBSCRIBE,
+    Verb::MSG, Verb::BATCH, Verb::BENCH, Verb::SET_BAUD,
+    Verb::RESP_OK, Verb::RESP_ERR,
+};
+static constexpr size_t kVerbRows = sizeof(kStatVerbs) / sizeof(kStatVerbs[0]) + 1;
+
+struct VerbStat {
+    uint32_t in;
+    uint32_t out;
+    uint32_t min_cyc;
+    uint32_t max_cyc;
+    uint64_t sum_cyc;
+};
+
+struct LinkStat {
+    uint32_t rx_frames;
+    uint32_t rx_bytes;
+    uint32_t rx_malformed;
+    uint32_t rx_overflow;
+    uint32_t tx_frames;
+    uint32_t tx_bytes;
+};
+
+struct PackStat {
+    uint32_t tx_msgs;
+    uint32_t tx_packed;
+    uint32_t tx_plain;
+    uint32_t tx_air;
+    uint32_t rx_packed;
+    uint32_t rx_air;
+    uint32_t rx_plain;
+    uint32_t rx_bad;
+};
+
+static VerbStat     s_verb[kVerbRows];
+static LinkStat     s_link;
+static PackStat     s_pack;
+static uint32_t     s_err[kErrReasons];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static size_t verb_row(uint8_t verb) {
+    for (size_t k = 0; k < kVerbRows - 1; ++k) {
+        if (kStatVerbs[k] == verb) return k;
+    }
+    return kVerbRows - 1;
+}
+
+static void put_le32(uint8_t* out, uint32_t v) {
+    for (int j = 0; j < 4; ++j) out[j] = static_cast<uint8_t>(v >> (8 * j));
+}
+
+// -----------------------------------------------------------------------------
+// Producers
+// -----------------------------------------------------------------------------
+void node_stats_rx_frame(size_t bytes) {
+    portENTER_CRITICAL(&s_mux);
+    ++s_link.rx_frames;
+    s_link.rx_bytes += bytes;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_rx_malformed() {
+    portENTER_CRITICAL(&s_mux);
+    ++s_link.rx_malformed;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_rx_overflow() {
+    portENTER_CRITICAL(&s_mux);
+    ++s_link.rx_overflow;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_tx_frame(uint8_t verb, size_t wire_bytes) {
+    VerbStat& v = s_verb[verb_row(verb)];
+    portENTER_CRITICAL(&s_mux);
+    ++s_link.tx_frames;
+    s_link.tx_bytes += wire_bytes;
+    ++v.out;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_handled(uint8_t verb, uint32_t cycles) {
+    VerbStat& v = s_verb[verb_row(verb)];
+    portENTER_CRITICAL(&s_mux);
+    if (v.in == 0 || cycles < v.min_cyc) v.min_cyc = cycles;
+    if (cycles > v.max_cyc) v.max_cyc = cycles;
+    v.sum_cyc += cycles;
+    ++v.in;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_pack_tx(size_t plain, size_t air) {
+    portENTER_CRITICAL(&s_mux);
+    ++s_pack.tx_msgs;
+    if (air < plain) ++s_pack.tx_packed;
+    s_pack.tx_plain += plain;
+    s_pack.tx_air   += air;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_pack_rx(size_t air, size_t plain) {
+    portENTER_CRITICAL(&s_mux);
+    ++s_pack.rx_packed;
+    s_pack.rx_air   += air;
+    s_pack.rx_plain += plain;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_pack_bad() {
+    portENTER_CRITICAL(&s_mux);
+    ++s_pack.rx_bad;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_error(ErrReason reason) {
+    if (reason >= kErrReasons) return;
+    portENTER_CRITICAL(&s_mux);
+    ++s_err[reason];
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void node_stats_reset() {
+    portENTER_CRITICAL(&s_mux);
+    s_link = LinkStat();
+    s_pack = PackStat();
+    for (size_t k = 0; k < kVerbRows; ++k) s_verb[k] = VerbStat();
+    for (size_t k = 0; k < kErrReasons; ++k) s_err[k] = 0;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+// -----------------------------------------------------------------------------
+// Readout (snapshot under the lock, encode outside it)
+// -----------------------------------------------------------------------------
+void node_stats_encode_link(uint8_t (&out)[kStatLinkWire]) {
+    portENTER_CRITICAL(&s_mux);
+    const LinkStat l = s_link;
+    portEXIT_CRITICAL(&s_mux);
+    put_le32(out + 0,  l.rx_frames);
+    put_le32(out + 4,  l.rx_bytes);
+    put_le32(out + 8,  l.rx_malformed);
+    put_le32(out + 12, l.rx_overflow);
+    put_le32(out + 16, l.tx_frames);
+    put_le32(out + 20, l.tx_bytes);
+    put_le32(out + 24, ESP.getFreeHeap());
+    put_le32(out + 28, ESP.getMinFreeHeap());
+}
+
+void node_stats_encode_err(uint8_t (&out)[kStatErrWire]) {
+    uint32_t e[kErrReasons];
+    portENTER_CRITICAL(&s_mux);
+    for (size_t k = 0; k < kErrReasons; ++k) e[k] = s_err[k];
+    portEXIT_CRITICAL(&s_mux);
+    for (size_t k = 0; k < kErrReasons; ++k) put_le32(out + 4 * k, e[k]);
+}
+
+void node_stats_encode_pack(uint8_t (&out)[kStatPackWire]) {
+    portENTER_CRITICAL(&s_mux);
+    const PackStat p = s_pack;
+    portEXIT_CRITICAL(&s_mux);
+    put_le32(out + 0,  p.tx_msgs);
+    put_le32(out + 4,  p.tx_packed);
+    put_le32(out + 8,  p.tx_plain);
+    put_le32(out + 12, p.tx_air);
+    put_le32(out + 16, p.rx_packed);
+    put_le32(out + 20, p.rx_air);
+    put_le32(out + 24, p.rx_plain);
+    put_le32(out + 28, p.rx_bad);
+    put_le32(out + 32, p.tx_plain ? static_cast<uint32_t>(static_cast<uint64_t>(p.tx_air) * 1000 / p.tx_plain) : 0);
+}
+
+size_t node_stats_verb_rows() {
+    return kVerbRows;
+}
+
+bool node_stats_encode_verb(size_t row, uint8_t (&out)[kStatVerbWire]) {
+    if (row >= kVerbRows) return false;
+    portENTER_CRITICAL(&s_mux);
+    const VerbStat v = s_verb[row];
+    portEXIT_CRITICAL(&s_mux);
+    if (v.in == 0 && v.out == 0) return false;
+    const uint32_t mhz = ESP.getCpuFreqMHz() ? ESP.getCpuFreqMHz() : 1;
+    out[0] = (row < kVerbRows - 1) ? kStatVerbs[row] : 0;
+    out[1] = 0;
+    put_le32(out + 2,  v.in);
+    put_le32(out + 6,  v.out);
+    put_le32(out + 10, v.min_cyc / mhz);
+    put_le32(out + 14, v.in ? static_cast<uint32_t>(v.sum_cyc / v.in / mhz) : 0);
+    put_le32(out + 18, v.max_cyc / mhz);
+    return true;
+}
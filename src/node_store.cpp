@@ -0,0 +1,319 @@
+// -----------------------------------------------------------------------------
+// node_store.cpp
+// Implementation of the flash message log declared in node_store.hpp.
+//
+// Notes:
+//  * See node_store.hpp for the partition, record layout, and context rules.
+//  * The transport task never calls into the flash driver: puts and marks go
+//    through two SPSC rings that a SCHED_WORK timer drains.
+//  * The indices are the only state both tasks change (replay pops, sector
+//    erase drops), so they sit behind one spinlock. Both ends only ever
+//    remove from the tail: the log is FIFO, so the records in the oldest
+//    sector are always the oldest entries of each index.
+//  * esp_partition_write/erase flush the cache for the range they touch, so
+//    the mapping shows new records and erased sectors at once.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_store.hpp"
+#include "node_ring.hpp"        // SpscRing: write and mark queues
+#include "node_sched.hpp"       // SCHED_WORK writer timer
+
+#include <Arduino.h>            // portMUX
+#include <esp_partition.h>      // find, mmap, erase, write
+#include <cstring>              // memcpy
+
+namespace {
+
+constexpr size_t   kHdr       = 10;       // record header bytes
+constexpr size_t   kSectorHdr = 8;        // magic + generation
+constexpr uint8_t  kMarkLive  = 0xFE;
+constexpr uint8_t  kMarkDone  = 0x00;
+constexpr uint8_t  kMarkFree  = 0xFF;     // erased flash: no record here yet
+constexpr uint32_t kFlushMs   = 200;      // writer timer period
+
+static_assert(sizeof(Msg::buf) - kMsgHeadroom >= 255, "a record's 8-bit length must fit a Msg");
+
+struct Put {
+  uint8_t kind;
+  Msg     m;
+};
+
+struct Fifo {
+  uint32_t off[kStoreIndex];              // partition offsets of live records
+  uint16_t tail;
+  uint16_t count;
+};
+
+const esp_partition_t*  g_part = nullptr;
+const uint8_t*          g_map  = nullptr;
+spi_flash_mmap_handle_t g_mmap_handle;
+size_t                  g_sectors = 0;
+
+// Writer position (worker after boot; read as words by node_store_free_bytes).
+volatile uint32_t g_head_sec = 0;
+volatile uint32_t g_head_off = kStoreSector;
+uint32_t          g_head_gen = 0;
+
+Fifo          g_fifo[2];                  // STORE_OUT, STORE_IN
+uint32_t      g_peeked[2];
+uint32_t      g_drops = 0;
+portMUX_TYPE  g_mux = portMUX_INITIALIZER_UNLOCKED;
+
+SpscRing<Put, 4>       g_puts;            // transport -> worker
+SpscRing<uint32_t, 16> g_marks;           // consumed offsets, transport -> worker
+
+Fifo& fifo_of(StoreKind k) { return g_fifo[k == STORE_IN ? 1 : 0]; }
+size_t slot_of(StoreKind k) { return k == STORE_IN ? 1 : 0; }
+
+uint32_t get32(const uint8_t* p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+void put32(uint8_t* p, uint32_t v) {
+  for (int j = 0; j < 4; ++j) p[j] = static_cast<uint8_t>(v >> (8 * j));
+}
+
+size_t record_bytes(uint8_t len) {
+  return (kHdr + len + 3) & ~static_cast<size_t>(3);
+}
+
+// CRC-16/CCITT-FALSE over header bytes 1..7 and the payload.
+uint16_t record_crc(const uint8_t* rec, const uint8_t* payload, size_t n) {
+  uint16_t crc = 0xFFFF;
+  auto feed = [&crc](uint8_t b) {
+    crc ^= static_cast<uint16_t>(b) << 8;
+    for (int k = 0; k < 8; ++k) crc = (crc & 0x8000) ? static_cast<uint16_t>(crc << 1 ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+  };
+  for (size_t i = 1; i < 8; ++i) feed(rec[i]);
+  for (size_t i = 0; i < n; ++i) feed(payload[i]);
+  return crc;
+}
+
+bool record_valid(const uint8_t* rec, size_t room) {
+  if (room < kHdr || record_bytes(rec[2]) > room) return false;
+  if (rec[1] != STORE_OUT && rec[1] != STORE_IN) return false;
+  return (rec[8] | rec[9] << 8) == record_crc(rec, rec + kHdr, rec[2]);
+}
+
+// Caller holds g_mux.
+void fifo_push(Fifo& f, uint32_t off) {
+  if (f.count == kStoreIndex) { ++g_drops; return; }
+  f.off[(f.tail + f.count) % kStoreIndex] = off;
+  ++f.count;
+}
+
+void fifo_drop_tail(Fifo& f) {
+  f.tail = static_cast<uint16_t>((f.tail + 1) % kStoreIndex);
+  --f.count;
+}
+
+// Sectors between the writer and @p sec, walking forward (0 = erased next).
+uint32_t lead(uint32_t sec) {
+  return static_cast<uint32_t>((sec + g_sectors - g_head_sec - 1) % g_sectors);
+}
+
+// -----------------------------------------------------------------------------
+// Writer (worker task)
+// -----------------------------------------------------------------------------
+bool format_sector(uint32_t sec, uint32_t gen) {
+  uint8_t hdr[kSectorHdr];
+  put32(hdr, kStoreMagic);
+  put32(hdr + 4, gen);
+  return esp_partition_erase_range(g_part, sec * kStoreSector, kStoreSector) == ESP_OK &&
+         esp_partition_write(g_part, sec * kStoreSector, hdr, sizeof(hdr)) == ESP_OK;
+}
+
+// Move the writer to the next sector, dropping whatever is still live there.
+bool open_next() {
+  const uint32_t next = static_cast<uint32_t>((g_head_sec + 1) % g_sectors);
+  portENTER_CRITICAL(&g_mux);
+  for (auto& f : g_fifo) {
+    while (f.count && f.off[f.tail] / kStoreSector == next) { fifo_drop_tail(f); ++g_drops; }
+  }
+  portEXIT_CRITICAL(&g_mux);
+  if (!format_sector(next, g_head_gen + 1)) return false;
+  ++g_head_gen;
+  g_head_sec = next;
+  g_head_off = kSectorHdr;
+  return true;
+}
+
+void append(const Put& p) {
+  const size_t need = record_bytes(p.m.len);
+  if (g_head_off + need > kStoreSector && !open_next()) {
+    portENTER_CRITICAL(&g_mux); ++g_drops; portEXIT_CRITICAL(&g_mux);
+    return;
+  }
+  static uint8_t rec[kHdr + kRadioMaxPayload + 3];      // static: off the worker stack
+  rec[0] = kMarkLive;
+  rec[1] = p.kind;
+  rec[2] = p.m.len;
+  rec[3] = p.m.hops;
+  rec[4] = p.m.id & 0xFF;
+  rec[5] = p.m.id >> 8;
+  rec[6] = p.m.dst & 0xFF;
+  rec[7] = p.m.dst >> 8;
+  const uint16_t crc = record_crc(rec, p.m.data(), p.m.len);
+  rec[8] = crc & 0xFF;
+  rec[9] = crc >> 8;
+  memcpy(rec + kHdr, p.m.data(), p.m.len);
+  memset(rec + kHdr + p.m.len, 0xFF, need - kHdr - p.m.len);
+  const uint32_t off = g_head_sec * kStoreSector + g_head_off;
+  if (esp_partition_write(g_part, off, rec, need) != ESP_OK) {
+    g_head_off = kStoreSector;                           // suspect sector: start a fresh one next time
+    portENTER_CRITICAL(&g_mux); ++g_drops; portEXIT_CRITICAL(&g_mux);
+    return;
+  }
+  g_head_off = g_head_off + need;
+  portENTER_CRITICAL(&g_mux);
+  fifo_push(fifo_of(static_cast<StoreKind>(p.kind)), off);
+  portEXIT_CRITICAL(&g_mux);
+}
+
+// store_service() — timer callback: clear consumed marks, then append new records.
+void store_service() {
+  while (const uint32_t* off = g_marks.read_slot()) {
+    const uint8_t done = kMarkDone;
+    esp_partition_write(g_part, *off, &done, 1);         // 0xFE -> 0x00 needs no erase
+    g_marks.release();
+  }
+  while (const Put* p = g_puts.read_slot()) {
+    append(*p);
+    g_puts.release();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Boot scan
+// - The newest generation is the writer's sector; the log runs from the one
+//   after it, wrapping, and unformatted sectors are skipped
+// - A record that fails its CRC ends its sector (torn write); if that is the
+//   writer's sector, the next append opens a fresh one
+// -----------------------------------------------------------------------------
+void scan() {
+  bool any = false;
+  for (uint32_t s = 0; s < g_sectors; ++s) {
+    const uint8_t* sec = g_map + s * kStoreSector;
+    if (get32(sec) != kStoreMagic) continue;
+    const uint32_t gen = get32(sec + 4);
+    if (!any || gen > g_head_gen) { g_head_gen = gen; g_head_sec = s; any = true; }
+  }
+  if (!any) {
+    if (format_sector(0, 1)) { g_head_gen = 1; g_head_sec = 0; g_head_off = kSectorHdr; }
+    return;
+  }
+  for (uint32_t k = 1; k <= g_sectors; ++k) {
+    const uint32_t s = static_cast<uint32_t>((g_head_sec + k) % g_sectors);
+    const uint8_t* sec = g_map + s * kStoreSector;
+    if (get32(sec) != kStoreMagic) continue;
+    size_t off = kSectorHdr;
+    while (off < kStoreSector && sec[off] != kMarkFree) {
+      if (!record_valid(sec + off, kStoreSector - off)) { off = kStoreSector; break; }
+      if (sec[off] == kMarkLive) fifo_push(fifo_of(static_cast<StoreKind>(sec[off + 1])), s * kStoreSector + off);
+      off += record_bytes(sec[off + 2]);
+    }
+    if (s == g_head_sec) g_head_off = off;
+  }
+}
+
+} // namespace
+
+void node_store_begin() {
+  g_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    static_cast<esp_partition_subtype_t>(kStorePartSubtype), "vtlog");
+  if (!g_part || g_part->size < 2 * kStoreSector) return;
+  const void* map = nullptr;
+  if (esp_partition_mmap(g_part, 0, g_part->size, ESP_PARTITION_MMAP_DATA, &map, &g_mmap_handle) != ESP_OK) return;
+  g_map     = static_cast<const uint8_t*>(map);
+  g_sectors = g_part->size / kStoreSector;
+  scan();
+  node_sched_start(node_sched_add(SCHED_WORK, store_service), kFlushMs, kFlushMs);
+}
+
+bool node_store_ready() {
+  return g_map != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Transport side
+// -----------------------------------------------------------------------------
+bool node_store_put(StoreKind kind, const Msg& m) {
+  if (!g_map) return false;
+  Put* p = g_puts.write_slot();
+  if (!p) {
+    portENTER_CRITICAL(&g_mux); ++g_drops; portEXIT_CRITICAL(&g_mux);
+    return false;
+  }
+  p->kind = kind;
+  p->m    = m;
+  g_puts.commit();
+  return true;
+}
+
+bool node_store_peek(StoreKind kind, Msg& out) {
+  if (!g_map) return false;
+  Fifo& f = fifo_of(kind);
+  for (;;) {
+    portENTER_CRITICAL(&g_mux);
+    const bool any = f.count != 0;
+    const uint32_t off = any ? f.off[f.tail] : 0;
+    portEXIT_CRITICAL(&g_mux);
+    if (!any) return false;
+
+    uint8_t hdr[kHdr];
+    memcpy(hdr, g_map + off, kHdr);
+    const size_t room = kStoreSector - off % kStoreSector;
+    if (record_bytes(hdr[2]) <= room) {
+      memcpy(out.data(), g_map + off + kHdr, hdr[2]);      // one copy, straight from the mapping
+      if (hdr[0] == kMarkLive && hdr[1] == kind && (hdr[8] | hdr[9] << 8) == record_crc(hdr, out.data(), hdr[2])) {
+        out.len      = hdr[2];
+        out.hops     = hdr[3];
+        out.id       = static_cast<uint16_t>(hdr[4] | hdr[5] << 8);
+        out.dst      = static_cast<uint16_t>(hdr[6] | hdr[7] << 8);
+        out.lane     = LANE_CHAT;
+        out.rssi_dbm = 0;
+        out.snr_db   = 0;
+        g_peeked[slot_of(kind)] = off;
+        return true;
+      }
+    }
+    portENTER_CRITICAL(&g_mux);                          // erased under us: skip it
+    if (f.count && f.off[f.tail] == off) { fifo_drop_tail(f); ++g_drops; }
+    portEXIT_CRITICAL(&g_mux);
+  }
+}
+
+void node_store_pop(StoreKind kind) {
+  Fifo& f = fifo_of(kind);
+  const uint32_t off = g_peeked[slot_of(kind)];
+  portENTER_CRITICAL(&g_mux);
+  const bool mine = f.count && f.off[f.tail] == off;
+  if (mine) fifo_drop_tail(f);
+  portEXIT_CRITICAL(&g_mux);
+  if (!mine) return;
+  if (uint32_t* m = g_marks.write_slot()) { *m = off; g_marks.commit(); }   // full: replays after a reset
+}
+
+size_t node_store_pending(StoreKind kind) {
+  return fifo_of(kind).count;
+}
+
+uint32_t node_store_free_bytes() {
+  if (!g_map) return 0;
+  portENTER_CRITICAL(&g_mux);
+  uint32_t sectors = static_cast<uint32_t>(g_sectors - 1);
+  for (const auto& f : g_fifo) {
+    if (f.count) {
+      const uint32_t l = lead(f.off[f.tail] / kStoreSector);
+      if (l < sectors) sectors = l;
+    }
+  }
+  const uint32_t head_off = g_head_off;
+  portEXIT_CRITICAL(&g_mux);
+  return sectors * (kStoreSector - kSectorHdr) + (kStoreSector - head_off);
+}
+
+uint32_t node_store_drops() {
+  return g_drops;
+}
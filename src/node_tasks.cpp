@@ -0,0 +1,119 @@
+// -----------------------------------------------------------------------------
+// node_tasks.cpp
+// Implementation of the dual-core task layout declared in node_tasks.hpp.
+//
+// Notes:
+//  * See node_tasks.hpp for the core/priority map and the job rules.
+//  * This file is about mechanics: task bodies, the worker queue, and the
+//    wakeup wiring between UART/radio and the transport task.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_tasks.hpp"       // NodeJob, node_tasks_* API
+#include "node_protocol.hpp"    // node_protocol_update, node_protocol_on_rx
+#include "node_interface.hpp"   // node_interface_update, node_interface_service
+#include "node_radio.hpp"       // node_radio_on_rx
+#include "node_display.hpp"     // node_display_service
+#include "node_sched.hpp"       // node_sched_run, worker timers
+#include "node_power.hpp"       // node_power_try_sleep
+
+#include <Arduino.h>            // FreeRTOS task/queue API via the ESP32 Arduino core
+
+// Task layout. Core 1 is the Arduino core; core 0 already hosts vt_radio.
+static constexpr uint32_t    kXportStack  = 6144;   // handler frames; TX buffers are pooled (node_frame)
+static constexpr UBaseType_t kXportPrio   = 10;     // above everything but the radio ISR path
+static constexpr BaseType_t  kXportCore   = 1;
+static constexpr uint32_t    kXportIdleMs = 10;     // safety poll if a wakeup is ever missed
+
+static constexpr uint32_t    kWorkStack   = 4096;   // Adafruit GFX + NVS call depth
+static constexpr UBaseType_t kWorkPrio    = 2;      // below vt_radio (5); may block on I2C/flash
+static constexpr BaseType_t  kWorkCore    = 0;
+static constexpr uint32_t    kWorkTickMs  = 50;     // display cadence / longest worker sleep
+static constexpr uint32_t    kCommitPollMs = 100;   // node_interface_service(): NVS window check
+static constexpr UBaseType_t kWorkDepth   = 8;      // bounded: UI jobs are coalescable
+
+static TaskHandle_t  s_xport   = nullptr;
+static TaskHandle_t  s_work    = nullptr;
+static QueueHandle_t s_jobs    = nullptr;
+static volatile uint32_t s_dropped = 0;
+static volatile bool s_work_busy = false;            // worker is between waits (may hold I2C/flash)
+
+// -----------------------------------------------------------------------------
+// Transport task
+// - Pump SLIP until the UART is drained, then deliver at most one radio packet
+// - Fire a budgeted handful of due timers (beacons), never more per pass
+// - With TAG_SLEEP=1 and the whole node idle, light-sleep until the next
+//   timer; otherwise wait until UART RX or radio RX notifies us, a timer is
+//   due, or the safety poll expires
+// -----------------------------------------------------------------------------
+static void xport_task(void*) {
+    for (;;) {
+        node_protocol_update();      // 1) serial -> frames -> handlers
+        node_interface_update();     // 2) radio RX ring -> host
+        node_sched_run(SCHED_XPORT); // 3) periodic transport-side work
+        if (node_power_try_sleep(node_sched_idle_ms(SCHED_XPORT, kSleepMaxMs))) continue;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(node_sched_idle_ms(SCHED_XPORT, kXportIdleMs)));
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Worker task
+// - Run queued jobs in FIFO order; push the OLED right after one (it likely drew)
+// - Timers carry the slow upkeep: dirty OLED pages, NVS commit windows
+// -----------------------------------------------------------------------------
+static void work_task(void*) {
+    NodeJob job;
+    for (;;) {
+        const uint32_t wait = node_sched_idle_ms(SCHED_WORK, kWorkTickMs);
+        s_work_busy = false;
+        const bool got = xQueueReceive(s_jobs, &job, pdMS_TO_TICKS(wait)) == pdTRUE;
+        s_work_busy = true;
+        if (got && job.fn) {
+            job.fn(job);
+            node_display_service();
+        }
+        node_sched_run(SCHED_WORK);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Start the runtime
+// - Queue and worker timers first so handlers can post as soon as the
+//   transport task runs
+// - Wire UART and radio RX to wake the transport task
+// -----------------------------------------------------------------------------
+void node_tasks_begin() {
+    s_jobs = xQueueCreate(kWorkDepth, sizeof(NodeJob));
+    node_sched_start(node_sched_add(SCHED_WORK, node_display_service),   kWorkTickMs,   kWorkTickMs);
+    node_sched_start(node_sched_add(SCHED_WORK, node_interface_service), kCommitPollMs, kCommitPollMs);
+    xTaskCreatePinnedToCore(work_task,  "vt_work",  kWorkStack,  nullptr, kWorkPrio,  &s_work,  kWorkCore);
+    xTaskCreatePinnedToCore(xport_task, "vt_xport", kXportStack, nullptr, kXportPrio, &s_xport, kXportCore);
+    node_protocol_on_rx(&node_tasks_wake_transport);
+    node_radio_on_rx(&node_tasks_wake_transport);
+}
+
+// -----------------------------------------------------------------------------
+// Post a job (never blocks; inline before the runtime exists)
+// -----------------------------------------------------------------------------
+bool node_tasks_post(const NodeJob& job) {
+    if (!s_jobs) {                   // boot path: no worker yet, run here
+        if (job.fn) job.fn(job);
+        return true;
+    }
+    if (xQueueSend(s_jobs, &job, 0) == pdTRUE) return true;
+    s_dropped = s_dropped + 1;
+    return false;
+}
+
+void node_tasks_wake_transport() {
+    if (s_xport) xTaskNotifyGive(s_xport);
+}
+
+uint32_t node_tasks_dropped() {
+    return s_dropped;
+}
+
+bool node_tasks_worker_idle() {
+    if (!s_jobs) return true;
+    return uxQueueMessagesWaiting(s_jobs) == 0 && !s_work_busy;
+}
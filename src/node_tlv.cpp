@@ -0,0 +1,55 @@
+// -----------------------------------------------------------------------------
+// node_tlv.cpp
+// Implementation of the TLV view declared in node_tlv.hpp.
+//
+// Notes:
+//  * See node_tlv.hpp for what a valid body is and how lookups work.
+//  * Offsets are relative to the body and stored +1, so a zeroed index
+//    means "no such tag" without a separate presence mask.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_tlv.hpp"
+#include "node_protocol.hpp"    // kFrameHdr, frame_hdr_len(), frame_body_len()
+
+#include <cstring>              // memset
+
+TlvView::TlvView(const uint8_t* frame, size_t len)
+    : body_(frame), blen_(0), count_(0), ok_(false) {
+  memset(at_, 0, sizeof(at_));
+  if (!frame || len < kFrameHdr || len < frame_hdr_len(frame)) return;
+  const size_t hdr = frame_hdr_len(frame);
+  const size_t n   = frame_body_len(frame);
+  body_ = frame + hdr;
+  if (n > len - hdr) return;                                // declared body overruns the frame
+
+  size_t count = 0;
+  for (size_t off = 0; off < n; ) {
+    if (n - off < 2 || n - off - 2 < body_[off + 1]) {      // stray byte, or value past the body
+      memset(at_, 0, sizeof(at_));
+      return;
+    }
+    const uint8_t t = body_[off];
+    if (t < kTlvIndexSlots && !at_[t]) at_[t] = static_cast<uint16_t>(off + 1);
+    off += 2 + body_[off + 1];
+    ++count;
+  }
+  blen_  = n;
+  count_ = count;
+  ok_    = true;
+}
+
+const uint8_t* TlvView::find(uint8_t tag, uint8_t& len) const {
+  if (!ok_) return nullptr;
+  if (tag < kTlvIndexSlots) {
+    if (!at_[tag]) return nullptr;
+    const uint8_t* p = body_ + at_[tag] - 1;
+    len = p[1];
+    return p + 2;
+  }
+  for (Iter it = begin(); it != end(); ++it) {              // rare: tags above the index
+    const Item t = *it;
+    if (t.tag == tag) { len = t.len; return t.value; }
+  }
+  return nullptr;
+}
@@ -0,0 +1,177 @@
+// -----------------------------------------------------------------------------
+// node_transport.cpp
+// Out-of-line parts of the wireless links declared in node_transport.hpp.
+//
+// Notes:
+//  * SlipLink is header-only (templated on its port); only the Wi-Fi socket
+//    and the BLE GATT glue live here, each compiled only when selected.
+//  * Neither link allocates per frame: UDP receives into the link's own
+//    buffer, BLE writes go through a byte ring.
+//
+// -----------------------------------------------------------------------------
+
+#include "node_transport.hpp"
+
+#if VT_TRANSPORT_UDP
+#include <WiFi.h>               // station mode, association (lwIP netif)
+#include <lwip/sockets.h>       // socket/bind/recvfrom/sendto
+#endif
+
+#if VT_TRANSPORT_BLE
+#include <BLEDevice.h>          // Bluedroid GATT server
+#include <BLEServer.h>
+#include <BLEUtils.h>
+#include <BLE2902.h>            // CCCD so centrals can enable notify
+#endif
+
+// -----------------------------------------------------------------------------
+// Wi-Fi UDP
+// - Station mode, modem sleep off (it adds 100+ ms of latency per datagram)
+// - Socket bound to INADDR_ANY before association; lwIP accepts that and
+//   datagrams flow as soon as DHCP completes
+// -----------------------------------------------------------------------------
+#if VT_TRANSPORT_UDP
+void UdpLink::begin() {
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);
+  WiFi.setAutoReconnect(true);
+  WiFi.begin(VT_WIFI_SSID, VT_WIFI_PASS);
+
+  fd_ = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd_ < 0) return;
+  sockaddr_in local = {};
+  local.sin_family      = AF_INET;
+  local.sin_port        = htons(VT_UDP_PORT);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (lwip_bind(fd_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+    lwip_close(fd_);
+    fd_ = -1;
+    return;
+  }
+  lwip_fcntl(fd_, F_SETFL, lwip_fcntl(fd_, F_GETFL, 0) | O_NONBLOCK);
+}
+
+int UdpLink::recv() {
+  if (fd_ < 0) return -1;
+  sockaddr_in from = {};
+  socklen_t   flen = sizeof(from);
+  const int n = lwip_recvfrom(fd_, buf_, sizeof(buf_), MSG_DONTWAIT,
+                              reinterpret_cast<sockaddr*>(&from), &flen);
+  if (n < 0) return -1;                 // EWOULDBLOCK: nothing waiting
+  peer_ip_   = from.sin_addr.s_addr;    // replies follow the last sender
+  peer_port_ = from.sin_port;
+  have_peer_ = true;
+  return n;
+}
+
+size_t UdpLink::send(const uint8_t* frame, size_t len) {
+  if (fd_ < 0 || !have_peer_) return 0;
+  sockaddr_in to = {};
+  to.sin_family      = AF_INET;
+  to.sin_port        = peer_port_;
+  to.sin_addr.s_addr = peer_ip_;
+  const int n = lwip_sendto(fd_, frame, len, 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+  return n < 0 ? 0 : static_cast<size_t>(n);
+}
+#endif  // VT_TRANSPORT_UDP
+
+// -----------------------------------------------------------------------------
+// BLE (Nordic UART Service)
+// - RX characteristic: central writes SLIP bytes -> ring -> transport task
+// - TX characteristic: notify, one piece of the central's MTU - 3 at a time
+//   (the MTU it negotiated, not ours: 23 until it asks for more)
+// - Callback objects are static; the library keeps pointers, never owns them
+// -----------------------------------------------------------------------------
+#if VT_TRANSPORT_BLE
+namespace {
+
+const char* const kNusService = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
+const char* const kNusRx      = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E";
+const char* const kNusTx      = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E";
+
+BleUartPort*       g_port = nullptr;
+BLECharacteristic* g_tx   = nullptr;
+BLEServer*         g_srv  = nullptr;
+volatile uint16_t  g_conn = 0;          // conn_id of the central (one at a time)
+
+class ServerCallbacks : public BLEServerCallbacks {
+  void onConnect(BLEServer*, esp_ble_gatts_cb_param_t* param) override {
+    g_conn = param->connect.conn_id;
+    if (g_port) g_port->on_connect(true);
+  }
+  void onDisconnect(BLEServer*) override {
+    if (g_port) g_port->on_connect(false);
+    BLEDevice::startAdvertising();      // one central at a time; let the next one in
+  }
+};
+
+class RxCallbacks : public BLECharacteristicCallbacks {
+  void onWrite(BLECharacteristic* c) override {
+    if (g_port) g_port->on_write(c->getData(), c->getLength());
+  }
+};
+
+ServerCallbacks g_server_cb;
+RxCallbacks     g_rx_cb;
+BLE2902         g_tx_cccd;
+
+}  // namespace
+
+void BleUartPort::begin(const char* name) {
+  g_port = this;
+  BLEDevice::init(name);
+  BLEServer* srv = BLEDevice::createServer();
+  g_srv = srv;
+  srv->setCallbacks(&g_server_cb);
+  BLEService* svc = srv->createService(kNusService);
+  g_tx = svc->createCharacteristic(kNusTx, BLECharacteristic::PROPERTY_NOTIFY);
+  g_tx->addDescriptor(&g_tx_cccd);
+  BLECharacteristic* rx = svc->createCharacteristic(
+      kNusRx, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR);
+  rx->setCallbacks(&g_rx_cb);
+  svc->start();
+  BLEAdvertising* adv = BLEDevice::getAdvertising();
+  adv->addServiceUUID(kNusService);
+  adv->setScanResponse(true);
+  BLEDevice::startAdvertising();
+}
+
+// BLE task. Once the ring fills, the frame in flight has lost bytes: drop
+// everything up to the central's next END, then keep that END so the cut
+// prefix closes as a short frame (RESP_ERR on its length) instead of running
+// into the next one.
+void BleUartPort::on_write(const uint8_t* p, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    if (drop_ && p[i] != kSlipEnd) continue;
+    uint8_t* slot = rx_.write_slot();
+    if (!slot) { drop_ = true; continue; }
+    *slot = p[i];
+    rx_.commit();
+    drop_ = false;
+  }
+  if (notify_) notify_();
+}
+
+size_t BleUartPort::read(uint8_t* out, size_t n) {
+  size_t k = 0;
+  while (k < n) {
+    const uint8_t* slot = rx_.read_slot();
+    if (!slot) break;
+    out[k++] = *slot;
+    rx_.release();
+  }
+  return k;
+}
+
+size_t BleUartPort::write(const uint8_t* p, size_t n) {
+  if (!connected_ || !g_tx) return n;   // nobody listening: drop like an unplugged UART
+  const uint16_t mtu   = g_srv->getPeerMTU(g_conn);    // negotiated; 23 before an exchange
+  const size_t   piece = (mtu > 3) ? mtu - 3u : 20u;
+  for (size_t off = 0; off < n; off += piece) {
+    const size_t k = (n - off < piece) ? n - off : piece;
+    g_tx->setValue(const_cast<uint8_t*>(p + off), k);
+    g_tx->notify();
+  }
+  return n;
+}
+#endif  // VT_TRANSPORT_BLE
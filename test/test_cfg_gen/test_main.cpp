@@ -0,0 +1,143 @@
+// -----------------------------------------------------------------------------
+// test_cfg_gen/test_main.cpp
+// Host tests for TAG_CFG_GEN and delta GET_ALL (TAG_CFG_SINCE). Run with
+// `pio test -e native`.
+//
+// Notes:
+//  * NVS is the shim's in-memory map, so node_interface_flush() followed by
+//    node_interface_begin() stands in for a reboot.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "native_host.h"
+
+namespace {
+
+// Every request here must succeed.
+void request(uint8_t verb, const uint8_t* body, size_t blen) {
+  native_request(verb, body, blen);
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, native_reply()[0]);
+}
+
+size_t reply_tlvs() {
+  const uint8_t* r = native_reply();
+  const size_t end = frame_hdr_len(r) + frame_body_len(r);
+  TEST_ASSERT_TRUE(end <= native_reply_len());
+  size_t n = 0;
+  for (size_t off = frame_hdr_len(r); off + 2 <= end; off += 2 + r[off + 1]) ++n;
+  return n;
+}
+
+uint32_t le32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint32_t gen() {
+  request(Verb::GET_ALL, nullptr, 0);
+  const uint8_t* p = native_reply_tlv(TAG_CFG_GEN);
+  TEST_ASSERT_NOT_NULL(p);
+  return le32(p);
+}
+
+void set_sf(uint8_t sf) {
+  const uint8_t b[] = {TAG_SF, 1, sf};
+  request(Verb::SET_PARAM, b, sizeof(b));
+}
+
+void get_all_since(uint32_t since) {
+  const uint8_t b[] = {TAG_CFG_SINCE, 4, static_cast<uint8_t>(since), static_cast<uint8_t>(since >> 8),
+                       static_cast<uint8_t>(since >> 16), static_cast<uint8_t>(since >> 24)};
+  request(Verb::GET_ALL, b, sizeof(b));
+}
+
+}  // namespace
+
+void setUp() { native_serial_clear(); }
+void tearDown() {}
+
+// -----------------------------------------------------------------------------
+// Generation counter
+// -----------------------------------------------------------------------------
+void test_change_bumps_once_and_echoes() {
+  set_sf(9);
+  const uint32_t g0 = gen();
+  const uint8_t b[] = {TAG_SF, 1, 10, TAG_CR, 1, 6};                 // two rows, one request
+  request(Verb::SET_PARAM, b, sizeof(b));
+  const uint8_t* p = native_reply_tlv(TAG_CFG_GEN);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT32(g0 + 1, le32(p));
+  TEST_ASSERT_EQUAL_UINT32(g0 + 1, gen());
+}
+
+void test_identical_write_does_not_bump() {
+  set_sf(10);
+  const uint32_t g0 = gen();
+  set_sf(10);
+  TEST_ASSERT_EQUAL_UINT32(g0, gen());
+}
+
+void test_set_id_bumps() {
+  const uint32_t g0 = gen();
+  const uint8_t b[] = {TAG_ID, 4, 'G', 'e', 'n', '1'};
+  request(Verb::SET_ID, b, sizeof(b));
+  TEST_ASSERT_EQUAL_UINT32(g0 + 1, gen());
+}
+
+// -----------------------------------------------------------------------------
+// Delta GET_ALL
+// -----------------------------------------------------------------------------
+void test_delta_from_current_is_just_the_generation() {
+  get_all_since(gen());
+  TEST_ASSERT_EQUAL_UINT32(1, reply_tlvs());
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_CFG_GEN));
+}
+
+void test_delta_returns_only_changed_rows() {
+  const uint32_t g0 = gen();
+  set_sf(11);
+  get_all_since(g0);
+  TEST_ASSERT_EQUAL_UINT32(2, reply_tlvs());
+  const uint8_t* p = native_reply_tlv(TAG_SF);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(11, p[0]);
+  TEST_ASSERT_NULL(native_reply_tlv(TAG_Q_OUT));                          // diagnostics are not deltas
+}
+
+void test_generation_ahead_gets_everything() {
+  get_all_since(gen() + 100);
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_SF));
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_Q_OUT));
+}
+
+void test_generation_survives_reboot() {
+  set_sf(12);
+  const uint32_t g0 = gen();
+  node_interface_flush();
+  node_interface_begin();
+  TEST_ASSERT_EQUAL_UINT32(g0, gen());
+  get_all_since(g0);
+  TEST_ASSERT_EQUAL_UINT32(1, reply_tlvs());
+  get_all_since(g0 - 1);                                           // history is RAM only: all rows
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_FREQ_HZ));
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_ID));
+}
+
+int main() {
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_change_bumps_once_and_echoes);
+  RUN_TEST(test_identical_write_does_not_bump);
+  RUN_TEST(test_set_id_bumps);
+  RUN_TEST(test_delta_from_current_is_just_the_generation);
+  RUN_TEST(test_delta_returns_only_changed_rows);
+  RUN_TEST(test_generation_ahead_gets_everything);
+  RUN_TEST(test_generation_survives_reboot);
+  return UNITY_END();
+}
@@ -0,0 +1,95 @@
+// -----------------------------------------------------------------------------
+// test_chan/test_main.cpp
+// Host tests for the channel plan, the hop-mode preamble, TAG_CHAN
+// validation and TAG_STAT_RADIO. Run with `pio test -e native`.
+//
+// Notes:
+//  * No radio natively, so LBT and the scan never run; the plan and preamble
+//    are pure functions and the counters read as zero.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "node_radio.hpp"
+#include "native_host.h"
+
+namespace {
+
+uint8_t set_chan(uint8_t chan) {
+  const uint8_t b[] = {TAG_CHAN, 1, chan};
+  native_request(Verb::SET_PARAM, b, sizeof(b));
+  return native_reply()[0];
+}
+
+RadioConfig config(uint32_t bw_hz, uint8_t chan) {
+  RadioConfig c = {902300000, 9, bw_hz, 5, 17, chan};
+  return c;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// -----------------------------------------------------------------------------
+// Plan
+// -----------------------------------------------------------------------------
+void test_plan_steps_by_1_6_bandwidths() {
+  TEST_ASSERT_EQUAL_UINT32(200000, node_radio_chan_step(125000));   // US915 raster
+  TEST_ASSERT_EQUAL_UINT32(800000, node_radio_chan_step(500000));
+  TEST_ASSERT_EQUAL_UINT32(902300000, node_radio_chan_freq(config(125000, 0), 0));
+  TEST_ASSERT_EQUAL_UINT32(903700000, node_radio_chan_freq(config(125000, 0), 7));
+}
+
+void test_hop_and_out_of_plan_values_stay_in_the_plan() {
+  const RadioConfig c = config(125000, kRadioChanHop);
+  TEST_ASSERT_EQUAL_UINT32(c.freq_hz, node_radio_chan_freq(c, kRadioChanHop));
+  TEST_ASSERT_EQUAL_UINT32(node_radio_chan_freq(c, 1), node_radio_chan_freq(c, kRadioChanCount + 1));
+}
+
+void test_hopping_preamble_spans_a_scan() {
+  TEST_ASSERT_EQUAL_UINT16(8, node_radio_preamble(config(125000, 3)));
+  TEST_ASSERT_TRUE(node_radio_preamble(config(125000, kRadioChanHop)) >= 8 + 2 * kRadioChanCount);
+}
+
+// -----------------------------------------------------------------------------
+// Host side
+// -----------------------------------------------------------------------------
+void test_tag_chan_takes_plan_channels_and_hop_only() {
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, set_chan(kRadioChanCount - 1));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, set_chan(kRadioChanHop));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, set_chan(kRadioChanCount));
+  const uint8_t b[] = {TAG_CHAN, 0};
+  native_request(Verb::GET_PARAM, b, sizeof(b));
+  const uint8_t* p = native_reply_tlv(TAG_CHAN);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(kRadioChanHop, p[0]);                    // the refused write changed nothing
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, set_chan(0));
+}
+
+void test_stats_carry_the_radio_record() {
+  native_request(Verb::GET_STATS, nullptr, 0);
+  uint8_t L = 0;
+  const uint8_t* p = native_reply_tlv(TAG_STAT_RADIO, &L);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(kRadioStatWire, L);
+  const uint8_t zero[kRadioStatWire] = {};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(zero, p, kRadioStatWire);
+}
+
+int main() {
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_plan_steps_by_1_6_bandwidths);
+  RUN_TEST(test_hop_and_out_of_plan_values_stay_in_the_plan);
+  RUN_TEST(test_hopping_preamble_spans_a_scan);
+  RUN_TEST(test_tag_chan_takes_plan_channels_and_hop_only);
+  RUN_TEST(test_stats_carry_the_radio_record);
+  return UNITY_END();
+}
@@ -0,0 +1,62 @@
+// -----------------------------------------------------------------------------
+// test_font/test_main.cpp
+// Host tests for the page-native font: glyph bytes, clipping at the page
+// edge, 2x scaling. Run with `pio test -e native`.
+//
+// Notes:
+//  * Pure blitter tests: pages are local 128-byte arrays, no panel involved.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_font.hpp"
+
+#include <cstring>
+
+void setUp() {}
+void tearDown() {}
+
+void test_glyph_is_five_columns_and_a_gap() {
+  const uint8_t a[kFontW] = {0x7E, 0x11, 0x11, 0x11, 0x7E, 0x00};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(a, node_font_glyph('A'), kFontW);
+}
+
+void test_unprintable_draws_as_question_mark() {
+  TEST_ASSERT_EQUAL_PTR(node_font_glyph('?'), node_font_glyph('\x01'));
+  TEST_ASSERT_EQUAL_PTR(node_font_glyph('?'), node_font_glyph(static_cast<char>(0xC3)));
+}
+
+void test_draw_stops_at_nul_and_page_edge() {
+  uint8_t page[128];
+  memset(page, 0xAA, sizeof(page));
+  TEST_ASSERT_EQUAL_UINT32(12, node_font_draw(page, sizeof(page), "Hi", 10));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(node_font_glyph('i'), page + kFontW, kFontW);
+  TEST_ASSERT_EQUAL_UINT8(0xAA, page[12]);                          // untouched past the text
+
+  const char* longer = "0123456789012345678901234";
+  TEST_ASSERT_EQUAL_UINT32(kFontCols * kFontW, node_font_draw(page, sizeof(page), longer, 25));
+  TEST_ASSERT_EQUAL_UINT8(0xAA, page[126]);                         // 21 glyphs, 2 spare columns
+}
+
+void test_2x_doubles_rows_and_columns() {
+  uint8_t top[128] = {}, bottom[128] = {};
+  TEST_ASSERT_EQUAL_UINT32(2 * kFontW, node_font_draw_2x(top, bottom, 128, "I", 1));
+  // 'I' column 2 is 0x7F: rows 0..6 -> rows 0..13, i.e. 0xFF on top, 0x3F below
+  TEST_ASSERT_EQUAL_UINT8(0xFF, top[4]);
+  TEST_ASSERT_EQUAL_UINT8(0xFF, top[5]);
+  TEST_ASSERT_EQUAL_UINT8(0x3F, bottom[4]);
+  // column 1 is 0x41: rows 0 and 6 -> 0x03 on top, 0x30 below
+  TEST_ASSERT_EQUAL_UINT8(0x03, top[2]);
+  TEST_ASSERT_EQUAL_UINT8(0x30, bottom[3]);
+  TEST_ASSERT_EQUAL_UINT32(120, node_font_draw_2x(top, bottom, 128, "ABCDEFGHIJK", 11));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_glyph_is_five_columns_and_a_gap);
+  RUN_TEST(test_unprintable_draws_as_question_mark);
+  RUN_TEST(test_draw_stops_at_nul_and_page_edge);
+  RUN_TEST(test_2x_doubles_rows_and_columns);
+  return UNITY_END();
+}
@@ -0,0 +1,198 @@
+// -----------------------------------------------------------------------------
+// test_frames/test_main.cpp
+// Host tests for the inbound frame path: header and TLV bounds, verb
+// replies, SLIP framing. Run with `pio test -e native`.
+//
+// Notes:
+//  * The node runs on native/shim: no radio, no display, NVS in memory.
+//  * Frames go in through node_interface_on_packet() (parser tests) or as
+//    SLIP bytes through node_protocol_update() (framing tests); replies are
+//    read back off the shim's Serial.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "native_host.h"
+
+#include <cstring>
+
+namespace {
+
+const uint8_t* const g_out = native_reply();
+
+}  // namespace
+
+void setUp() { native_serial_clear(); }
+void tearDown() {}
+
+// -----------------------------------------------------------------------------
+// Header bounds
+// -----------------------------------------------------------------------------
+void test_short_frame_is_ignored() {
+  const uint8_t f[] = {Verb::PING, 0, 1};
+  TEST_ASSERT_EQUAL_UINT32(0, native_exchange(f, sizeof(f)));
+}
+
+void test_truncated_body_answers_resp_err() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 9, 10, TAG_SF, 0};     // declares 10, carries 2
+  TEST_ASSERT_EQUAL_UINT32(kFrameHdr, native_exchange(f, sizeof(f)));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(9, g_out[2]);
+}
+
+void test_truncated_len16_header_answers_resp_err() {
+  const uint8_t f[] = {Verb::GET_ALL, FLAG_LEN16, 4, 0x00, 0x01};   // body 256, none sent
+  TEST_ASSERT_EQUAL_UINT32(kFrameHdr16, native_exchange(f, sizeof(f)));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  TEST_ASSERT_TRUE(g_out[1] & FLAG_LEN16);                              // reply mirrors the form
+}
+
+// -----------------------------------------------------------------------------
+// TLV bounds: nothing past the declared body is ever parsed
+// -----------------------------------------------------------------------------
+void test_get_param_stops_at_declared_body() {
+  // Body is one TLV (TAG_SF); a second request sits in the buffer beyond it.
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 2, 2, TAG_SF, 0, TAG_FREQ_HZ, 0};
+  native_exchange(f, sizeof(f));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  uint8_t L = 0;
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_SF, &L));
+  TEST_ASSERT_NULL(native_reply_tlv(TAG_FREQ_HZ, &L));
+}
+
+void test_tlv_value_overrunning_body_is_dropped() {
+  const uint8_t f[] = {Verb::SET_PARAM, 0, 3, 3, TAG_SF, 200, 7};     // value claims 200 bytes
+  native_exchange(f, sizeof(f));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+}
+
+void test_malformed_get_param_is_refused_whole() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 4, 3, TAG_SF, 0, TAG_CR};  // trailing half TLV
+  TEST_ASSERT_EQUAL_UINT32(kFrameHdr, native_exchange(f, sizeof(f)));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+}
+
+// -----------------------------------------------------------------------------
+// Verbs
+// -----------------------------------------------------------------------------
+void test_ping_echoes_seq_and_id() {
+  const uint8_t f[] = {Verb::PING, 0, 42, 0};
+  native_exchange(f, sizeof(f));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(42, g_out[2]);
+  uint8_t L = 0;
+  const uint8_t* id = native_reply_tlv(TAG_ID, &L);
+  TEST_ASSERT_NOT_NULL(id);
+  TEST_ASSERT_EQUAL_UINT32(strlen(node_interface_id()), L);
+  TEST_ASSERT_EQUAL_MEMORY(node_interface_id(), id, L);
+}
+
+void test_set_param_then_get_param() {
+  const uint8_t set[] = {Verb::SET_PARAM, 0, 5, 3, TAG_SF, 1, 11};
+  native_exchange(set, sizeof(set));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+
+  const uint8_t get[] = {Verb::GET_PARAM, 0, 6, 2, TAG_SF, 0};
+  native_exchange(get, sizeof(get));
+  uint8_t L = 0;
+  const uint8_t* v = native_reply_tlv(TAG_SF, &L);
+  TEST_ASSERT_NOT_NULL(v);
+  TEST_ASSERT_EQUAL_UINT8(1, L);
+  TEST_ASSERT_EQUAL_UINT8(11, v[0]);
+
+  const uint8_t back[] = {Verb::SET_PARAM, 0, 7, 3, TAG_SF, 1, 9};
+  native_exchange(back, sizeof(back));
+}
+
+void test_set_param_is_all_or_nothing() {
+  // A valid SF followed by an SF of the wrong width: neither applies.
+  const uint8_t set[] = {Verb::SET_PARAM, 0, 8, 7, TAG_SF, 1, 12, TAG_SF, 2, 7, 0};
+  native_exchange(set, sizeof(set));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+
+  const uint8_t get[] = {Verb::GET_PARAM, 0, 9, 2, TAG_SF, 0};
+  native_exchange(get, sizeof(get));
+  uint8_t L = 0;
+  const uint8_t* v = native_reply_tlv(TAG_SF, &L);
+  TEST_ASSERT_NOT_NULL(v);
+  TEST_ASSERT_EQUAL_UINT8(9, v[0]);
+}
+
+void test_unknown_verb_answers_resp_err() {
+  const uint8_t f[] = {0x7E, 0, 11, 0};
+  TEST_ASSERT_EQUAL_UINT32(kFrameHdr, native_exchange(f, sizeof(f)));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(11, g_out[2]);
+}
+
+void test_batch_answers_in_order() {
+  const uint8_t f[] = {Verb::BATCH, 0, 12, 8,
+                       Verb::PING, 0, 1, 0,
+                       Verb::GET_ID, 0, 2, 0};
+  const size_t n = native_exchange(f, sizeof(f));
+  TEST_ASSERT_EQUAL_UINT8(Verb::BATCH, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(12, g_out[2]);
+  const size_t first = kFrameHdr;
+  const size_t second = first + kFrameHdr + g_out[first + 3];
+  TEST_ASSERT_TRUE(second + kFrameHdr <= n);
+  TEST_ASSERT_EQUAL_UINT8(1, g_out[first + 2]);
+  TEST_ASSERT_EQUAL_UINT8(2, g_out[second + 2]);
+}
+
+// -----------------------------------------------------------------------------
+// SLIP framing through node_protocol
+// -----------------------------------------------------------------------------
+void test_slip_escapes_round_trip() {
+  // BENCH echoes TAG_BENCH_DATA: both special bytes must survive both ways.
+  const uint8_t wire[] = {0xC0, Verb::BENCH, 0, 13, 4, TAG_BENCH_DATA, 2,
+                          0xDB, 0xDC, 0xDB, 0xDD, 0xC0};               // data = C0 DB
+  native_serial_feed(wire, sizeof(wire));
+  node_protocol_update();
+  native_take_reply();
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  uint8_t L = 0;
+  const uint8_t* v = native_reply_tlv(TAG_BENCH_DATA, &L);
+  TEST_ASSERT_NOT_NULL(v);
+  TEST_ASSERT_EQUAL_UINT8(2, L);
+  TEST_ASSERT_EQUAL_HEX8(0xC0, v[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xDB, v[1]);
+}
+
+void test_oversized_slip_frame_is_cut_and_answered() {
+  static uint8_t wire[kFrameMax + 64];
+  size_t k = 0;
+  wire[k++] = Verb::BENCH; wire[k++] = FLAG_LEN16; wire[k++] = 14;
+  wire[k++] = 0xFF; wire[k++] = 0xFF;                                   // declares 65535
+  while (k < sizeof(wire) - 1) wire[k++] = 0x55;
+  wire[k++] = 0xC0;
+  native_serial_feed(wire, k);
+  node_protocol_update();
+  TEST_ASSERT_TRUE(native_take_reply() >= kFrameHdr16);
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(14, g_out[2]);
+}
+
+int main() {
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_short_frame_is_ignored);
+  RUN_TEST(test_truncated_body_answers_resp_err);
+  RUN_TEST(test_truncated_len16_header_answers_resp_err);
+  RUN_TEST(test_get_param_stops_at_declared_body);
+  RUN_TEST(test_tlv_value_overrunning_body_is_dropped);
+  RUN_TEST(test_malformed_get_param_is_refused_whole);
+  RUN_TEST(test_ping_echoes_seq_and_id);
+  RUN_TEST(test_set_param_then_get_param);
+  RUN_TEST(test_set_param_is_all_or_nothing);
+  RUN_TEST(test_unknown_verb_answers_resp_err);
+  RUN_TEST(test_batch_answers_in_order);
+  RUN_TEST(test_slip_escapes_round_trip);
+  RUN_TEST(test_oversized_slip_frame_is_cut_and_answered);
+  return UNITY_END();
+}
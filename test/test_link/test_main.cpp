@@ -0,0 +1,126 @@
+// -----------------------------------------------------------------------------
+// test_link/test_main.cpp
+// Host tests for node_link addressing: who ACKs a reliable message, and
+// which ACK closes it. Run with `pio test -e native`.
+//
+// Notes:
+//  * The radio is "fitted" (native_radio_fit()) but no task drains its TX
+//    ring, so the suite has kRadioTxSlots sends in total; tests run in order
+//    and the last one uses the ring filling up as its witness.
+//  * Received packets are built by hand in a pool slot, as the radio would
+//    leave them.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_link.hpp"
+#include "node_msgq.hpp"
+#include "node_radio.hpp"
+#include "native_host.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t kPeer  = 0x1234;
+constexpr uint16_t kOther = 0x5678;
+
+const RadioConfig kCfg = {902300000, 9, 125000, 5, 17, 0};
+
+// Queue "hi" for @p dst and hand it to the link.
+LinkSend send(uint16_t dst, uint16_t id, bool reliable, Msg*& m) {
+  m = node_msgq_alloc();
+  TEST_ASSERT_NOT_NULL(m);
+  m->len = 2; m->lane = LANE_CHAT; m->hops = 1; m->id = id; m->dst = dst;
+  memcpy(m->data(), "hi", 2);
+  return node_link_send(*m, reliable);
+}
+
+// Hand the link one air packet [hdr][payload "ok"] as the radio would; true if delivered.
+bool hear(uint8_t kind, uint16_t src, uint16_t dst, uint16_t id) {
+  Msg* m = node_msgq_alloc();
+  TEST_ASSERT_NOT_NULL(m);
+  uint8_t* p = m->buf;
+  p[0] = kAirMagic; p[1] = kind;
+  p[2] = src & 0xFF; p[3] = src >> 8;
+  p[4] = dst & 0xFF; p[5] = dst >> 8;
+  p[6] = id & 0xFF;  p[7] = id >> 8;
+  p[8] = 1;
+  memcpy(p + kAirHdr, "ok", 2);
+  const RadioPacket pkt = {kAirHdr + 2, -60, 7, m->buf, m};
+  const bool deliver = node_link_receive(pkt, *m);
+  node_msgq_free(m);
+  return deliver;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// -----------------------------------------------------------------------------
+// Sending
+// -----------------------------------------------------------------------------
+void test_broadcast_is_sent_once_without_ackreq() {
+  Msg* m = nullptr;
+  TEST_ASSERT_EQUAL_UINT8(SEND_OK, send(kAirBroadcast, 101, true, m));
+  TEST_ASSERT_EQUAL_UINT32(0, node_link_pending());                 // no retransmit slot
+  TEST_ASSERT_EQUAL_HEX8(0, m->buf[1] & AIR_F_ACKREQ);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, m->buf[4]);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, m->buf[5]);
+}
+
+void test_only_the_destination_ack_closes_the_slot() {
+  Msg* m = nullptr;
+  TEST_ASSERT_EQUAL_UINT8(SEND_OK, send(kPeer, 102, true, m));
+  TEST_ASSERT_TRUE(m->buf[1] & AIR_F_ACKREQ);
+  TEST_ASSERT_EQUAL_HEX8(kPeer & 0xFF, m->buf[4]);
+  TEST_ASSERT_EQUAL_HEX8(kPeer >> 8, m->buf[5]);
+  TEST_ASSERT_EQUAL_UINT32(1, node_link_pending());
+
+  const uint16_t me = node_link_addr();
+  LinkEvent ev;
+  hear(AIR_ACK, kOther, me, 102);                                   // same id, wrong node
+  hear(AIR_ACK, kPeer, me, 103);                                    // right node, wrong id
+  hear(AIR_ACK, kPeer, kAirBroadcast, 102);                         // not addressed to us
+  TEST_ASSERT_FALSE(node_link_poll(ev));
+  TEST_ASSERT_EQUAL_UINT32(1, node_link_pending());
+
+  hear(AIR_ACK, kPeer, me, 102);
+  TEST_ASSERT_TRUE(node_link_poll(ev));
+  TEST_ASSERT_EQUAL_UINT16(102, ev.id);
+  TEST_ASSERT_EQUAL_UINT8(LINK_DELIVERED, ev.status);
+  TEST_ASSERT_EQUAL_UINT32(0, node_link_pending());
+}
+
+// -----------------------------------------------------------------------------
+// Receiving
+// -----------------------------------------------------------------------------
+void test_only_addressed_data_is_acked() {
+  Msg* m = nullptr;
+  TEST_ASSERT_EQUAL_UINT8(SEND_OK, send(kAirBroadcast, 104, false, m));   // one TX slot left
+  TEST_ASSERT_TRUE(node_radio_tx_ready());
+
+  TEST_ASSERT_TRUE(hear(AIR_DATA | AIR_F_ACKREQ, kPeer, kAirBroadcast, 7));
+  TEST_ASSERT_TRUE(node_radio_tx_ready());                          // delivered, not ACKed
+  TEST_ASSERT_FALSE(hear(AIR_DATA | AIR_F_ACKREQ, kPeer, kOther, 8));
+  TEST_ASSERT_TRUE(node_radio_tx_ready());                          // not ours: no ACK either
+
+  TEST_ASSERT_TRUE(hear(AIR_DATA | AIR_F_ACKREQ, kPeer, node_link_addr(), 9));
+  TEST_ASSERT_FALSE(node_radio_tx_ready());                         // the ACK took the last slot
+}
+
+int main() {
+  native_radio_fit(true);
+  node_radio_begin(kCfg);
+  node_link_configure(kCfg);
+  node_link_set_addr("alpha");
+  node_link_set_route(false, 1);                                    // no relay copies
+
+  UNITY_BEGIN();
+  RUN_TEST(test_broadcast_is_sent_once_without_ackreq);
+  RUN_TEST(test_only_the_destination_ack_closes_the_slot);
+  RUN_TEST(test_only_addressed_data_is_acked);
+  return UNITY_END();
+}
@@ -0,0 +1,95 @@
+// -----------------------------------------------------------------------------
+// test_msgq/test_main.cpp
+// Host tests for node_msgq slot ownership: alloc/commit/detach/free, refusal,
+// headroom. Run with `pio test -e native`.
+//
+// Notes:
+//  * Every test leaves both queues empty and every slot back in the pool;
+//    test_pool_is_whole_again checks that last.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_msgq.hpp"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t kCap = 8;
+
+Msg* filled(uint8_t lane, const char* s) {
+  Msg* m = node_msgq_alloc();
+  TEST_ASSERT_NOT_NULL(m);
+  m->lane = lane;
+  m->len  = static_cast<uint8_t>(strlen(s));
+  memcpy(m->data(), s, m->len);
+  return m;
+}
+
+size_t free_slots() {
+  Msg* held[2 * kMsgQueueMax + kMsgLoanMax];
+  size_t n = 0;
+  while (n < sizeof(held) / sizeof(held[0]) && (held[n] = node_msgq_alloc())) ++n;
+  for (size_t i = 0; i < n; ++i) node_msgq_free(held[i]);
+  return n;
+}
+
+}  // namespace
+
+void setUp() { node_msgq_set_capacity(kCap); }
+void tearDown() {
+  while (node_msgq_peek(MQ_OUT)) node_msgq_pop(MQ_OUT);
+  while (node_msgq_peek(MQ_IN))  node_msgq_pop(MQ_IN);
+}
+
+void test_detach_hands_over_the_same_slot() {
+  Msg* m = filled(LANE_CHAT, "hello");
+  TEST_ASSERT_TRUE(node_msgq_commit(MQ_OUT, m));
+  TEST_ASSERT_EQUAL_PTR(m, node_msgq_peek(MQ_OUT));
+  TEST_ASSERT_EQUAL_PTR(m, node_msgq_detach(MQ_OUT));
+  TEST_ASSERT_EQUAL_UINT32(0, node_msgq_depth(MQ_OUT));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY("hello", m->data(), 5);           // untouched: no copy was made
+  TEST_ASSERT_EQUAL_PTR(m->buf + kMsgHeadroom, m->data());
+  node_msgq_free(m);
+}
+
+void test_control_lane_is_served_first() {
+  Msg* chat = filled(LANE_CHAT, "chat");
+  Msg* ctrl = filled(LANE_CTRL, "ack");
+  TEST_ASSERT_TRUE(node_msgq_commit(MQ_OUT, chat));
+  TEST_ASSERT_TRUE(node_msgq_commit(MQ_OUT, ctrl));
+  TEST_ASSERT_EQUAL_PTR(ctrl, node_msgq_peek(MQ_OUT));
+  node_msgq_pop(MQ_OUT);
+  TEST_ASSERT_EQUAL_PTR(chat, node_msgq_peek(MQ_OUT));
+}
+
+void test_refused_commit_returns_the_slot() {
+  const size_t before = free_slots();
+  size_t queued = 0;
+  while (node_msgq_commit(MQ_OUT, filled(LANE_CHAT, "x"))) ++queued;
+  TEST_ASSERT_EQUAL_UINT32(kCap - kMsgCtrlReserve, queued);        // chat stops short of the reserve
+  TEST_ASSERT_EQUAL_UINT32(before - queued, free_slots());         // the refused one went back
+}
+
+void test_full_inbound_evicts_instead_of_refusing() {
+  for (size_t i = 0; i < kCap; ++i) TEST_ASSERT_TRUE(node_msgq_commit(MQ_IN, filled(LANE_CHAT, "old")));
+  Msg* fresh = filled(LANE_CHAT, "new");
+  TEST_ASSERT_TRUE(node_msgq_commit(MQ_IN, fresh));
+  TEST_ASSERT_TRUE(node_msgq_depth(MQ_IN) <= kCap);
+}
+
+void test_pool_is_whole_again() {
+  TEST_ASSERT_EQUAL_UINT32(2 * kMsgQueueMax + kMsgLoanMax, free_slots());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_detach_hands_over_the_same_slot);
+  RUN_TEST(test_control_lane_is_served_first);
+  RUN_TEST(test_refused_commit_returns_the_slot);
+  RUN_TEST(test_full_inbound_evicts_instead_of_refusing);
+  RUN_TEST(test_pool_is_whole_again);
+  return UNITY_END();
+}
@@ -0,0 +1,160 @@
+// -----------------------------------------------------------------------------
+// test_replay/test_main.cpp
+// Host tests for node_replay: a retransmitted request is answered from its
+// recorded reply and not run again. Run with `pio test -e native`.
+//
+// Notes:
+//  * TAG_SF is the witness: a retry of "SF=11" after "SF=10" must leave 10.
+//  * The shim clock only moves with native_advance_ms(), so TTL cases are
+//    exact.
+//  * The radio is "fitted" (native_radio_fit()) but no task sends, so MSGs
+//    pile up until the node refuses them with ERR_BUSY.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "node_replay.hpp"
+#include "node_msgq.hpp"
+#include "native_host.h"
+
+#include <cstring>
+
+namespace {
+
+const uint8_t* const g_out = native_reply();
+
+void set_sf(uint8_t seq, uint8_t sf) {
+  const uint8_t f[] = {Verb::SET_PARAM, 0, seq, 3, TAG_SF, 1, sf};
+  native_exchange(f, sizeof(f));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+}
+
+uint8_t get_sf() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 99, 2, TAG_SF, 0};
+  native_exchange(f, sizeof(f));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(TAG_SF, g_out[kFrameHdr]);
+  return g_out[kFrameHdr + 2];
+}
+
+}  // namespace
+
+void setUp() {
+  native_advance_ms(kReplayTtlMs);            // forget what the previous test recorded
+  native_serial_clear();
+}
+void tearDown() {}
+
+// -----------------------------------------------------------------------------
+// Retries
+// -----------------------------------------------------------------------------
+void test_retry_answers_original_reply_without_rerunning() {
+  const uint8_t first[] = {Verb::SET_PARAM, 0, 20, 3, TAG_SF, 1, 11};
+  const size_t n = native_exchange(first, sizeof(first));
+  uint8_t want[kFrameMax + 1];
+  memcpy(want, g_out, n);
+
+  set_sf(21, 10);                                                   // host moved on
+  TEST_ASSERT_EQUAL_UINT32(n, native_exchange(first, sizeof(first)));      // reply to seq 20 was lost
+  TEST_ASSERT_EQUAL_MEMORY(want, g_out, n);                         // same echo (SF=11) ...
+  TEST_ASSERT_EQUAL_UINT8(10, get_sf());                            // ... but not applied again
+}
+
+void test_reused_seq_with_new_body_runs() {
+  set_sf(30, 11);
+  set_sf(30, 8);
+  TEST_ASSERT_EQUAL_UINT8(8, get_sf());
+}
+
+void test_seq_zero_is_never_replayed() {
+  set_sf(0, 11);
+  set_sf(31, 10);
+  set_sf(0, 11);
+  TEST_ASSERT_EQUAL_UINT8(11, get_sf());
+}
+
+void test_reads_always_run() {
+  set_sf(32, 7);
+  TEST_ASSERT_EQUAL_UINT8(7, get_sf());
+  set_sf(33, 12);
+  TEST_ASSERT_EQUAL_UINT8(12, get_sf());                            // same GET_PARAM bytes, fresh value
+}
+
+// -----------------------------------------------------------------------------
+// Window
+// -----------------------------------------------------------------------------
+void test_entry_expires_after_ttl() {
+  set_sf(40, 11);
+  set_sf(41, 10);
+  native_advance_ms(kReplayTtlMs);
+  set_sf(40, 11);
+  TEST_ASSERT_EQUAL_UINT8(11, get_sf());
+}
+
+void test_window_covers_replay_slots_requests() {
+  set_sf(50, 11);
+  for (size_t k = 1; k < kReplaySlots; ++k) set_sf(static_cast<uint8_t>(50 + k), 10);
+  set_sf(50, 11);                                                   // still inside the window
+  TEST_ASSERT_EQUAL_UINT8(10, get_sf());
+
+  set_sf(60, 11);
+  for (size_t k = 1; k <= kReplaySlots; ++k) set_sf(static_cast<uint8_t>(60 + k), 10);
+  set_sf(60, 11);                                                   // pushed out: runs again
+  TEST_ASSERT_EQUAL_UINT8(11, get_sf());
+}
+
+void test_batch_retry_is_replayed_whole() {
+  const uint8_t batch[] = {Verb::BATCH, 0, 70, 11,
+                           Verb::SET_PARAM, 0, 1, 3, TAG_SF, 1, 11,
+                           Verb::PING, 0, 2, 0};
+  const size_t n = native_exchange(batch, sizeof(batch));
+  TEST_ASSERT_EQUAL_UINT8(Verb::BATCH, g_out[0]);
+  set_sf(71, 9);
+  TEST_ASSERT_EQUAL_UINT32(n, native_exchange(batch, sizeof(batch)));
+  TEST_ASSERT_EQUAL_UINT8(Verb::BATCH, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(70, g_out[2]);
+  TEST_ASSERT_EQUAL_UINT8(9, get_sf());
+}
+
+// -----------------------------------------------------------------------------
+// Refusals
+// -----------------------------------------------------------------------------
+void test_busy_refusal_is_not_replayed() {
+  // No radio task natively: the TX ring fills, then MQ_OUT, then MSG answers ERR_BUSY.
+  uint8_t f[] = {Verb::MSG, 0, 80, 2, 'h', 'i'};
+  size_t k = 0;
+  do {
+    f[2] = static_cast<uint8_t>(80 + k);
+    native_exchange(f, sizeof(f));
+  } while (g_out[0] == Verb::RESP_OK && ++k < 2 * kMsgQueueMax);
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  while (Msg* m = node_msgq_detach(MQ_OUT)) node_msgq_free(m);    // the queue drains
+
+  TEST_ASSERT_TRUE(native_exchange(f, sizeof(f)) > 0);             // host backs off, resends as is
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  TEST_ASSERT_NOT_NULL(native_reply_tlv(TAG_MSG_ID));
+  TEST_ASSERT_EQUAL_UINT32(1, node_msgq_depth(MQ_OUT));
+  while (Msg* m = node_msgq_detach(MQ_OUT)) node_msgq_free(m);
+}
+
+int main() {
+  native_radio_fit(true);                                          // MSG queues for the air
+
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_retry_answers_original_reply_without_rerunning);
+  RUN_TEST(test_reused_seq_with_new_body_runs);
+  RUN_TEST(test_seq_zero_is_never_replayed);
+  RUN_TEST(test_reads_always_run);
+  RUN_TEST(test_entry_expires_after_ttl);
+  RUN_TEST(test_window_covers_replay_slots_requests);
+  RUN_TEST(test_batch_retry_is_replayed_whole);
+  RUN_TEST(test_busy_refusal_is_not_replayed);
+  return UNITY_END();
+}
@@ -0,0 +1,145 @@
+// -----------------------------------------------------------------------------
+// test_subscribe/test_main.cpp
+// Host tests for SUBSCRIBE: periodic and threshold reports, baselines,
+// refusals, cancel. Run with `pio test -e native`.
+//
+// Notes:
+//  * Reports come from a SCHED_XPORT timer; tests move the shim clock with
+//    native_advance_ms() and run the wheel by hand (no tasks natively).
+//  * TAG_SF and TAG_TX_PWR_DBM are the watched values: SET_PARAM moves them.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_protocol.hpp"
+#include "node_interface.hpp"
+#include "node_sched.hpp"
+#include "native_host.h"
+
+namespace {
+
+const uint8_t* const g_out = native_reply();
+
+void set_u8(uint8_t tag, uint8_t v) {
+  const uint8_t b[] = {tag, 1, v};
+  native_request(Verb::SET_PARAM, b, sizeof(b));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+}
+
+// Let `ms` pass one check at a time; return the first report's length (0 = none).
+size_t wait_report(uint32_t ms) {
+  native_serial_clear();
+  for (uint32_t t = 0; t < ms; t += 1000) {
+    native_advance_ms(1000);
+    node_sched_run(SCHED_XPORT);
+    const size_t n = native_take_reply();
+    if (n) return n;
+  }
+  return 0;
+}
+
+void cancel() {
+  native_request(Verb::SUBSCRIBE, nullptr, 0);
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+}
+
+}  // namespace
+
+void setUp() {
+  set_u8(TAG_SF, 9);
+  set_u8(TAG_TX_PWR_DBM, 1);
+  native_serial_clear();
+}
+void tearDown() { cancel(); }
+
+// -----------------------------------------------------------------------------
+// Reports
+// -----------------------------------------------------------------------------
+void test_reply_carries_period_and_baseline() {
+  const uint8_t b[] = {TAG_SUB_PERIOD_S, 2, 5, 0, TAG_SF, 0};
+  native_request(Verb::SUBSCRIBE, b, sizeof(b));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  const uint8_t* p = native_reply_tlv(TAG_SUB_PERIOD_S);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(5, p[0]);
+  p = native_reply_tlv(TAG_SF);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(9, p[0]);
+}
+
+void test_period_sends_numbered_reports() {
+  const uint8_t b[] = {TAG_SUB_PERIOD_S, 2, 3, 0, TAG_SF, 0};
+  native_request(Verb::SUBSCRIBE, b, sizeof(b));
+  TEST_ASSERT_EQUAL_UINT32(0, wait_report(2000));                  // not yet
+  const size_t n = wait_report(1000);
+  TEST_ASSERT_TRUE(n > 0);
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_OK, g_out[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, g_out[2]);                            // unsolicited
+  TEST_ASSERT_EQUAL_UINT8(TAG_SUB_SEQ, g_out[kFrameHdr]);          // leads the report
+  TEST_ASSERT_EQUAL_UINT8(1, g_out[kFrameHdr + 2]);
+  TEST_ASSERT_TRUE(wait_report(3000) > 0);
+  TEST_ASSERT_EQUAL_UINT8(2, g_out[kFrameHdr + 2]);
+}
+
+void test_watched_change_reports_once() {
+  const uint8_t b[] = {TAG_SF, 1, 0};                              // any change, no period
+  native_request(Verb::SUBSCRIBE, b, sizeof(b));
+  TEST_ASSERT_EQUAL_UINT32(0, wait_report(5000));
+  set_u8(TAG_SF, 11);
+  TEST_ASSERT_TRUE(wait_report(1000) > 0);
+  const uint8_t* p = native_reply_tlv(TAG_SF);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(11, p[0]);
+  TEST_ASSERT_EQUAL_UINT32(0, wait_report(5000));                  // new baseline: quiet again
+}
+
+void test_threshold_is_signed_distance() {
+  const uint8_t b[] = {TAG_TX_PWR_DBM, 1, 3};                      // report on a 3 dB move
+  native_request(Verb::SUBSCRIBE, b, sizeof(b));
+  set_u8(TAG_TX_PWR_DBM, static_cast<uint8_t>(-1));                // 1 -> -1: 2 dB, not 254
+  TEST_ASSERT_EQUAL_UINT32(0, wait_report(2000));
+  set_u8(TAG_TX_PWR_DBM, static_cast<uint8_t>(-2));                // 3 dB from the baseline
+  TEST_ASSERT_TRUE(wait_report(1000) > 0);
+}
+
+// -----------------------------------------------------------------------------
+// Refusals and cancel
+// -----------------------------------------------------------------------------
+void test_bad_subscriptions_are_refused() {
+  const uint8_t unknown[] = {0x7A, 0};
+  native_request(Verb::SUBSCRIBE, unknown, sizeof(unknown));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  const uint8_t str_watch[] = {TAG_ID, 1, 1};
+  native_request(Verb::SUBSCRIBE, str_watch, sizeof(str_watch));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  const uint8_t never[] = {TAG_SF, 0};                             // no period, nothing watched
+  native_request(Verb::SUBSCRIBE, never, sizeof(never));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+  const uint8_t dup[] = {TAG_SF, 0, TAG_SF, 1, 0};
+  native_request(Verb::SUBSCRIBE, dup, sizeof(dup));
+  TEST_ASSERT_EQUAL_UINT8(Verb::RESP_ERR, g_out[0]);
+}
+
+void test_cancel_stops_reports() {
+  const uint8_t b[] = {TAG_SUB_PERIOD_S, 2, 1, 0, TAG_SF, 0};
+  native_request(Verb::SUBSCRIBE, b, sizeof(b));
+  TEST_ASSERT_TRUE(wait_report(1000) > 0);
+  cancel();
+  TEST_ASSERT_EQUAL_UINT32(0, wait_report(5000));
+}
+
+int main() {
+  node_protocol_begin(115200);
+  node_protocol_set_handler(node_interface_on_packet);
+  node_interface_begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_reply_carries_period_and_baseline);
+  RUN_TEST(test_period_sends_numbered_reports);
+  RUN_TEST(test_watched_change_reports_once);
+  RUN_TEST(test_threshold_is_signed_distance);
+  RUN_TEST(test_bad_subscriptions_are_refused);
+  RUN_TEST(test_cancel_stops_reports);
+  return UNITY_END();
+}
@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------------
+// test_tlv/test_main.cpp
+// Host tests for TlvView: what counts as a valid body, indexed and scanned
+// lookups, iteration order. Run with `pio test -e native`.
+//
+// Notes:
+//  * Pure parser tests: no node state is touched, frames are literals.
+//
+// -----------------------------------------------------------------------------
+
+#include <unity.h>
+
+#include "node_protocol.hpp"
+#include "node_tlv.hpp"
+
+void setUp() {}
+void tearDown() {}
+
+// -----------------------------------------------------------------------------
+// Validation
+// -----------------------------------------------------------------------------
+void test_empty_body_is_valid() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 1, 0};
+  const TlvView v(f, sizeof(f));
+  TEST_ASSERT_TRUE(v.ok());
+  TEST_ASSERT_EQUAL_UINT32(0, v.count());
+}
+
+void test_value_past_body_is_rejected() {
+  const uint8_t f[] = {Verb::SET_PARAM, 0, 1, 3, TAG_SF, 2, 9};
+  TEST_ASSERT_FALSE(TlvView(f, sizeof(f)).ok());
+}
+
+void test_stray_byte_is_rejected() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 1, 3, TAG_SF, 0, TAG_CR};
+  TEST_ASSERT_FALSE(TlvView(f, sizeof(f)).ok());
+}
+
+void test_body_past_frame_is_rejected() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 1, 4, TAG_SF, 0};
+  TEST_ASSERT_FALSE(TlvView(f, sizeof(f)).ok());
+  const uint8_t g[] = {Verb::GET_PARAM, FLAG_LEN16, 1, 2};          // LEN16 header cut short
+  TEST_ASSERT_FALSE(TlvView(g, sizeof(g)).ok());
+}
+
+void test_rejected_view_finds_and_yields_nothing() {
+  const uint8_t f[] = {Verb::SET_PARAM, 0, 1, 4, TAG_SF, 1, 9, TAG_CR};
+  const TlvView v(f, sizeof(f));
+  uint8_t L = 0;
+  TEST_ASSERT_NULL(v.find(TAG_SF, L));
+  TEST_ASSERT_FALSE(v.begin() != v.end());
+}
+
+// -----------------------------------------------------------------------------
+// Lookups
+// -----------------------------------------------------------------------------
+void test_find_returns_first_of_duplicates() {
+  const uint8_t f[] = {Verb::SET_PARAM, 0, 1, 6, TAG_SF, 1, 9, TAG_SF, 1, 12};
+  const TlvView v(f, sizeof(f));
+  uint8_t L = 0;
+  const uint8_t* p = v.find(TAG_SF, L);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(1, L);
+  TEST_ASSERT_EQUAL_UINT8(9, p[0]);
+  TEST_ASSERT_EQUAL_UINT32(2, v.count());
+}
+
+void test_find_above_index_and_absent_tags() {
+  const uint8_t f[] = {Verb::GET_STATS, FLAG_LEN16, 1, 5, 0, TAG_BENCH_DATA, 0, TAG_STAT_RESET, 1, 1};
+  const TlvView v(f, sizeof(f));
+  TEST_ASSERT_TRUE(v.ok());
+  uint8_t L = 0;
+  const uint8_t* p = v.find(TAG_STAT_RESET, L);                      // 0x43: scanned
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL_UINT8(1, p[0]);
+  TEST_ASSERT_NOT_NULL(v.find(TAG_BENCH_DATA, L));                   // zero-length value
+  TEST_ASSERT_EQUAL_UINT8(0, L);
+  TEST_ASSERT_NULL(v.find(TAG_SF, L));
+  TEST_ASSERT_NULL(v.find(0x7F, L));
+}
+
+void test_iteration_keeps_wire_order() {
+  const uint8_t f[] = {Verb::GET_PARAM, 0, 1, 7, TAG_CR, 0, TAG_SF, 1, 9, TAG_CR, 0};
+  const TlvView v(f, sizeof(f));
+  const uint8_t want[] = {TAG_CR, TAG_SF, TAG_CR};
+  size_t k = 0;
+  for (const TlvView::Item t : v) {
+    TEST_ASSERT_TRUE(k < sizeof(want));
+    TEST_ASSERT_EQUAL_UINT8(want[k++], t.tag);
+  }
+  TEST_ASSERT_EQUAL_UINT32(sizeof(want), k);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_body_is_valid);
+  RUN_TEST(test_value_past_body_is_rejected);
+  RUN_TEST(test_stray_byte_is_rejected);
+  RUN_TEST(test_body_past_frame_is_rejected);
+  RUN_TEST(test_rejected_view_finds_and_yields_nothing);
+  RUN_TEST(test_find_returns_first_of_duplicates);
+  RUN_TEST(test_find_above_index_and_absent_tags);
+  RUN_TEST(test_iteration_keeps_wire_order);
+  return UNITY_END();
+}